@@ -5,13 +5,27 @@
 #include <spdlog/spdlog.h>
 
 
+template<class Stream_t>
+void runServer(const ServerArgs &args) {
+    spdlog::info("Creating sessions manager...");
+    auto sessions_manager = std::make_shared<SessionsManager<ServerSideClientSession<Stream_t>>>(
+            args.client_timeout, SessionsManager<>::DEFAULT_CHECK_INTERVAL, args.deadlines, args.max_frame_size,
+            args.tuning_profile, args.rate_limit);
+    if constexpr (StreamPolicy<Stream_t>::IS_ENCRYPTED) {
+        spdlog::info("Starting server at port: {} with {} certs dir.", args.port, args.certs_directory);
+    } else {
+        spdlog::warn("Starting plaintext server at port: {}. Make sure TLS is terminated in front of it.", args.port);
+    }
+    DropFileServer<Stream_t> server{args.port, args.certs_directory, std::move(sessions_manager)};
+    server.run();
+}
+
 int main(int argc, char *argv[]) {
     spdlog::set_level(spdlog::level::debug);
     ServerArgs args = parseServerArgs(argc, argv);
-    spdlog::info("Creating sessions manager...");
-    auto sessions_manager = std::make_shared<SessionsManager>(args.client_timeout,
-                                                              SessionsManager::DEFAULT_CHECK_INTERVAL);
-    spdlog::info("Starting server at port: {} with {} certs dir.", args.port, args.certs_directory);
-    DropFileServer server{args.port, args.certs_directory, std::move(sessions_manager)};
-    server.run();
-}
\ No newline at end of file
+    if (args.plaintext) {
+        runServer<PlainStream>(args);
+    } else {
+        runServer<TlsStream>(args);
+    }
+}
@@ -5,24 +5,60 @@
 #include "client/ClientArgParser.hpp"
 
 #include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 
 #include <iostream>
 
+#include <unistd.h>
 
-ClientSocket createClientSocket(const ClientArgs& args) {
+
+ClientSocket<> createClientSocket(const ClientArgs& args, TransferStats *stats) {
+    TransferStats::Measurement connect{stats, TransferStats::CONNECT};
     return {args.server_domain_name, args.port, args.verify_cert};
 }
 
+// Standard output may carry the received data, so stats go to standard error.
+void reportStats(const ClientArgs &args, const TransferStats &stats) {
+    if (args.stats == StatsFormat::json) {
+        nlohmann::json report = stats.toJson();
+        report["action"] = args.action == Action::send ? "send" : "receive";
+        std::cerr << report.dump() << std::endl;
+    } else {
+        std::cerr << stats.toText() << std::flush;
+    }
+}
+
 void runDropFileClient(const ClientArgs &args) {
+    ReconnectPolicy reconnect_policy{.max_attempts = args.reconnect_attempts};
+    TransferStats stats;
+    TransferStats *measured_stats = args.stats ? &stats : nullptr;
     if (args.action == Action::send) {
-        DropFileSendClient client{createClientSocket(args)};
-        auto [fs_entry, receive_code] = client.sendFSEntryMetadata(*args.file_to_send_path);
-        std::cout << "Receive code: " << receive_code << std::endl;
-        client.sendFSEntry(std::move(fs_entry));
+        DropFileSendClient client{createClientSocket(args, measured_stats), reconnect_policy, args.streams,
+                                  args.hash_algorithm, args.direct, args.tuning_profile, args.rate_limit,
+                                  args.zero_copy, args.quiet, measured_stats};
+        if (args.files_to_send == std::vector{ClientArgs::STANDARD_STREAM}) {
+            std::cout << "Receive code: " << client.sendPipeMetadata() << std::endl;
+            client.sendPipe(STDIN_FILENO);
+        } else {
+            auto [fs_entry, receive_code] = client.sendFSEntryMetadata(args.files_to_send);
+            std::cout << "Receive code: " << receive_code << std::endl;
+            client.sendFSEntry(std::move(fs_entry));
+        }
     } else {
-        DropFileReceiveClient client{createClientSocket(args), std::cin};
+        // Standard output carries only the data then, everything else goes to standard error.
+        std::ostream standard_output{std::cout.rdbuf()};
+        if (args.to_stdout) {
+            std::cout.rdbuf(std::cerr.rdbuf());
+            spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+        }
+        DropFileReceiveClient client{createClientSocket(args, measured_stats), std::cin, args.auto_accept,
+                                     reconnect_policy, args.tuning_profile, args.direct_io,
+                                     args.to_stdout ? &standard_output : nullptr, args.quiet, measured_stats};
         client.receiveFile(*args.receive_code);
     }
+    if (args.stats) {
+        reportStats(args, stats);
+    }
 }
 
 void addAdditionalInfo(int code_value) {
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+#include "Striping.hpp"
+
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string_view>
+
+
+class FileReaderException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+enum class FileIOEngine {
+    mmap,
+    io_uring,
+    pread
+};
+
+
+// Reads a range of a file block by block, with up to QUEUE_DEPTH reads of the following blocks in flight
+// (io_uring, into buffers registered with the kernel), so the disk is already busy with the next blocks
+// while the current one is being hashed, compressed or sent. When io_uring is not available (old kernel,
+// seccomp) or not wanted, blocks are read with pread one at a time.
+// With mmap, regular files are mapped instead and blocks are views of the mapping, read straight from the page cache;
+// special files and ranges past the end of the file are streamed with one of the above.
+class FileReader {
+public:
+    FileReader(const std::filesystem::path &path, ByteRange range, std::size_t block_size = DEFAULT_BLOCK_SIZE,
+               FileIOEngine engine = FileIOEngine::mmap);
+    // Whole file.
+    explicit FileReader(const std::filesystem::path &path, std::size_t block_size = DEFAULT_BLOCK_SIZE,
+                        FileIOEngine engine = FileIOEngine::mmap);
+    FileReader(FileReader &&other) noexcept;
+    ~FileReader();
+
+    // Next block of the range, valid until the next call. Empty once the whole range has been read.
+    // Throws when the file ends before the range does.
+    std::string_view next();
+    FileIOEngine engine() const;
+    // Whole range when it is mapped, then all blocks stay valid as long as the reader does.
+    std::optional<std::string_view> mapped() const;
+    int nativeHandle() const; // e.g. for sendfile
+
+    class Engine;
+
+    static constexpr std::size_t QUEUE_DEPTH{4};
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE{256 * 1024};
+private:
+    std::unique_ptr<Engine> engine_impl;
+};
+
+
+// Read-only std::istream over a FileReader, for code that parses what it reads (e.g. archives).
+// Blocks are handed out straight from the reader's buffers.
+class FileReaderStream: public std::istream {
+public:
+    explicit FileReaderStream(const std::filesystem::path &path, FileIOEngine engine = FileIOEngine::mmap);
+
+    // Next size bytes without copying them, when they are all in the current block (always, when mapped).
+    std::optional<std::string_view> take(std::size_t size);
+private:
+    class Buffer: public std::streambuf {
+    public:
+        explicit Buffer(FileReader reader);
+        std::optional<std::string_view> take(std::size_t size);
+    protected:
+        int_type underflow() override;
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override;
+    private:
+        FileReader reader;
+        std::size_t consumed{0}; // bytes of the blocks before the current one
+    };
+
+    Buffer buffer;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <span>
+#include <string_view>
+
+
+class FramingException : public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+
+// Legacy protocol: every message is preceded by 8-byte host-endian size_t header, control messages are plain strings.
+// Framed protocol: [1 byte FrameType][LEB128 varint payload length][payload], negotiated with Hello preamble.
+enum class WireProtocol {
+    legacy,
+    framed
+};
+
+enum class FrameType : std::uint8_t {
+    data = 0x01,
+    ack = 0x02,
+    abort = 0x03,
+    metadata = 0x04,
+    error = 0x05,
+    credit = 0x06, // payload is varint with amount of DATA payload bytes the receiver is ready to take
+    chunk_hashes = 0x07, // payload is ChunkHashes, sent right after the data of the chunks they cover
+    direct = 0x08, // sender tells the server that the data goes straight to the receiver (see DirectLink.hpp)
+    end = 0x09 // ends piped data of unknown length, payload is the checksum of all of it
+};
+
+std::string_view toString(FrameType type);
+
+struct FrameHeader {
+    FrameType type;
+    std::uint64_t payload_size;
+    std::size_t header_size;
+};
+
+// Payload points into the socket's receive buffer, valid until the next read.
+struct Frame {
+    FrameType type;
+    std::string_view payload;
+};
+
+// Frame sizes are negotiated per connection as powers of two within these bounds.
+// Legacy clients always use DEFAULT_FRAME_SIZE.
+constexpr std::size_t MIN_FRAME_SIZE{4 * 1024}; // 4 KiB
+constexpr std::size_t DEFAULT_FRAME_SIZE{1024 * 1024}; // 1 MiB
+constexpr std::size_t MAX_FRAME_SIZE{16 * 1024 * 1024}; // 16 MiB
+
+constexpr std::size_t MAX_VARINT_SIZE{10};
+constexpr std::size_t MAX_FRAME_HEADER_SIZE{1 + MAX_VARINT_SIZE};
+using FrameHeaderBuffer = std::array<std::uint8_t, MAX_FRAME_HEADER_SIZE>;
+
+std::size_t encodeVarint(std::uint64_t value, std::span<std::uint8_t, MAX_VARINT_SIZE> out);
+std::size_t encodeFrameHeader(FrameType type, std::uint64_t payload_size, FrameHeaderBuffer &out);
+
+// Returns std::nullopt when bytes do not contain whole header yet, throws FramingException when they are malformed.
+std::optional<FrameHeader> decodeFrameHeader(std::span<const char> bytes);
+
+std::string encodeCredit(std::size_t bytes);
+std::size_t decodeCredit(std::span<const char> payload);
+
+// Varint index of the first chunk, followed by the Merkle tree leaves of it and of the chunks right after it.
+struct ChunkHashes {
+    std::size_t first_chunk;
+    std::string_view digests;
+};
+
+std::string encodeChunkHashes(std::size_t first_chunk, std::string_view digests);
+ChunkHashes decodeChunkHashes(std::string_view payload);
+
+
+// Sent by the client as the very first 8 bytes. Its magic, read as legacy size_t header,
+// is way bigger than any allowed first message, so the server can tell both protocols apart.
+// Client proposes the biggest frame it wants to use, server answers with the one both sides will use.
+// Layout: magic[4], version, log2(max_frame_size), 2 reserved bytes.
+struct Hello {
+    std::uint8_t version{PROTOCOL_VERSION};
+    std::size_t max_frame_size{DEFAULT_FRAME_SIZE};
+
+    static constexpr std::size_t SIZE{8};
+    static constexpr std::array<char, 4> MAGIC{'D', 'R', 'P', 'F'};
+    static constexpr std::uint8_t PROTOCOL_VERSION{1};
+};
+
+using HelloBuffer = std::array<char, Hello::SIZE>;
+
+HelloBuffer encodeHello(const Hello &hello);
+bool isHello(std::span<const char> bytes);
+Hello decodeHello(std::span<const char> bytes);
+
+// Rounds down to power of two and clamps to [MIN_FRAME_SIZE, MAX_FRAME_SIZE].
+std::size_t normalizeFrameSize(std::size_t frame_size);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+
+#include <openssl/evp.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+class HasherException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+
+// Hash functions the sender may pick in the init message. SHA-256 is what older clients use,
+// BLAKE2b is roughly twice as fast on CPUs without SHA extensions and just as strong.
+enum class HashAlgorithm {
+    sha256,
+    blake2b
+};
+
+constexpr HashAlgorithm DEFAULT_HASH_ALGORITHM{HashAlgorithm::blake2b};
+
+std::string_view toString(HashAlgorithm algorithm);
+std::optional<HashAlgorithm> parseHashAlgorithm(std::string_view name);
+
+// Files read only to be hashed are read in pieces of this size.
+constexpr std::size_t DEFAULT_READ_BUFFER_SIZE{1024 * 1024}; // 1 MiB
+
+
+// Incremental hash of any of the supported algorithms.
+class Hasher {
+public:
+    explicit Hasher(HashAlgorithm algorithm = HashAlgorithm::sha256);
+
+    void update(std::string_view data);
+    std::string finish(); // raw digest, starts the next hash right away
+private:
+    void reset();
+
+    const EVP_MD *md;
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context;
+};
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "DropFileBaseException.hpp"
+#include "MerkleTree.hpp"
+#include "Striping.hpp"
 
 #include <nlohmann/json.hpp>
 
 #include <filesystem>
+#include <optional>
+#include <vector>
 
 
 class InitSessionMessageException: public DropFileBaseException {
@@ -13,11 +17,65 @@ public:
 };
 
 
+// Sender's offer to connect the clients directly (see DirectLink.hpp). Addresses are tried in the given order.
+struct DirectOffer {
+    std::vector<std::string> addresses;
+    unsigned short port{0};
+    std::string session_key; // receiver proves with it that it got the offer from the server
+    std::string certificate_fingerprint; // SHA-256 of sender's ephemeral certificate, empty with plaintext transport
+
+    bool operator==(const DirectOffer &) const = default;
+};
+
+
 class InitSessionMessage {
 public:
-    static nlohmann::json createSendMessage(const std::filesystem::path &file_path, bool is_compressed);
-    static nlohmann::json createReceiveMessage(const std::string &code);
+    // File is not hashed up front, it is only fingerprinted by its path, size and modification time.
+    // Its content is checked chunk by chunk against Merkle tree leaves which trail the data of every chunk.
+    static nlohmann::json createSendMessage(const std::filesystem::path &file_path, bool is_compressed,
+                                            std::size_t streams = 1,
+                                            std::size_t chunk_size = MerkleTree::DEFAULT_CHUNK_SIZE,
+                                            HashAlgorithm hash_algorithm = DEFAULT_HASH_ALGORITHM);
+    // Data of unknown length read from a pipe goes in a single stream and is checked only as a whole,
+    // against the checksum in the END frame that follows it. It cannot be resumed.
+    static nlohmann::json createPipeSendMessage(const std::string &name,
+                                                HashAlgorithm hash_algorithm = DEFAULT_HASH_ALGORITHM);
+    static bool isPipe(const nlohmann::json &send_json);
+    // With auto_accept the request itself carries receiver's consent, so the server starts relaying right away.
+    static nlohmann::json createReceiveMessage(const std::string &code, bool auto_accept = false);
     static nlohmann::json create(const std::string_view &str);
+    static bool isAutoAccepted(const nlohmann::json &json);
+    static bool acceptsPipe(const nlohmann::json &receive_json);
+    // Interrupted transfers are resumed by sending them again with the old code as resume token,
+    // while the receiver asks for the rest of the file past the offset it already has.
+    static void setResumeToken(nlohmann::json &send_json, const std::string &code);
+    // Several files and directories sent in one transfer are packed into one archive, entries are their names.
+    static void setBundleEntries(nlohmann::json &send_json, const std::vector<std::string> &entries);
+    static std::vector<std::string> bundleEntries(const nlohmann::json &send_json); // empty when not a bundle
+    // Only single-stream transfers can go directly, the server then does not relay their data.
+    static void setDirectOffer(nlohmann::json &send_json, const DirectOffer &offer);
+    static std::optional<DirectOffer> directOffer(const nlohmann::json &send_json);
+    static void setResumePoint(nlohmann::json &receive_json, std::size_t offset, const std::string &file_id);
+    // File id of a send message, or the whole-file hash of a legacy one; the same for the receiver's resume point.
+    static std::string fileId(const nlohmann::json &json);
+    static std::optional<std::string> resumeToken(const nlohmann::json &json);
+    static std::size_t resumeOffset(const nlohmann::json &json);
+    // Extra connections of a striped transfer join the session by its code, each of them carries one stripe.
+    // Chunk size, when given, tells that chunk hashes go along with the stripe's data.
+    static nlohmann::json createStreamJoinMessage(const std::string &action, const std::string &code,
+                                                  std::size_t stream_index, ByteRange stripe,
+                                                  std::optional<std::size_t> chunk_size = std::nullopt);
+    static bool isStreamJoin(const nlohmann::json &json);
+    static std::size_t streamCount(const nlohmann::json &json);
+    static ByteRange stripe(const nlohmann::json &json);
+    // Stripes of a send message, aligned to its chunk size (if it has one) so that no chunk is split between streams.
+    static ByteRange stripeOf(const nlohmann::json &send_json, std::size_t stream_index);
+    // Indexes of extra streams whose stripes are not empty, the empty ones are not opened at all.
+    static std::vector<std::size_t> extraStreams(const nlohmann::json &send_json);
+    static std::optional<std::size_t> chunkSize(const nlohmann::json &json);
+    static bool verifiesChunks(const nlohmann::json &json);
+    // Algorithm the sender's Merkle tree is built with, nullopt if this build does not know it.
+    static std::optional<HashAlgorithm> hashAlgorithm(const nlohmann::json &send_json);
 
 private:
     static void validate(const nlohmann::json& json);
@@ -26,18 +84,49 @@ private:
     static void validateActionKey(const nlohmann::json &json);
     static void validateSingleKeyExists(const nlohmann::json &json, const char *key);
     static void validateStringKey(const nlohmann::json &json, const char *key);
+    static void validateResumeKeys(const nlohmann::json &json);
+    static void validateFileIdKey(const nlohmann::json &json);
+    static void validateStreamJoin(const nlohmann::json &json);
+    static void validateUnsignedKey(const nlohmann::json &json, const char *key);
+    static void validateChunkSizeKey(const nlohmann::json &json);
+    static void validateEntriesKey(const nlohmann::json &json);
+    static void validateDirectKey(const nlohmann::json &json);
+    static void validatePipeKey(const nlohmann::json &json);
+    static std::string fingerprint(const std::filesystem::path &file_path);
 public:
     // send
     static inline const char* FILENAME_KEY{"filename"};
     static inline const char* FILE_SIZE_KEY{"file_size"};
-    static inline const char* FILE_HASH_KEY{"file_hash"};
+    static inline const char* FILE_ID_KEY{"file_id"}; // FILE_HASH_KEY instead for legacy senders
+    static inline const char* FILE_HASH_KEY{"file_hash"}; // SHA-256 of the whole file
     static inline const char* IS_COMPRESSED_KEY{"is_compressed"};
+    static inline const char* RESUME_TOKEN_KEY{"resume_token"}; // optional
+    static inline const char* STREAMS_KEY{"streams"}; // optional, 1 by default
+    static inline const char* CHUNK_SIZE_KEY{"chunk_size"}; // optional, chunk hashes then trail the data
+    static inline const char* HASH_ALGORITHM_KEY{"hash_algorithm"}; // optional, sha256 by default
+    static inline const char* ENTRIES_KEY{"entries"}; // optional, only for bundles of several paths
+    static inline const char* DIRECT_KEY{"direct"}; // optional, object with DirectOffer
+    static inline const char* PIPE_KEY{"pipe"}; // optional, data of unknown length (file size is 0)
+    static inline const char* DIRECT_ADDRESSES_KEY{"addresses"};
+    static inline const char* DIRECT_PORT_KEY{"port"};
+    static inline const char* DIRECT_SESSION_KEY{"session_key"};
+    static inline const char* DIRECT_FINGERPRINT_KEY{"certificate_fingerprint"};
+    static constexpr std::size_t MAX_DIRECT_ADDRESSES{4}; // keeps the send message within server's first message limit
 
     // receive
     static inline const char* CODE_WORDS_KEY{"code_words_key"};
+    static inline const char* AUTO_ACCEPT_KEY{"auto_accept"}; // optional
+    static inline const char* RESUME_OFFSET_KEY{"resume_offset"}; // optional, comes with FILE_ID_KEY
+    static inline const char* VERIFY_CHUNKS_KEY{"verify_chunks"}; // optional, receiver wants chunk hashes relayed
+    static inline const char* ACCEPTS_PIPE_KEY{"accepts_pipe"}; // optional, receiver understands piped data
 
     // both
     static inline const char* ACTION_KEY{"action"};
+
+    // stream join, together with ACTION_KEY and CODE_WORDS_KEY
+    static inline const char* STREAM_INDEX_KEY{"stream_index"};
+    static inline const char* STRIPE_BEGIN_KEY{"stripe_begin"};
+    static inline const char* STRIPE_END_KEY{"stripe_end"};
 };
 
 
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <openssl/ssl.h>
+
+#include <optional>
+#include <string>
+
+
+// Kernel TLS (kTLS) for what a socket sends. Once the handshake is done, the kernel encrypts the records itself,
+// so a file can go to the socket with sendfile() without ever being copied into user space. Handshake stays
+// with OpenSSL, and so does everything that is received.
+// Only TLS 1.3 with AES-GCM or ChaCha20-Poly1305 is handed over; keys are derived from the traffic secret
+// recorded during the handshake, which is why the context has to capture it (see captureTrafficSecrets).
+
+struct TrafficKeys {
+    std::string key;
+    std::string iv;
+};
+
+// Keeps the application traffic secret this end sends with in every SSL object made from the context.
+void captureTrafficSecrets(SSL_CTX *context);
+// Keys this end encrypts application data with (RFC 8446, section 7.3). Nullopt when the connection does not
+// use TLS 1.3 with a cipher the kernel supports, or its secret has not been captured.
+std::optional<TrafficKeys> sendingTrafficKeys(const SSL *ssl);
+// Must be called right after the handshake, before anything else is sent, since the kernel starts counting
+// records from zero. False when the kernel cannot take over (e.g. no tls module), then nothing has changed.
+bool enableKernelTlsSend(const SSL *ssl, int socket);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+#include "Hasher.hpp"
+#include "Striping.hpp"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+class MerkleTreeException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+// Indexes [first, end) of consecutive chunks.
+struct ChunkSpan {
+    std::size_t first{0};
+    std::size_t end{0};
+
+    std::size_t size() const {
+        return end - first;
+    }
+
+    bool contains(std::size_t index) const {
+        return first <= index && index < end;
+    }
+};
+
+
+// Binary hash tree over fixed-size chunks of a file, its root identifies the file the same way
+// a whole-file hash would, while every chunk can be checked on its own against its leaf.
+// Leaves and inner nodes are domain-separated (0x00 / 0x01 prefix), the last node of an odd level is promoted as is.
+// Every node is the first DIGEST_SIZE bytes of the algorithm's digest. Empty file has a single leaf of the empty chunk.
+class MerkleTree {
+public:
+    using Digest = std::string; // DIGEST_SIZE raw bytes
+
+    MerkleTree(std::size_t chunk_size, std::vector<Digest> leaves, HashAlgorithm algorithm = HashAlgorithm::sha256);
+    // Chunks are hashed on `threads` threads, the tree is the same for any number of them.
+    static MerkleTree fromFile(const std::filesystem::path &path, std::size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                               HashAlgorithm algorithm = HashAlgorithm::sha256,
+                               std::size_t threads = defaultHashingThreads());
+
+    std::string root() const; // hex-encoded
+    std::size_t chunkSize() const;
+    const std::vector<Digest> &leaves() const;
+
+    static Digest hashLeaf(std::string_view chunk, HashAlgorithm algorithm = HashAlgorithm::sha256);
+    // Leaves of the given chunks of a file (in the same order), read with FileReader and hashed in parallel.
+    static std::vector<Digest> hashChunks(const std::filesystem::path &path, std::size_t chunk_size,
+                                          const std::vector<std::size_t> &chunk_indexes,
+                                          HashAlgorithm algorithm = HashAlgorithm::sha256,
+                                          std::size_t threads = defaultHashingThreads());
+    static std::size_t defaultHashingThreads(); // one per core
+    static std::size_t chunkCount(std::size_t file_size, std::size_t chunk_size);
+    static ChunkSpan chunksOf(ByteRange range, std::size_t chunk_size); // chunks that overlap the range
+    // Chunks whose leaves go along with the stripe, the only chunk of an empty file goes with its empty first stripe.
+    static ChunkSpan leavesOf(ByteRange stripe, std::size_t file_size, std::size_t chunk_size);
+    static void validateChunkSize(std::size_t chunk_size);
+
+    static constexpr std::size_t DIGEST_SIZE{32};
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE{1024 * 1024}; // 1 MiB
+    static constexpr std::size_t MIN_CHUNK_SIZE{4 * 1024}; // 4 KiB
+    static constexpr std::size_t MAX_CHUNK_SIZE{64 * 1024 * 1024}; // 64 MiB
+private:
+    static Digest hashNode(Hasher &hasher, const Digest &left, const Digest &right);
+
+    std::size_t chunk_size;
+    std::vector<Digest> leaf_digests;
+    Digest root_digest;
+};
+
+
+// Incremental hash of a single chunk, gives the same digest as MerkleTree::hashLeaf of the whole chunk.
+class LeafHasher {
+public:
+    explicit LeafHasher(HashAlgorithm algorithm = HashAlgorithm::sha256);
+
+    void update(std::string_view data);
+    void updateFromFile(const std::filesystem::path &path, ByteRange range,
+                        std::size_t read_buffer_size = DEFAULT_READ_BUFFER_SIZE);
+    MerkleTree::Digest finish(); // starts the next leaf right away
+private:
+    void startLeaf();
+
+    Hasher hasher;
+};
+
+
+// Hashes chunks of a range while its bytes go by, each leaf is handed over as soon as its chunk is complete.
+// Range has to end at a chunk boundary or at the end of file. When it begins in the middle of a chunk,
+// the part of that chunk before the range is read from the file at path.
+class RangeHasher {
+public:
+    using LeafCallback = std::function<void(std::size_t chunk_index, MerkleTree::Digest leaf)>;
+
+    RangeHasher(const std::filesystem::path &path, std::size_t file_size, std::size_t chunk_size, ByteRange range,
+                HashAlgorithm algorithm = HashAlgorithm::sha256);
+    void update(std::string_view data, const LeafCallback &on_leaf);
+private:
+    std::size_t file_size;
+    std::size_t chunk_size;
+    std::size_t position;
+    std::size_t chunk_index;
+    LeafHasher hasher;
+};
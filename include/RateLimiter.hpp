@@ -0,0 +1,40 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+
+class RateLimiterException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+// Token bucket shared by everything that sends data of a single transfer (e.g. all its streams).
+// Bucket holds at most burstSize() bytes, worth BURST_DURATION of the rate, and it is allowed to go into debt,
+// so a frame bigger than that is sent right away and the next one waits until the debt is paid off.
+// Senders keep their frames within burstSize(), so the traffic is paced in small steps instead of whole frames.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateLimiter(std::size_t bytes_per_second, Clock::time_point now = Clock::now());
+
+    // Takes bytes out of the bucket, returns how long to wait before sending them.
+    Clock::duration reserve(std::size_t bytes, Clock::time_point now);
+    // Blocking counterpart of reserve().
+    void acquire(std::size_t bytes);
+    std::size_t burstSize() const;
+    std::size_t bytesPerSecond() const;
+
+    static constexpr std::chrono::milliseconds BURST_DURATION{10};
+    static constexpr std::size_t MIN_BURST_SIZE{16 * 1024};
+private:
+    std::mutex m;
+    std::size_t bytes_per_second;
+    std::size_t burst_size;
+    double tokens; // negative while in debt
+    Clock::time_point last_refill;
+};
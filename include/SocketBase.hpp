@@ -1,55 +1,126 @@
 #pragma once
 #include "DropFileBaseException.hpp"
+#include "Framing.hpp"
+#include "StreamPolicy.hpp"
 
 #include <boost/asio.hpp>
-#include <boost/asio/ssl.hpp>
 
+#include <deque>
 #include <optional>
 
 
-using boost::asio::ip::tcp;
-
 class SocketException : public DropFileBaseException {
 public:
     using DropFileBaseException::DropFileBaseException;
 };
 
 
-// Every message is preceded by header that contains amount of bytes to send
-class SocketBase : public std::enable_shared_from_this<SocketBase> {
+// Every message is preceded by header that contains amount of bytes to send (see Framing.hpp for both wire formats).
+// Sockets start in the legacy protocol; framed one is negotiated with Hello by the client.
+// Stream_t is the transport (see StreamPolicy.hpp), instantiated for TlsStream and PlainStream.
+template<class Stream_t = TlsStream>
+class SocketBase : public std::enable_shared_from_this<SocketBase<Stream_t>> {
 public:
-    SocketBase(boost::asio::ssl::stream<tcp::socket> socket_);
+    using Stream = Stream_t;
+
+    SocketBase(Stream_t socket_);
     SocketBase(SocketBase&&) = default;
 
     virtual ~SocketBase() = default;
 
     using MessageHandler = std::function<void(std::string_view)>;
+    using FrameHandler = std::function<void(const Frame &)>;
+    using SentHandler = std::function<void()>;
     void asyncReadMessage(std::size_t max_message_size, MessageHandler message_handler);
+    void asyncReadFrame(std::size_t max_payload_size, FrameHandler frame_handler);
+    // Server side: detects whether the client opened with Hello, answers it and reads the first frame.
+    // Negotiated frame size is the smaller of frame_size_limit and the client's proposal.
+    void asyncAcceptProtocol(std::size_t max_first_message_size, std::size_t frame_size_limit,
+                             FrameHandler frame_handler);
+    void asyncSend(std::string_view data, SentHandler sent_handler);
+    void asyncSendFrame(FrameType type, std::string_view payload, SentHandler sent_handler);
+    // Fire-and-forget send of small control frames; frames are written one after another in queued order.
+    void queueFrame(FrameType type, std::string_view payload);
     void disconnect(std::optional<std::string> disconnect_msg);
+    void close();
+    // Makes blocking reads and writes of other threads fail, e.g. when one stream of a striped transfer breaks.
+    void shutdown();
 
     void send(std::string_view data);
+    void sendFrame(FrameType type, std::string_view payload);
+    // Hands sending to the kernel, encryption included (kTLS), so that sendFileFrame can be used. Has to be called
+    // before anything is sent after the handshake. False when the kernel cannot take it, nothing changes then.
+    bool enableKernelSend();
+    bool sendsFromKernel() const;
+    // DATA frame with size bytes of the file at offset as its payload, which goes from the page cache
+    // to the socket with sendfile(), never through user space. Framed protocol and kernel sending only.
+    void sendFileFrame(int file, std::size_t offset, std::size_t size);
     std::string receive();
     std::string_view receiveToBuffer();
+    // Skips CREDIT frames, adding them to available send credit.
+    Frame receiveFrame();
 
-    void receiveACK();
+    // Returns ACK's payload (if any), e.g. checksum reported by the receiver.
+    std::string receiveACK();
     void sendACK();
 
+    // Credit-based flow control of DATA frames. In legacy protocol there is none, so credit is unlimited.
+    void grantCredit(std::size_t bytes);
+    std::size_t awaitCredit();
+    void consumeCredit(std::size_t bytes);
+    bool isACK(const Frame &frame) const;
+    bool isFramed() const;
+    std::size_t maxFrameSize() const;
+    int nativeHandle(); // e.g. for SocketTuner
+
+    // Shares memory with payloads returned by receiveToBuffer.
     std::pair<char*, std::size_t> getBuffer();
 protected:
-    void sendChunk(std::string_view data);
-    std::size_t getMessageLength() ;
-    void asyncReadHeader(size_t max_msg_size, MessageHandler message_handler);
-    void asyncReadMessageImpl(std::shared_ptr<SocketBase> self, std::function<void(std::string_view)> message_handler,
-                              unsigned long message_size);
+    std::size_t prepareHeader(FrameType type, std::string_view &payload, FrameHeaderBuffer &header) const;
+    void write(std::string_view header, std::string_view payload = {});
+    FrameHeader readFrameHeader();
+    FrameHeader parseLegacyHeader() const;
+    Frame takeFrame(const FrameHeader &header);
+    void receiveHello();
+    Frame receiveAnyFrame();
+    bool absorbCredit(const Frame &frame);
+    void writeQueuedFrames();
+    void asyncReadFrameHeader(std::size_t max_payload_size, FrameHandler frame_handler);
+    void asyncReadFramePayload(const FrameHeader &header, std::size_t max_payload_size, FrameHandler frame_handler);
+    void asyncFillReadBuffer(std::size_t bytes, std::function<void()> on_filled);
+    void fillReadBuffer(std::size_t bytes);
+    void reserveReadSpace(std::size_t bytes);
+    void alignPayload(const FrameHeader &header);
+    void setMaxFrameSize(std::size_t frame_size);
+    void resetConnectionState();
+    // Called when any async read or write fails, e.g. because the peer's connection is gone.
+    virtual void onAsyncError(const boost::system::error_code &ec);
+    std::size_t readLimit() const;
+    static std::unique_ptr<char[]> allocateReadBuffer(std::size_t frame_size);
+    std::span<const char> bufferedBytes() const;
+    void consume(std::size_t bytes);
     void safeDisconnect(std::optional<std::string> disconnect_msg);
 
 
     using MSG_HEADER_t = std::size_t;
-    boost::asio::ssl::stream<tcp::socket> socket_;
-    std::unique_ptr<char[]> data_buffer;
+    Stream_t socket_;
+    WireProtocol protocol{WireProtocol::legacy};
+    bool awaiting_hello{false};
+    std::size_t requested_frame_size{DEFAULT_FRAME_SIZE};
+    std::size_t max_frame_size{DEFAULT_FRAME_SIZE};
+    std::unique_ptr<char[]> read_buffer;
+    std::size_t read_begin{0};
+    std::size_t read_end{0};
+    FrameHeaderBuffer async_send_header{};
+    HelloBuffer hello_buffer{};
+    std::size_t send_credit{0};
+    std::deque<std::string> write_queue;
+    bool has_sent{false}; // since the handshake
+    bool kernel_send{false};
     static inline const std::string ACK{"ACK"};
+    static inline const std::string ABORT{"abort"};
 public:
-    static constexpr MSG_HEADER_t BUFFER_SIZE{1024 * 1024 * 1}; // 1 MiB
+    static constexpr MSG_HEADER_t BUFFER_SIZE{DEFAULT_FRAME_SIZE}; // frame size until negotiated otherwise
+protected:
+    static constexpr std::size_t PAYLOAD_OFFSET{MAX_FRAME_HEADER_SIZE};
 };
-
-
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+
+// Transport tuning applied to every connection that carries file data, on the clients and on the relay alike.
+struct TuningProfile {
+    std::string congestion_control{}; // e.g. "bbr", kernel's default when empty or not allowed
+};
+
+struct TuningReport {
+    std::string congestion_control;
+    std::chrono::microseconds rtt{0};
+    double bytes_per_second{0};
+    std::size_t send_buffer{0};
+    std::size_t receive_buffer{0};
+};
+
+std::string toString(const TuningReport &report);
+
+
+// Chooses congestion control up front and sizes socket buffers to the bandwidth-delay product measured
+// during the first MEASUREMENT_PERIOD of the transfer (RTT as the kernel sees it, throughput as recorded),
+// so that long fast links are not bounded by default kernel windows.
+// Buffers only ever grow, since setting them turns off kernel's own autotuning for the socket.
+class SocketTuner {
+public:
+    using Clock = std::chrono::steady_clock;
+    using NativeHandle = int;
+
+    SocketTuner(NativeHandle socket, const TuningProfile &profile, Clock::time_point now = Clock::now());
+
+    // Returns true when the buffers have just been sized, which happens once.
+    bool recordTransferred(std::size_t bytes, Clock::time_point now);
+    const TuningReport &report() const;
+
+    // Twice the BDP, so that a full window fits while the previous one is being acknowledged.
+    static std::size_t bufferSizeFor(std::chrono::microseconds rtt, double bytes_per_second);
+
+    static constexpr std::chrono::seconds MEASUREMENT_PERIOD{2};
+    static constexpr std::size_t MIN_BUFFER_SIZE{256 * 1024};
+    static constexpr std::size_t MAX_BUFFER_SIZE{64 * 1024 * 1024};
+private:
+    void applyCongestionControl(const std::string &congestion_control);
+    void sizeBuffers(Clock::time_point now);
+    std::size_t growBuffer(int option, std::size_t size) const;
+    std::size_t bufferSize(int option) const;
+
+    NativeHandle socket;
+    Clock::time_point started;
+    std::size_t bytes_transferred{0};
+    bool is_tuned{false};
+    TuningReport tuning_report;
+};
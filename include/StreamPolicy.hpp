@@ -0,0 +1,96 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <filesystem>
+
+
+using boost::asio::ip::tcp;
+
+using TlsStream = boost::asio::ssl::stream<tcp::socket>;
+using PlainStream = tcp::socket;
+using HandshakeType = boost::asio::ssl::stream_base::handshake_type;
+
+// Compile-time transport policy. Describes how to create and set up given stream type,
+// so that SocketBase and everything built on top of it does not care whether the bytes are encrypted.
+template<class Stream_t>
+struct StreamPolicy;
+
+template<>
+struct StreamPolicy<TlsStream> {
+    using Context = boost::asio::ssl::context;
+    static constexpr bool IS_ENCRYPTED{true};
+
+    static Context createServerContext(const std::filesystem::path &key_cert_dir);
+    static Context createClientContext();
+
+    static TlsStream createStream(tcp::socket socket, Context &context) {
+        return {std::move(socket), context};
+    }
+
+    static TlsStream createStream(boost::asio::io_context &io_context, Context &context) {
+        return {io_context, context};
+    }
+
+    static void handshake(TlsStream &stream, HandshakeType type) {
+        stream.handshake(type);
+    }
+
+    template<class Handler>
+    static void asyncHandshake(TlsStream &stream, HandshakeType type, Handler &&handler) {
+        stream.async_handshake(type, std::forward<Handler>(handler));
+    }
+
+    // TCP socket under the TLS one.
+    static tcp::socket &socketOf(TlsStream &stream) {
+        return stream.next_layer();
+    }
+
+    // Hands encryption of what is sent to the kernel (see KernelTls.hpp), false when it cannot take it.
+    static bool enableKernelSend(TlsStream &stream);
+};
+
+
+// Meant for deployments where TLS is terminated in front of the server (e.g. by a proxy) and for local benchmarks.
+struct NoTlsContext {};
+
+template<>
+struct StreamPolicy<PlainStream> {
+    using Context = NoTlsContext;
+    static constexpr bool IS_ENCRYPTED{false};
+
+    static Context createServerContext(const std::filesystem::path &) {
+        return {};
+    }
+
+    static Context createClientContext() {
+        return {};
+    }
+
+    static PlainStream createStream(tcp::socket socket, Context &) {
+        return socket;
+    }
+
+    static PlainStream createStream(boost::asio::io_context &io_context, Context &) {
+        return PlainStream{io_context};
+    }
+
+    static void handshake(PlainStream &, HandshakeType) {}
+
+    template<class Handler>
+    static void asyncHandshake(PlainStream &stream, HandshakeType, Handler &&handler) {
+        boost::asio::post(stream.get_executor(), [handler = std::forward<Handler>(handler)]() mutable {
+            handler(boost::system::error_code{});
+        });
+    }
+
+    static tcp::socket &socketOf(PlainStream &stream) {
+        return stream;
+    }
+
+    // Kernel sends plain bytes on its own.
+    static bool enableKernelSend(PlainStream &) {
+        return true;
+    }
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+
+// Striped transfers send the file over a few parallel connections, each of them carries one contiguous range.
+struct ByteRange {
+    std::size_t begin{0};
+    std::size_t end{0};
+
+    std::size_t size() const {
+        return end - begin;
+    }
+
+    bool operator==(const ByteRange &) const = default;
+};
+
+// Splits file_size bytes into `streams` ranges of nearly equal size, first ranges are at most one `alignment` longer.
+// Every range but the last one ends at a multiple of alignment.
+// Ranges are computed independently by both clients and the server, so the split has to stay deterministic.
+ByteRange stripeRange(std::size_t file_size, std::size_t streams, std::size_t index, std::size_t alignment = 1);
+
+constexpr std::size_t MAX_STREAMS{16};
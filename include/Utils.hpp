@@ -1,5 +1,6 @@
 #pragma once
 #include "DropFileBaseException.hpp"
+#include "Hasher.hpp"
 
 #include <stdint.h>
 #include <indicators/progress_bar.hpp>
@@ -13,7 +14,10 @@ public:
     using DropFileBaseException::DropFileBaseException;
 };
 
-std::string calculateFileHash(const std::filesystem::path& path);
+std::string calculateFileHash(const std::filesystem::path& path, HashAlgorithm algorithm = HashAlgorithm::sha256,
+                              std::size_t read_buffer_size = DEFAULT_READ_BUFFER_SIZE);
+
+std::string binaryToHumanReadable(std::string_view data);
 
 std::string bytesToHumanReadable(std::size_t bytes);
 
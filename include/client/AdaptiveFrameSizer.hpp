@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+
+// Picks size of the next outgoing frame, so that sending it takes roughly TARGET_FRAME_DURATION
+// at the throughput measured so far. Small frames keep latency low on slow links,
+// big ones cut per-frame syscalls and TLS records on fast ones.
+class AdaptiveFrameSizer {
+public:
+    explicit AdaptiveFrameSizer(std::size_t max_frame_size);
+
+    std::size_t frameSize() const;
+    void recordSend(std::size_t bytes, std::chrono::nanoseconds elapsed);
+
+    static constexpr std::size_t INITIAL_FRAME_SIZE{64 * 1024};
+    static constexpr std::chrono::milliseconds TARGET_FRAME_DURATION{5};
+    static constexpr double SMOOTHING_FACTOR{0.25};
+private:
+    std::size_t max_frame_size;
+    std::size_t frame_size;
+    double bytes_per_second{0};
+};
@@ -1,8 +1,9 @@
 #pragma once
 #include "DropFileBaseException.hpp"
+#include "FileReader.hpp"
 #include "client/FSEntryInfo.hpp"
+#include "client/ProgressMeter.hpp"
 
-#include <indicators/indeterminate_progress_bar.hpp>
 #include <zlib.h>
 
 #include <iostream>
@@ -20,21 +21,26 @@ public:
 
 class ArchiveManager {
 public:
-    ArchiveManager(fs::path directory);
+    // With quiet no progress is drawn (see ProgressMeter.hpp).
+    ArchiveManager(fs::path directory, bool quiet = false);
+    // Archive of several files and directories, each one at its top level under its own name.
+    explicit ArchiveManager(std::vector<fs::path> entries, bool quiet = false);
 
     void createArchive(const fs::path& new_archive_path);
     void unpackArchive(const fs::path& archive_path);
 
 private:
-    void unpackFile(std::ifstream &compressed_archive, const FSEntryInfo &entry_info);
-    void packDirectory(const fs::path &dir_to_compress, std::ofstream& new_archive,
+    void unpackFile(FileReaderStream &compressed_archive, const FSEntryInfo &entry_info);
+    void packDirectory(const fs::path &dir_to_compress, std::ofstream& new_archive, ProgressMeter &progress,
                        const fs::path &relative_path = "");
-    void addFile(const fs::path &file_path, std::ofstream &compressed_archive, const fs::path &relative_path);
+    void addFile(const fs::path &file_path, std::ofstream &compressed_archive, ProgressMeter &progress,
+                 const fs::path &relative_path);
     void addDirectory(std::ofstream &new_archive, const fs::path &relative_path);
 
 
     fs::path directory;
-    indicators::IndeterminateProgressBar progress_bar;
+    std::vector<fs::path> entries;
+    bool quiet;
 };
 
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+
+// Connects two stages of a transfer pipeline running on different threads. Producer blocks while the queue is full,
+// so the faster stage can get at most capacity items ahead of the slower one.
+// Either side may close() it: the consumer then gets what is left followed by nullopt, the producer's push() fails
+// at once, which is how a stage that has failed stops the other one.
+template<class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity(capacity) {}
+
+    // Returns false when the queue has been closed, item is then dropped.
+    bool push(T item) {
+        std::unique_lock lock{m};
+        not_full.wait(lock, [this] { return is_closed || items.size() < capacity; });
+        if (is_closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Returns nullopt once the queue is closed and empty.
+    std::optional<T> pop() {
+        std::unique_lock lock{m};
+        not_empty.wait(lock, [this] { return is_closed || !items.empty(); });
+        if (items.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return item;
+    }
+
+    void close() {
+        std::lock_guard lock{m};
+        is_closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    std::size_t capacity;
+    bool is_closed{false};
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+#include "Framing.hpp"
+#include "MerkleTree.hpp"
+#include "Striping.hpp"
+
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+
+class ChunkVerifierException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+// Thrown as soon as both a whole chunk and its leaf have been received and they do not match.
+class CorruptedChunkException: public ChunkVerifierException {
+public:
+    explicit CorruptedChunkException(std::size_t chunk_begin);
+    std::size_t chunkBegin() const;
+private:
+    std::size_t chunk_begin;
+};
+
+
+// Checks received file against leaves of the sender's Merkle tree chunk by chunk, while the transfer is still running.
+// Sender hashes every chunk as it reads it and sends its leaf right after the chunk, so neither side reads
+// the file twice. Every stream verifies its own stripe and accepts only leaves of the chunks of that stripe.
+// Chunks that are not received whole in this transfer (those already on disk when it was resumed)
+// are read back from disk by root().
+// Data and leaves of a stripe may be fed from different threads (see DropFileReceiveClient::receiveRange).
+class ChunkVerifier {
+public:
+    ChunkVerifier(std::size_t file_size, std::size_t chunk_size, HashAlgorithm algorithm = HashAlgorithm::sha256);
+
+    class RangeVerifier {
+    public:
+        RangeVerifier(ChunkVerifier &verifier, ByteRange stripe, std::size_t offset,
+                      const std::filesystem::path &partial_path);
+        void update(std::string_view data);
+        void addExpectedLeaves(const ChunkHashes &hashes);
+        // Every chunk received in this stream has been verified and leaves of the others have arrived.
+        bool isComplete() const;
+        // Leaves of all chunks of the stripe have arrived, the data may still be being verified.
+        bool hasExpectedLeaves() const;
+    private:
+        ChunkVerifier &verifier;
+        ChunkSpan leaves;
+        ChunkSpan received_chunks;
+        RangeHasher hasher;
+        std::size_t expected_count{0};
+        std::size_t received_count{0};
+    };
+    // Data of the stripe arrives from offset on, leaves may come before or after their chunks.
+    RangeVerifier verifyRange(ByteRange stripe, std::size_t offset, const std::filesystem::path &partial_path);
+
+    // Root of the tree of the file as it is on disk, to be compared with expectedRoot().
+    std::string root(const std::filesystem::path &partial_path) const;
+    std::string expectedRoot() const;
+private:
+    void verifyChunk(std::size_t chunk_index) const;
+
+    std::size_t file_size;
+    std::size_t chunk_size;
+    HashAlgorithm algorithm;
+    std::mutex m; // guards comparing leaves of a chunk against setting either of them
+    // one entry per chunk, empty until known; every stream sets only the ones of its own stripe
+    std::vector<MerkleTree::Digest> expected_leaves;
+    std::vector<MerkleTree::Digest> received_leaves;
+};
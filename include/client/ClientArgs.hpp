@@ -1,7 +1,12 @@
 #pragma once
 
+#include "Hasher.hpp"
+#include "SocketTuning.hpp"
+#include "TransferStats.hpp"
+
 #include <string>
 #include <optional>
+#include <vector>
 
 enum class Action {
     send,
@@ -10,11 +15,24 @@ enum class Action {
 
 struct ClientArgs {
     Action action;
-    std::optional<std::string> file_to_send_path{std::nullopt};
+    std::vector<std::string> files_to_send{}; // sent together in one transfer
     std::optional<std::string> receive_code{std::nullopt};
     unsigned short port;
     std::string server_domain_name;
     bool verify_cert;
+    bool auto_accept{false};
+    std::size_t reconnect_attempts{0};
+    std::size_t streams{1};
+    HashAlgorithm hash_algorithm{DEFAULT_HASH_ALGORITHM};
+    bool direct{false}; // offer the receiver a direct connection, the server relays only as a fallback
+    TuningProfile tuning_profile{};
+    std::size_t rate_limit{0}; // bytes per second, 0 means no limit
+    bool zero_copy{false}; // kernel sends the file straight from the page cache (kTLS + sendfile) when it can
+    bool direct_io{false}; // received file is written with O_DIRECT, past the page cache
+    bool to_stdout{false}; // received data is written to standard output
+    bool quiet{false}; // no progress is drawn
+    std::optional<StatsFormat> stats{std::nullopt}; // every phase of the transfer is measured, then reported in it
 
     static inline std::string DEFAULT_SERVER_DOMAIN{"balitohome.duckdns.org"};
+    static inline const std::string STANDARD_STREAM{"-"}; // standard input to send, standard output to receive to
 };
\ No newline at end of file
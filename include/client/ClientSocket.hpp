@@ -2,26 +2,67 @@
 
 #include "SocketBase.hpp"
 
+#include <chrono>
 #include <thread>
 #include <fstream>
+#include <vector>
 
-class ClientSocket : public SocketBase {
+// Base classes are constructed before and destroyed after members, so io_context is held in a base
+// listed before SocketBase, otherwise it would be destroyed while the socket still uses it.
+struct IoContextHolder {
+    std::unique_ptr<boost::asio::io_context> io_context;
+};
+
+// How long each phase of connecting to the server took.
+struct ConnectTimings {
+    std::chrono::microseconds dns{0};
+    std::chrono::microseconds tcp{0}; // of the attempt that has won the race
+    std::chrono::microseconds tls{0};
+    std::size_t attempts{0};
+};
+
+// RFC 8305 order: address families alternate, starting with the one the resolver has put first.
+std::vector<tcp::endpoint> interleaveAddressFamilies(const std::vector<tcp::endpoint> &endpoints);
+
+template<class Stream_t = TlsStream>
+class ClientSocket : private IoContextHolder, public SocketBase<Stream_t> {
 public:
     ClientSocket(const std::string &host, unsigned short port, bool verify_cert = true);
+    // Adopts a connection between the two clients in direct mode (see DirectLink.hpp), which has no server to reconnect to.
+    ClientSocket(tcp::socket connected, typename StreamPolicy<Stream_t>::Context context);
     ClientSocket(ClientSocket&&) = default;
     ~ClientSocket();
 
+    // Races connections to all the resolved addresses (RFC 8305 Happy Eyeballs): a new attempt starts every
+    // CONNECTION_ATTEMPT_DELAY or as soon as the previous one fails, the first one to finish its handshake wins.
     void connect(const std::string &host, unsigned short port);
+    const ConnectTimings &connectTimings() const;
+    // Replaces the broken connection with a new one to the same server. Framed protocol has to be requested again.
+    void reconnect();
+    // Opens another connection to the same server, e.g. for extra streams of a striped transfer.
+    ClientSocket connectAnother() const;
+    // Sends Hello without waiting for the answer, server's Hello is consumed before the first received frame.
+    // Until then frames are at most BUFFER_SIZE big.
+    void requestFramedProtocol(std::size_t frame_size_limit = MAX_FRAME_SIZE);
+    // Handshake over an adopted connection. Connecting client accepts only the certificate with the given fingerprint.
+    void handshakeWithPeer(HandshakeType type, const std::string &peer_fingerprint = {});
 private:
-    ClientSocket(std::unique_ptr<boost::asio::io_context> io_context, boost::asio::ssl::context context);
+    using Context = typename StreamPolicy<Stream_t>::Context;
+    ClientSocket(std::unique_ptr<boost::asio::io_context> io_context, Context context);
 
+    void setUpCertVerification(bool verify_cert);
+    void verifyCertificateOf(Stream_t &stream);
     bool verify_certificate(bool preverified, boost::asio::ssl::verify_context &ctx);
     void start();
 
 
-    std::unique_ptr<boost::asio::io_context> io_context;
-    boost::asio::ssl::context context;
+    Context context;
+    std::string host;
+    unsigned short port{0};
+    bool verify_cert{true};
+    ConnectTimings connect_timings;
     std::jthread context_thread;
+    static constexpr std::chrono::milliseconds CONNECTION_ATTEMPT_DELAY{250};
 };
 
 // sadly io_context does not provide move constructor
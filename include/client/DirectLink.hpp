@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ClientSocket.hpp"
+#include "InitSessionMessage.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// LAN direct mode, the server is used only for the rendezvous. Sender listens on an ephemeral port and offers
+// its addresses, that port, a per-session key and the fingerprint of its ephemeral self-signed certificate
+// in the send message, which the server relays to the receiver. Receiver connects to the first address that answers,
+// pins that certificate and proves with the key that it is the one the offer was meant for.
+// Data then goes over this connection, while control frames (e.g. the final ACK) still go through the server.
+// Whenever setting it up fails, both clients fall back to the relay.
+template<class Stream_t = TlsStream>
+class DirectListener {
+public:
+    DirectListener();
+
+    const DirectOffer &offer() const;
+    // Waits at most timeout for the receiver, nullopt when it has not come or has not proven it knows the key.
+    std::optional<ClientSocket<Stream_t>> accept(std::chrono::milliseconds timeout);
+private:
+    boost::asio::io_context io_context;
+    tcp::acceptor acceptor;
+    DirectOffer direct_offer;
+    typename StreamPolicy<Stream_t>::Context context; // fills in the offer's certificate fingerprint
+};
+
+// Tries offered addresses one by one within timeout, nullopt when none of them has led to the sender.
+template<class Stream_t = TlsStream>
+std::optional<ClientSocket<Stream_t>> connectDirectly(const DirectOffer &offer, std::chrono::milliseconds timeout);
+
+// IPv4 addresses of the interfaces that are up, loopback last, at most InitSessionMessage::MAX_DIRECT_ADDRESSES.
+std::vector<std::string> localAddresses();
+std::string certificateFingerprint(X509 *certificate);
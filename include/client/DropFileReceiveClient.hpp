@@ -1,11 +1,23 @@
 #pragma once
 #include "ClientSocket.hpp"
+#include "DirectLink.hpp"
+#include "FlowControlWindow.hpp"
+#include "ReconnectPolicy.hpp"
+#include "ResumeCheckpoint.hpp"
+#include "PositionalFile.hpp"
+#include "ChunkVerifier.hpp"
+#include "Striping.hpp"
+#include "SocketTuning.hpp"
+#include "TransferStats.hpp"
 
 #include <nlohmann/json.hpp>
 
 #include <string>
 #include <iostream>
 #include <filesystem>
+#include <optional>
+#include <atomic>
+#include <functional>
 
 
 class DropFileReceiveException: public DropFileBaseException {
@@ -14,24 +26,91 @@ public:
 };
 
 
+template<class T>
+class BoundedQueue;
+class ProgressMeter;
+
+template<class Stream_t = TlsStream>
 class DropFileReceiveClient {
 public:
-    DropFileReceiveClient(ClientSocket socket, std::istream& interaction_stream = std::cin);
-    ~DropFileReceiveClient();
+    // With auto_accept the user is not asked, consent and the first credit are sent along with the request.
+    // Data is written to a partial file with a checkpoint next to it, so when the connection is lost
+    // the client reconnects according to reconnect_policy and asks only for the missing part of the file.
+    // Every stream that carries data is tuned according to tuning_profile (see SocketTuning.hpp).
+    // Files are written in large blocks, huge ones bypassing page cache; with direct_io with O_DIRECT where possible
+    // (see RangeWriter.hpp).
+    // With output the received data is written to it (e.g. standard output) instead of the current directory.
+    // Piped data goes there as it comes, a file only once it has been received and verified.
+    // With quiet no progress is drawn (see ProgressMeter.hpp).
+    // With stats every phase of the transfer is measured into them (see TransferStats.hpp).
+    DropFileReceiveClient(ClientSocket<Stream_t> socket, std::istream& interaction_stream = std::cin,
+                          bool auto_accept = false, ReconnectPolicy reconnect_policy = {},
+                          TuningProfile tuning_profile = {}, bool direct_io = false, std::ostream *output = nullptr,
+                          bool quiet = false, TransferStats *stats = nullptr);
 
     void receiveFile(const std::string& code_words);
 private:
+    struct ReceivedData {
+        std::size_t position;
+        std::string bytes;
+    };
+
+    nlohmann::json requestTransfer(const std::string &code_words);
+    void receiveTransfer(const std::string &code_words, const nlohmann::json &server_response);
+    void confirmTransfer(const nlohmann::json &server_response, bool accepted_in_advance);
     void getUserConfirmation();
-    void receiveFileImpl(const std::filesystem::path &file_to_receive_path, std::size_t expected_bytes);
-    void handleCompressedFile(bool is_compressed, const std::filesystem::path &compressed_file_path) const;
-    void validateFileHash(const std::filesystem::path &compressed_file_path, const std::string &expected_file_hash) const;
+    void grantInitialCredit(ClientSocket<Stream_t> &data_socket);
+    void setUpDirectLink(const nlohmann::json &server_response);
+    void receivePipe(const nlohmann::json &server_response);
+    std::string receivePipeData(ClientSocket<Stream_t> &data_socket, Hasher &hasher,
+                                const std::function<void(std::string_view)> &write);
+    void receiveFileImpl(const std::string &code_words, ResumeCheckpoint progress,
+                         const nlohmann::json &server_response);
+    std::optional<ChunkVerifier::RangeVerifier> verifyRange(ByteRange stripe, std::size_t offset,
+                                                            const std::filesystem::path &partial_path);
+    void receiveStripe(ClientSocket<Stream_t> &stream_socket, const std::string &code_words, PositionalFile &file,
+                       const nlohmann::json &server_response, std::size_t index,
+                       ProgressMeter &progress);
+    void receiveRange(ClientSocket<Stream_t> &stream_socket, FlowControlWindow &window,
+                      FlowControlWindow::Clock::time_point granted_at, PositionalFile &file, ByteRange range,
+                      std::optional<ChunkVerifier::RangeVerifier> &range_verifier,
+                      const std::function<void(std::size_t)> &on_written);
+    void writeRange(PositionalFile &file, std::optional<ChunkVerifier::RangeVerifier> &range_verifier,
+                    BoundedQueue<ReceivedData> &received, const std::function<void(std::size_t)> &on_written);
+    void finalizeReceivedFile(bool is_compressed, const std::filesystem::path &partial_path,
+                              const std::string &filename) const;
+    void acknowledgeWithChecksum(const std::filesystem::path &received_file_path, const std::string &expected_file_hash);
     void assertJsonProperties(const nlohmann::json &json);
     nlohmann::json getServerResponse();
+    std::filesystem::path partialFilePath(const std::string &filename, bool is_compressed) const;
+    void saveCheckpoint(const std::string &code_words, const ResumeCheckpoint &progress) const;
+    void discardCheckpoint(const std::string &code_words) const;
+    static std::optional<std::filesystem::path> checkpointPath(const std::string &code_words);
 
 
-    ClientSocket socket;
+    ClientSocket<Stream_t> socket;
     std::istream& interaction_stream; // to enable automatic testing with stream that is not a standard input
-    static inline std::filesystem::path DROP_FILE_RECEIVER_TMP_DIR{std::filesystem::temp_directory_path() / "drop-file" / "receiver"};
+    bool auto_accept;
+    ReconnectPolicy reconnect_policy;
+    TuningProfile tuning_profile;
+    bool direct_io;
+    std::ostream *output;
+    bool quiet;
+    TransferStats *stats;
+    bool limits_page_cache{false}; // of the file being received
+    bool receives_pipe{false};
+    bool transfer_started{false};
+    std::optional<ResumeCheckpoint> checkpoint;
+    std::optional<FlowControlWindow> flow_control_window;
+    std::optional<ChunkVerifier> chunk_verifier; // only when the sender trails the data with chunk hashes
+    std::optional<ClientSocket<Stream_t>> direct_link; // data comes over it instead of the main socket
+    bool tried_direct_link{false};
+    FlowControlWindow::Clock::time_point credit_granted_at;
+    static inline std::filesystem::path DROP_FILE_RECEIVER_PARTIAL_DIR{std::filesystem::temp_directory_path() / "drop-file" / "partial"};
+    static inline const std::string PARTIAL_FILE_SUFFIX{".drop-file-part"};
+    static constexpr std::size_t CHECKPOINT_INTERVAL{16 * 1024 * 1024};
+    static constexpr std::size_t WRITE_BEHIND_FRAMES{8};
+    static constexpr std::chrono::milliseconds DIRECT_CONNECT_TIMEOUT{2000};
 };
 
 
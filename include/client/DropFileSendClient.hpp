@@ -1,13 +1,27 @@
 #pragma once
 
 #include "ClientSocket.hpp"
+#include "DirectLink.hpp"
 #include "ClientArgs.hpp"
 #include "DropFileBaseException.hpp"
 #include "RAIIFSEntry.hpp"
+#include "ReconnectPolicy.hpp"
+#include "Striping.hpp"
+#include "MerkleTree.hpp"
+#include "SocketTuning.hpp"
+#include "RateLimiter.hpp"
+#include "FileReader.hpp"
+#include "TransferStats.hpp"
+
+#include <nlohmann/json.hpp>
 
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <vector>
 
 
 class DropFileSendException: public DropFileBaseException {
@@ -17,19 +31,100 @@ public:
 
 using SendFileAndReceiveCode = std::pair<RAIIFSEntry, std::string>;
 
+template<class T>
+class BoundedQueue;
+class AdaptiveFrameSizer;
+class ProgressMeter;
+
+template<class Stream_t = TlsStream>
 class DropFileSendClient {
 public:
-    DropFileSendClient(ClientSocket socket);
+    // When the connection is lost during the transfer, the client reconnects according to reconnect_policy
+    // and sends only the part of the file that the receiver does not have yet.
+    // With more than one stream the file is striped across that many parallel connections.
+    // Receiver checks the file against a Merkle tree built with hash_algorithm.
+    // With direct the receiver is offered to connect straight to this client, the server relays the data
+    // only if that fails (see DirectLink.hpp). It is single-stream only.
+    // Every stream that carries data is tuned according to tuning_profile (see SocketTuning.hpp).
+    // With rate_limit (bytes per second, 0 means no limit) all streams together are paced to that rate.
+    // With zero_copy the kernel sends (and encrypts) the file straight from the page cache where it can,
+    // streams on which it cannot fall back to sending from user space.
+    // With quiet no progress is drawn (see ProgressMeter.hpp).
+    // With stats every phase of the transfer is measured into them (see TransferStats.hpp).
+    DropFileSendClient(ClientSocket<Stream_t> socket, ReconnectPolicy reconnect_policy = {}, std::size_t streams = 1,
+                       HashAlgorithm hash_algorithm = DEFAULT_HASH_ALGORITHM, bool direct = false,
+                       TuningProfile tuning_profile = {}, std::size_t rate_limit = 0, bool zero_copy = false,
+                       bool quiet = false, TransferStats *stats = nullptr);
     ~DropFileSendClient();
 
     SendFileAndReceiveCode sendFSEntryMetadata(const std::string &path);
+    SendFileAndReceiveCode sendFSEntryMetadata(const std::vector<std::string> &paths);
     void sendFSEntry(RAIIFSEntry data_source);
+    // Data of unknown length is read from a pipe (e.g. standard input) until it ends and goes in a single stream.
+    // Receiver checks it as a whole, against the checksum that follows it. What has been read from the pipe
+    // is gone, so the transfer cannot be resumed.
+    std::string sendPipeMetadata(const std::string &name = PIPE_NAME);
+    void sendPipe(int fd);
+
+    static inline const std::string PIPE_NAME{"stdin"};
 protected:
+    // Mapped blocks are not copied, they stay valid as long as the FileReader does.
+    struct ReadBlock {
+        std::size_t offset{0}; // in the file
+        std::string copied{};
+        std::string_view mapped{};
+        std::vector<std::pair<std::size_t, MerkleTree::Digest>> leaves{}; // of the chunks that end in this block
+
+        std::string_view data() const {
+            return mapped.empty() ? std::string_view{copied} : mapped;
+        }
+    };
+
     std::pair<RAIIFSEntry, bool> compressIfNecessary(const std::string &path);
+    SendFileAndReceiveCode requestReceiveCode(RAIIFSEntry fs_entry, nlohmann::json message_json);
     std::string getReceiveCodeFromServer();
+    std::size_t awaitConfirmation();
+    void acceptDirectLink();
+    void sendFile(const std::filesystem::path &path, std::size_t offset);
+    void sendStripe(ClientSocket<Stream_t> &stream_socket, const std::filesystem::path &path, std::size_t index,
+                    ByteRange stripe, ProgressMeter &progress);
+    void sendRange(ClientSocket<Stream_t> &stream_socket, const std::filesystem::path &path, ByteRange range,
+                   const std::function<void(std::size_t)> &on_sent);
+    void readRange(FileReader &file, const std::filesystem::path &path, ByteRange range,
+                   BoundedQueue<ReadBlock> &read_blocks) const;
+    void readPipe(int fd, std::size_t block_size, Hasher &hasher, BoundedQueue<std::string> &read_blocks) const;
+    std::size_t awaitFrame(ClientSocket<Stream_t> &stream_socket, AdaptiveFrameSizer &frame_sizer, std::size_t left);
+    void recordFrame(AdaptiveFrameSizer &frame_sizer, SocketTuner &tuner, std::size_t frame_size,
+                     std::chrono::steady_clock::time_point send_start) const;
+    void sendSkippedChunkHashes(ClientSocket<Stream_t> &data_socket, const std::filesystem::path &path,
+                                ByteRange first_stripe, std::size_t offset);
+    std::size_t chunkSize() const;
+    std::size_t resumeSession();
+    void enableZeroCopy(ClientSocket<Stream_t> &data_socket) const;
+
+
+    void verifyReceiverChecksum(const std::string &receiver_checksum) const;
 
 
-    ClientSocket socket;
+    ClientSocket<Stream_t> socket;
+    ReconnectPolicy reconnect_policy;
+    std::size_t streams;
+    HashAlgorithm hash_algorithm;
+    TuningProfile tuning_profile;
+    std::optional<RateLimiter> rate_limiter;
+    bool zero_copy;
+    bool quiet;
+    TransferStats *stats;
+    std::optional<DirectListener<Stream_t>> direct_listener; // until the receiver has had its chance to connect
+    std::optional<ClientSocket<Stream_t>> direct_link; // data goes over it instead of the main socket
+    nlohmann::json session_message;
+    std::string receive_code;
+    std::string file_hash; // Merkle tree root, known once the file has been sent
+    std::vector<MerkleTree::Digest> leaves; // kept across reconnects, every stream fills in those of its own chunks
+    static constexpr std::size_t DIGESTS_PER_FRAME{
+            (MIN_FRAME_SIZE - MAX_VARINT_SIZE) / MerkleTree::DIGEST_SIZE}; // fits any receiver
+    static constexpr std::size_t READ_AHEAD_BLOCKS{4};
+    static constexpr std::chrono::milliseconds DIRECT_ACCEPT_TIMEOUT{3000}; // longer than receiver's connect timeout
     static inline std::filesystem::path DROP_FILE_SENDER_TMP_DIR{std::filesystem::temp_directory_path() / "drop-file" / "sender"};
 };
 
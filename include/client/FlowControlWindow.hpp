@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+
+// Receiver's side of credit-based flow control. Sender may have at most windowSize() unconsumed bytes in flight.
+// Consumed bytes are given back in batches of at least half a window. Whenever half a window is consumed
+// in less than two round trips, the link could carry more than the window allows, so the window is doubled
+// (up to MAX_WINDOW_SIZE) until it covers the bandwidth-delay product.
+class FlowControlWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FlowControlWindow(std::size_t max_frame_size);
+
+    std::size_t initialCredit(Clock::time_point now);
+    void onRttSample(std::chrono::nanoseconds rtt);
+    // Returns credit that should be granted right now, 0 if it is better to wait for more consumed bytes.
+    std::size_t onBytesConsumed(std::size_t bytes, Clock::time_point now);
+    std::size_t windowSize() const;
+
+    static constexpr std::size_t INITIAL_WINDOW_FRAMES{4};
+    static constexpr std::size_t MAX_WINDOW_SIZE{64 * 1024 * 1024}; // 64 MiB
+private:
+    std::size_t window_size;
+    std::size_t consumed_not_granted{0};
+    std::chrono::nanoseconds rtt{0};
+    Clock::time_point last_grant;
+};
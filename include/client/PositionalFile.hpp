@@ -0,0 +1,45 @@
+#pragma once
+
+#include "DropFileBaseException.hpp"
+#include "Striping.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <string_view>
+
+
+class PositionalFileException: public DropFileBaseException {
+public:
+    using DropFileBaseException::DropFileBaseException;
+};
+
+
+// File written at explicit offsets (pwrite), so that stripes received in parallel do not share any file position.
+// Bytes past keep_bytes are discarded when the file is opened, missing file is created.
+// With direct_io, writes aligned to DIRECT_IO_ALIGNMENT (offset, size and memory) bypass the page cache (O_DIRECT),
+// the others go through it as usual. Filesystems that do not support O_DIRECT (e.g. tmpfs) get buffered writes only.
+class PositionalFile {
+public:
+    PositionalFile(const std::filesystem::path &path, std::size_t keep_bytes, bool direct_io = false);
+    PositionalFile(PositionalFile &&other) noexcept;
+    PositionalFile(const PositionalFile &) = delete;
+    ~PositionalFile();
+
+    void write(std::size_t offset, std::string_view data);
+    // Reserves disk space for the whole file up front, so it is laid out in few extents whatever order the stripes
+    // come in. Size of the file stays as it is. Throws only when the disk is full, not all filesystems can do it.
+    void preallocate(std::size_t size);
+    // Starts writing the range back to disk, without waiting for it.
+    void startWriteBack(ByteRange range);
+    // Waits until the range is on disk and drops it from the page cache.
+    void evict(ByteRange range);
+    bool isDirect() const;
+    const std::filesystem::path &path() const;
+
+    static constexpr std::size_t DIRECT_IO_ALIGNMENT{4096};
+private:
+    std::filesystem::path file_path;
+    int fd;
+    int direct_fd{-1};
+    std::atomic<bool> direct_io_failed{false}; // stripes write from their own threads
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+
+// Progress of a transfer, drawn apart from it. The hot path only adds to a lock-free counter; a thread of its own
+// redraws the bar every REFRESH_INTERVAL, with the throughput of the last interval and the average one. Drawing
+// costs the same however often, and from however many streams, progress is made.
+// Quiet meter only counts, it starts no thread and draws nothing.
+class ProgressMeter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Total of 0 means it is not known (e.g. piped data), then only the amount done and the throughput are shown.
+    // What was done before (e.g. by an interrupted transfer) counts towards the total, not the throughput.
+    ProgressMeter(std::string label, std::size_t total, std::size_t done = 0, bool quiet = false);
+    ProgressMeter(const ProgressMeter &) = delete;
+    ProgressMeter &operator=(const ProgressMeter &) = delete;
+
+    void add(std::size_t amount) noexcept {
+        done.fetch_add(amount, std::memory_order_relaxed);
+    }
+    std::size_t value() const noexcept;
+    // Draws the last state with text in place of the label. Meter that is destroyed without it (e.g. when
+    // the transfer has failed) just stops drawing.
+    void finish(const std::string &text);
+
+    // Bytes per second, e.g. "12.5 MiB/s".
+    static std::string throughputToHumanReadable(double bytes_per_second);
+
+    static constexpr std::chrono::milliseconds REFRESH_INTERVAL{100};
+private:
+    template<class Bar>
+    void render(Bar &bar, std::stop_token stop_token);
+    std::string describe(std::size_t current, std::size_t previous, Clock::duration since_previous,
+                         Clock::time_point now) const;
+
+    std::string label;
+    std::size_t total;
+    std::size_t done_before;
+    Clock::time_point started_at;
+    std::atomic<std::size_t> done;
+    std::mutex mutex;
+    std::condition_variable_any refresh;
+    std::optional<std::string> final_text;
+    std::jthread renderer; // last, so that it stops before anything it draws from is gone
+};
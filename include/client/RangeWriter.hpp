@@ -0,0 +1,37 @@
+#pragma once
+
+#include "client/PositionalFile.hpp"
+
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <string_view>
+
+
+// Coalesces consecutive writes into blocks of WRITE_SIZE aligned to their offset in the file, so the disk gets few
+// large writes whatever the frame size is, and with direct I/O all but the blocks at the ends bypass page cache.
+// With limits_page_cache every written block is pushed to disk right away and dropped from page cache
+// CACHE_WINDOW blocks later, so that receiving a huge file does not evict what other processes keep there.
+// One writer per range, its file may be shared with the writers of other ranges.
+class RangeWriter {
+public:
+    RangeWriter(PositionalFile &file, bool limits_page_cache);
+
+    // Returns how many bytes have reached the file with this call, buffered ones included.
+    std::size_t write(std::size_t offset, std::string_view data);
+    // Writes whatever is buffered, returns how much it was. Nothing written is left in page cache.
+    std::size_t flush();
+
+    static constexpr std::size_t WRITE_SIZE{4 * 1024 * 1024};
+    static constexpr std::size_t CACHE_WINDOW{4};
+    static constexpr std::size_t PAGE_CACHE_LIMIT{256 * 1024 * 1024}; // bigger files are kept out of page cache
+private:
+    std::size_t writeBuffer();
+
+    PositionalFile &file;
+    bool limits_page_cache;
+    std::unique_ptr<char, decltype(&std::free)> buffer;
+    std::size_t buffer_offset{0}; // in the file
+    std::size_t buffered{0};
+    std::deque<ByteRange> written_back; // but still in page cache
+};
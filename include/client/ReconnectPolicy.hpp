@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+
+// How persistently a client tries to resume an interrupted transfer. Zero attempts disables reconnecting.
+struct ReconnectPolicy {
+    std::size_t max_attempts{0};
+    std::chrono::milliseconds initial_delay{DEFAULT_INITIAL_DELAY};
+    std::chrono::milliseconds max_delay{DEFAULT_MAX_DELAY};
+
+    static constexpr std::size_t DEFAULT_MAX_ATTEMPTS{10};
+    static constexpr std::chrono::milliseconds DEFAULT_INITIAL_DELAY{500};
+    static constexpr std::chrono::milliseconds DEFAULT_MAX_DELAY{30000};
+};
+
+
+// Exponential backoff with jitter, so that both peers of a dropped transfer do not hammer the server in lockstep.
+// Delay doubles after every attempt (up to max_delay), and up to JITTER_FRACTION of it is added at random.
+class ReconnectBackoff {
+public:
+    explicit ReconnectBackoff(ReconnectPolicy policy);
+
+    // Returns nullopt once all attempts are used up.
+    std::optional<std::chrono::milliseconds> nextDelay();
+    // Tells the user why the connection is being reestablished and sleeps for nextDelay().
+    // Returns false, without waiting, when there are no attempts left.
+    bool waitForNextAttempt(std::string_view reason);
+    // Called after a successful reconnect, so that the next connection loss gets all attempts again.
+    void reset();
+
+    static constexpr double JITTER_FRACTION{0.25};
+private:
+    ReconnectPolicy policy;
+    std::size_t attempts{0};
+    std::chrono::milliseconds delay;
+};
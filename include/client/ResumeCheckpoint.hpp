@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+
+// Progress of an interrupted receive. Saved next to the partial file, so that the transfer can be resumed
+// (also by a new drop-file process) from the last offset that is known to be on disk.
+struct ResumeCheckpoint {
+    std::string file_id; // see InitSessionMessage::fileId
+    std::filesystem::path partial_path;
+    std::size_t offset{0};
+
+    // Returns nullopt when there is no usable checkpoint, e.g. it is corrupted or the partial file is gone.
+    // Offset never exceeds what the partial file actually holds.
+    static std::optional<ResumeCheckpoint> load(const std::filesystem::path &checkpoint_path);
+    // Written to a temporary file and renamed, so that a crash never leaves a half-written checkpoint.
+    void save(const std::filesystem::path &checkpoint_path) const;
+};
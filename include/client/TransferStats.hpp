@@ -0,0 +1,76 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+enum class StatsFormat {
+    text,
+    json
+};
+
+std::string_view toString(StatsFormat format);
+std::optional<StatsFormat> parseStatsFormat(std::string_view name);
+
+// What every phase of a transfer has cost, to tell which of them makes it slow. Phase that happens more than once
+// (e.g. when the transfer is resumed) is summed up. CPU time is of the whole process, all its threads. Peak RSS is
+// the highest resident set size during the phase where the kernel lets it be reset (/proc/self/clear_refs),
+// otherwise the highest since the process started.
+// Sender hashes chunks while it sends them, so its hash phase only builds the Merkle root.
+class TransferStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string name;
+        Clock::duration wall_time{};
+        std::chrono::microseconds cpu_time{};
+        std::size_t bytes{0};
+        std::size_t peak_rss{0}; // bytes
+
+        double throughput() const; // bytes per second
+    };
+
+    // Measures from its construction until it is stopped or destroyed, whichever comes first.
+    // Without stats it does nothing, so that phases can be marked whether they are measured or not.
+    class Measurement {
+    public:
+        Measurement(TransferStats *stats, std::string name);
+        ~Measurement();
+        Measurement(const Measurement &) = delete;
+        Measurement &operator=(const Measurement &) = delete;
+
+        void addBytes(std::size_t amount) {
+            bytes += amount;
+        }
+        void stop();
+
+    private:
+        TransferStats *stats;
+        std::string name;
+        Clock::time_point started_at;
+        std::chrono::microseconds cpu_time_at_start{};
+        std::size_t bytes{0};
+    };
+
+    void record(const Phase &phase);
+    const std::vector<Phase> &phases() const;
+    nlohmann::json toJson() const;
+    std::string toText() const;
+
+    static inline const std::string CONNECT{"connect"}; // DNS, TCP and TLS handshake
+    static inline const std::string ARCHIVE{"archive"};
+    static inline const std::string WAIT_FOR_PEER{"wait_for_peer"};
+    static inline const std::string TRANSFER{"transfer"};
+    static inline const std::string HASH{"hash"};
+    static inline const std::string VERIFY{"verify"};
+    static inline const std::string UNPACK{"unpack"};
+private:
+    std::vector<Phase> recorded; // in the order the phases first happened
+};
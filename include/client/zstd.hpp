@@ -4,6 +4,7 @@
 
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <stdexcept>
 #include <array>
@@ -17,11 +18,14 @@ public:
 
 class zstd {
 public:
+    // update_callback is given the amount of input compressed since it was called last.
     static size_t compress(std::istream &input_stream, std::ostream &output_stream,
-                           std::function<void()> update_callback = [] {});
+                           std::function<void(std::size_t)> update_callback = [](std::size_t) {});
 
     static std::size_t decompress(std::ostream &decompressed_out_stream, std::istream &compressed_in_stream,
                                   std::size_t compressed_length);
+    // Decompresses straight from memory (e.g. a mapped archive), without copying the input first.
+    static std::size_t decompress(std::ostream &decompressed_out_stream, std::string_view compressed);
 };
 
 
@@ -3,8 +3,8 @@
 #include "SessionsManager.hpp"
 #include "ServerSideClientSession.hpp"
 
-#include <boost/asio/ssl/context_base.hpp>
-#include <boost/asio/ssl.hpp>
+#include "StreamPolicy.hpp"
+
 #include <boost/asio.hpp>
 #include <boost/lexical_cast.hpp>
 #include <spdlog/spdlog.h>
@@ -13,21 +13,15 @@
 
 using boost::asio::ip::tcp;
 
-template<class CreatedSession_t = ServerSideClientSession, class SessionsManager_t = SessionsManager>
+// key_cert_dir is not used when Stream_t is PlainStream.
+template<class Stream_t = TlsStream, class CreatedSession_t = ServerSideClientSession<Stream_t>,
+        class SessionsManager_t = SessionsManager<CreatedSession_t>>
 class DropFileServer {
 public:
     DropFileServer(unsigned short port, const std::filesystem::path &key_cert_dir, std::shared_ptr<SessionsManager_t> session_manager = std::make_shared<SessionsManager_t>())
             : acceptor_(io_context, tcp::endpoint(boost::asio::ip::address(), port)),
-              context_(boost::asio::ssl::context::sslv23),
+              context_(StreamPolicy<Stream_t>::createServerContext(key_cert_dir)),
               session_manager(std::move(session_manager)) {
-        context_.set_options(
-                boost::asio::ssl::context::default_workarounds
-                | boost::asio::ssl::context::no_sslv2
-                | boost::asio::ssl::context::verify_fail_if_no_peer_cert);
-        context_.use_certificate_chain_file(key_cert_dir / "cert.pem");
-        context_.use_private_key_file(key_cert_dir / "key.pem",
-                                      boost::asio::ssl::context::pem);
-
         acceptNewConnection();
     }
 
@@ -59,7 +53,7 @@ private:
 
     boost::asio::io_context io_context;
     tcp::acceptor acceptor_;
-    boost::asio::ssl::context context_;
+    typename StreamPolicy<Stream_t>::Context context_;
     std::shared_ptr<SessionsManager_t> session_manager;
 public:
     static inline unsigned short DEFAULT_PORT{8080};
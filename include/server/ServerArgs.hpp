@@ -1,5 +1,9 @@
 #pragma once
 
+#include "server/SessionDeadlines.hpp"
+#include "Framing.hpp"
+#include "SocketTuning.hpp"
+
 #include <string>
 #include <optional>
 #include <chrono>
@@ -9,6 +13,11 @@ struct ServerArgs {
     std::string certs_directory{};
     unsigned short port{};
     std::chrono::seconds client_timeout{};
+    SessionDeadlines deadlines{};
+    bool plaintext{false};
+    std::size_t max_frame_size{DEFAULT_FRAME_SIZE};
+    TuningProfile tuning_profile{};
+    std::size_t rate_limit{0}; // bytes per second of every transfer, 0 means no limit
 
     static inline unsigned short DEFAULT_PORT{8080};
     static inline std::chrono::seconds DEFAULT_CLIENT_TIMEOUT{120};
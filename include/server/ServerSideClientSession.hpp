@@ -2,10 +2,14 @@
 
 #include "SocketBase.hpp"
 #include "DropFileBaseException.hpp"
+#include "SocketTuning.hpp"
+#include "RateLimiter.hpp"
+#include "server/SessionDeadlines.hpp"
 
 #include <nlohmann/json.hpp>
 
 #include <memory>
+#include <optional>
 
 class ServerSideClientSessionException: public DropFileBaseException {
 public:
@@ -18,21 +22,74 @@ namespace asio = boost::asio;
 using boost::asio::ip::tcp;
 using boost::system::error_code;
 
+template<class Session_t>
 class SessionsManager;
 
-class ServerSideClientSession: public SocketBase {
+template<class Stream_t = TlsStream>
+class ServerSideClientSession: public SocketBase<Stream_t> {
 public:
-    ServerSideClientSession(tcp::socket socket, boost::asio::ssl::context &context, std::weak_ptr<SessionsManager> sessions_manager);
+    using SessionsManager_t = SessionsManager<ServerSideClientSession>;
+    using FrameHandler = typename SocketBase<Stream_t>::FrameHandler;
+
+    ServerSideClientSession(tcp::socket socket, typename StreamPolicy<Stream_t>::Context &context,
+                            std::weak_ptr<SessionsManager_t> sessions_manager);
     ~ServerSideClientSession();
     void start();
 private:
-    using PMF =  void (ServerSideClientSession::*)(std::string_view);
-    MessageHandler callback(PMF pmf);
+    using PMF =  void (ServerSideClientSession::*)(const Frame &);
+    FrameHandler callback(PMF pmf);
     void registerSession(nlohmann::json json);
-    void handleFirstRead(std::string_view content);
-    void receiveFile(std::shared_ptr<ServerSideClientSession> sender, nlohmann::json session_metadata);
+    void handleFirstRead(const Frame &frame);
+    void receiveFile(std::shared_ptr<ServerSideClientSession> sender, nlohmann::json session_metadata,
+                     bool auto_accept);
+    void joinStream(SessionsManager_t &manager, nlohmann::json json);
+    void receiveStripe(const std::shared_ptr<ServerSideClientSession> &sender);
+    void handleReceiverConfirmation(const Frame &response, const std::shared_ptr<ServerSideClientSession> &sender);
+    void startTransfer(const std::shared_ptr<ServerSideClientSession> &sender);
+    void relayNextChunk(std::shared_ptr<ServerSideClientSession> sender, std::size_t left_to_transfer);
+    void relayEnd(std::shared_ptr<ServerSideClientSession> sender, std::string_view checksum);
+    void relayChunkHashes(std::shared_ptr<ServerSideClientSession> sender, std::string_view payload,
+                          std::size_t left_to_transfer);
+    void relayPayload(std::shared_ptr<ServerSideClientSession> sender, std::string_view payload,
+                      std::size_t sender_frame_size, std::size_t left_after_payload);
+    void paceNextChunk(std::shared_ptr<ServerSideClientSession> sender, std::size_t relayed,
+                       std::size_t left_to_transfer);
+    void recordRelayed(const std::shared_ptr<ServerSideClientSession> &sender, std::size_t bytes);
+    void watchDirectTransfer(std::shared_ptr<ServerSideClientSession> sender);
+    void readReceiverControlFrame(std::shared_ptr<ServerSideClientSession> sender);
+    void handleReceiverControlFrame(const Frame &frame, const std::shared_ptr<ServerSideClientSession> &sender);
+    void grantSenderCredit(const std::shared_ptr<ServerSideClientSession> &sender, std::size_t bytes);
+    void finishTransfer(std::shared_ptr<ServerSideClientSession> sender, std::string_view checksum);
+    std::size_t acceptedResumeOffset(const nlohmann::json &receive_json, const nlohmann::json &session_metadata) const;
+    void interruptTransfer();
+    void onAsyncError(const error_code &ec) override;
+
+    void armDeadline(asio::steady_timer &timer, SessionPhase phase);
+    void onDeadlineExpired(SessionPhase phase);
+    std::shared_ptr<ServerSideClientSession> sharedFromThis();
 
-    std::weak_ptr<SessionsManager> sessions_manager;
+    std::weak_ptr<SessionsManager_t> sessions_manager;
+    SessionDeadlines deadlines;
+    std::size_t frame_size_limit{DEFAULT_FRAME_SIZE};
+    TuningProfile tuning_profile;
+    std::optional<SocketTuner> tuner; // from the start of the transfer relayed through this connection
     std::string endpoint;
+    asio::steady_timer phase_timer;
+    asio::steady_timer transfer_timer;
+    asio::steady_timer pacing_timer;
+    std::shared_ptr<RateLimiter> rate_limiter; // shared with other streams of the transfer
+    std::weak_ptr<ServerSideClientSession> paired_sender;
+    std::weak_ptr<ServerSideClientSession> paired_receiver;
+    std::string session_code;
+    nlohmann::json transfer_metadata;
+    std::size_t resume_offset{0};
+    std::size_t transfer_size{0};
+    bool is_stripe{false};
+    bool verifies_chunks{false};
+    bool sender_trails_hashes{false};
+    bool relays_pipe{false};
+    bool transfer_started{false};
+    bool transfer_finished{false};
     static constexpr std::size_t MAX_FIRST_MESSAGE_SIZE{1000};
+    static constexpr std::size_t MAX_CONFIRMATION_SIZE{100};
 };
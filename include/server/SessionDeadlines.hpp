@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+
+
+enum class SessionPhase : std::size_t {
+    handshake,
+    first_message,
+    parked_sender,
+    receiver_confirmation,
+    chunk_idle,
+    total_transfer
+};
+
+std::string_view toString(SessionPhase phase);
+
+// Zero disables given deadline.
+struct SessionDeadlines {
+    std::chrono::seconds handshake{DEFAULT_HANDSHAKE_TIMEOUT};
+    std::chrono::seconds first_message{DEFAULT_FIRST_MESSAGE_TIMEOUT};
+    std::chrono::seconds receiver_confirmation{DEFAULT_RECEIVER_CONFIRMATION_TIMEOUT};
+    std::chrono::seconds chunk_idle{DEFAULT_CHUNK_IDLE_TIMEOUT};
+    std::chrono::seconds total_transfer{DEFAULT_TOTAL_TRANSFER_TIMEOUT};
+
+    static constexpr std::chrono::seconds DEFAULT_HANDSHAKE_TIMEOUT{10};
+    static constexpr std::chrono::seconds DEFAULT_FIRST_MESSAGE_TIMEOUT{10};
+    static constexpr std::chrono::seconds DEFAULT_RECEIVER_CONFIRMATION_TIMEOUT{120};
+    static constexpr std::chrono::seconds DEFAULT_CHUNK_IDLE_TIMEOUT{30};
+    static constexpr std::chrono::seconds DEFAULT_TOTAL_TRANSFER_TIMEOUT{0};
+};
+
+
+class TimeoutCounters {
+public:
+    void increment(SessionPhase phase);
+    std::size_t get(SessionPhase phase) const;
+    std::size_t total() const;
+
+private:
+    static constexpr std::size_t PHASES_COUNT{static_cast<std::size_t>(SessionPhase::total_transfer) + 1};
+    std::array<std::atomic<std::size_t>, PHASES_COUNT> counters{};
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "DropFileBaseException.hpp"
+#include "Framing.hpp"
+#include "StreamPolicy.hpp"
+#include "SocketTuning.hpp"
+#include "RateLimiter.hpp"
+#include "server/SessionDeadlines.hpp"
 
 #include <nlohmann/json.hpp>
 
@@ -10,8 +15,10 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <optional>
 
 
+template<class Stream_t>
 class ServerSideClientSession;
 
 class SessionsManagerException: public DropFileBaseException {
@@ -20,30 +27,55 @@ public:
 };
 
 
+template<class Session_t = ServerSideClientSession<TlsStream>>
 class SessionsManager {
 public:
     SessionsManager();
-    SessionsManager(std::chrono::seconds client_timeout, std::chrono::seconds check_interval);
+    SessionsManager(std::chrono::seconds client_timeout, std::chrono::seconds check_interval,
+                    SessionDeadlines deadlines = {}, std::size_t max_frame_size = DEFAULT_FRAME_SIZE,
+                    TuningProfile tuning_profile = {}, std::size_t rate_limit = 0);
 
-    std::string registerSender(std::shared_ptr<ServerSideClientSession> sender,
+    // Sender that sends resume token takes over its interrupted session (see markResumable) under the same code.
+    std::string registerSender(std::shared_ptr<Session_t> sender,
                                nlohmann::json json);
-    std::pair<std::shared_ptr<ServerSideClientSession>, nlohmann::json> getSenderWithMetadata(const std::string& session_code);
+    std::pair<std::shared_ptr<Session_t>, nlohmann::json> getSenderWithMetadata(const std::string& session_code);
+    // Keeps code of the interrupted transfer reserved for client_timeout, until its sender comes back.
+    void markResumable(const std::string &session_code, nlohmann::json session_data);
+    // Extra streams of a striped transfer meet here: whichever side comes first waits (nullopt is returned),
+    // the other one gets its counterpart. Waiting streams expire after client_timeout, as parked senders do.
+    std::optional<std::shared_ptr<Session_t>> joinStream(std::shared_ptr<Session_t> session,
+                                                         const nlohmann::json &join_json);
 
     std::size_t currentSessions();
+    const SessionDeadlines &sessionDeadlines() const;
+    std::size_t maxFrameSize() const;
+    const TuningProfile &tuningProfile() const;
+    // Shared by all streams of the transfer with session_code, nullptr when there is no limit.
+    std::shared_ptr<RateLimiter> rateLimiter(const std::string &session_code);
+    TimeoutCounters &timeoutCounters();
 private:
     std::string generateSessionID();
+    std::string resumeSender(std::shared_ptr<Session_t> sender, nlohmann::json json, const std::string &token);
     void terminateTimeoutClients(std::chrono::seconds client_timeout);
 
     struct TimedClientSession {
-        std::shared_ptr<ServerSideClientSession> client_session;
+        std::shared_ptr<Session_t> client_session;
         nlohmann::json session_data;
         std::chrono::time_point<std::chrono::system_clock> time_point;
     };
 
+    SessionDeadlines deadlines;
+    std::size_t max_frame_size;
+    TuningProfile tuning_profile;
+    std::size_t rate_limit;
+    TimeoutCounters timeout_counters;
     std::vector<std::string> nouns;
     std::vector<std::string> adjectives;
     std::mutex m;
     std::unordered_map<std::string, TimedClientSession> senders_sessions;
+    std::unordered_map<std::string, TimedClientSession> resumable_sessions;
+    std::unordered_map<std::string, TimedClientSession> waiting_streams;
+    std::unordered_map<std::string, std::weak_ptr<RateLimiter>> rate_limiters; // live as long as their transfers
     std::jthread connections_controller;
 
 public:
@@ -0,0 +1,495 @@
+#include "FileReader.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+class FileReader::Engine {
+public:
+    virtual ~Engine() = default;
+    virtual std::string_view next() = 0;
+    virtual FileIOEngine kind() const = 0;
+    virtual int nativeHandle() const = 0;
+    virtual std::optional<std::string_view> mapped() const {
+        return std::nullopt;
+    }
+};
+
+namespace {
+    class FileDescriptor {
+    public:
+        explicit FileDescriptor(const std::filesystem::path &path)
+                : file_path(path), fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+            if (fd < 0) {
+                throw FileReaderException(
+                        fmt::format("Error opening file {}: {}", path.string(), std::strerror(errno)));
+            }
+        }
+        FileDescriptor(const FileDescriptor &) = delete;
+        ~FileDescriptor() {
+            ::close(fd);
+        }
+
+        std::size_t size() const {
+            return static_cast<std::size_t>(status().st_size);
+        }
+
+        // Pipes, devices and the like cannot be mapped, nor is their size known up front.
+        bool isRegular() const {
+            return S_ISREG(status().st_mode);
+        }
+
+        // Fills the whole buffer, unless the file ends before it.
+        void readExactly(std::size_t offset, char *buffer, std::size_t size) const {
+            while (size > 0) {
+                ssize_t bytes_read = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+                if (bytes_read < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (bytes_read <= 0) {
+                    throw readError(offset, bytes_read == 0 ? 0 : errno);
+                }
+                buffer += bytes_read;
+                size -= static_cast<std::size_t>(bytes_read);
+                offset += static_cast<std::size_t>(bytes_read);
+            }
+        }
+
+        FileReaderException readError(std::size_t offset, int error) const {
+            return FileReaderException(fmt::format("Error reading file {} at {}: {}", file_path.string(), offset,
+                                                   error == 0 ? "unexpected end of file" : std::strerror(error)));
+        }
+
+        int get() const {
+            return fd;
+        }
+    private:
+        struct stat status() const {
+            struct stat file_stat{};
+            if (::fstat(fd, &file_stat) != 0) {
+                throw FileReaderException(
+                        fmt::format("Could not stat {}: {}", file_path.string(), std::strerror(errno)));
+            }
+            return file_stat;
+        }
+
+        std::filesystem::path file_path;
+        int fd;
+    };
+
+
+    class PreadEngine: public FileReader::Engine {
+    public:
+        PreadEngine(std::shared_ptr<FileDescriptor> file, ByteRange range, std::size_t block_size)
+                : file(std::move(file)), range(range), position(range.begin),
+                  buffer(std::max(std::min(block_size, range.size()), std::size_t{1}), '\0') {}
+
+        std::string_view next() override {
+            std::size_t size = std::min(buffer.size(), range.end - position);
+            file->readExactly(position, buffer.data(), size);
+            position += size;
+            return {buffer.data(), size};
+        }
+
+        FileIOEngine kind() const override {
+            return FileIOEngine::pread;
+        }
+
+        int nativeHandle() const override {
+            return file->get();
+        }
+    private:
+        std::shared_ptr<FileDescriptor> file;
+        ByteRange range;
+        std::size_t position;
+        std::string buffer;
+    };
+
+
+    // Blocks are views of the mapped range, so nothing is copied on the way to the hasher, TLS or zstd.
+    // A file truncated while mapped ends the process with SIGBUS, which is why the range must lie within the file.
+    class MmapEngine: public FileReader::Engine {
+    public:
+        MmapEngine(std::shared_ptr<FileDescriptor> file, ByteRange range, std::size_t block_size)
+                : file(std::move(file)), block_size(std::max(block_size, std::size_t{1})) {
+            auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::size_t map_offset = range.begin / page_size * page_size;
+            map_size = range.end - map_offset;
+            mapping = ::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, this->file->get(),
+                             static_cast<off_t>(map_offset));
+            if (mapping == MAP_FAILED) {
+                throw FileReaderException(fmt::format("Could not map file: {}", std::strerror(errno)));
+            }
+            // Only hints, the kernel may ignore them.
+            ::madvise(mapping, map_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            ::madvise(mapping, map_size, MADV_HUGEPAGE);
+#endif
+            data = {static_cast<const char *>(mapping) + (range.begin - map_offset), range.size()};
+        }
+        MmapEngine(const MmapEngine &) = delete;
+        ~MmapEngine() override {
+            ::munmap(mapping, map_size);
+        }
+
+        std::string_view next() override {
+            std::string_view block = data.substr(position, block_size);
+            position += block.size();
+            return block;
+        }
+
+        FileIOEngine kind() const override {
+            return FileIOEngine::mmap;
+        }
+
+        int nativeHandle() const override {
+            return file->get();
+        }
+
+        std::optional<std::string_view> mapped() const override {
+            return data;
+        }
+    private:
+        std::shared_ptr<FileDescriptor> file;
+        std::size_t block_size;
+        void *mapping;
+        std::size_t map_size;
+        std::string_view data;
+        std::size_t position{0};
+    };
+
+
+    // Just as much of io_uring as reading needs, set up with raw system calls (see io_uring(7)).
+    class IoUring {
+    public:
+        struct Completion {
+            std::uint64_t user_data;
+            int result; // bytes read or -errno
+        };
+
+        explicit IoUring(unsigned entries) {
+            io_uring_params params{};
+            ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+            if (ring_fd < 0) {
+                throw FileReaderException(fmt::format("Could not set up io_uring: {}", std::strerror(errno)));
+            }
+            sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (is_single_mmap) {
+                sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+            }
+            sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+            cq_ring = is_single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe *>(map(sqes_size, IORING_OFF_SQES));
+            if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+                int error = errno;
+                release();
+                throw FileReaderException(fmt::format("Could not map io_uring: {}", std::strerror(error)));
+            }
+            auto *sq = static_cast<char *>(sq_ring);
+            auto *cq = static_cast<char *>(cq_ring);
+            sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        }
+        IoUring(const IoUring &) = delete;
+        ~IoUring() {
+            release();
+        }
+
+        // Fixed buffers save the kernel mapping them on every read, false when it refuses (e.g. RLIMIT_MEMLOCK).
+        bool registerBuffers(std::vector<iovec> &buffers) {
+            return ::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, buffers.data(),
+                             static_cast<unsigned>(buffers.size())) == 0;
+        }
+
+        // Queued until the next wait().
+        void prepareRead(int fd, char *buffer, unsigned size, std::size_t offset, std::optional<unsigned> fixed_buffer,
+                         std::uint64_t user_data) {
+            unsigned tail = *sq_tail;
+            unsigned index = tail & sq_mask;
+            io_uring_sqe &sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = fixed_buffer ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<std::uintptr_t>(buffer);
+            sqe.len = size;
+            sqe.off = offset;
+            sqe.buf_index = static_cast<__u16>(fixed_buffer.value_or(0));
+            sqe.user_data = user_data;
+            sq_array[index] = index;
+            std::atomic_ref{*sq_tail}.store(tail + 1, std::memory_order_release);
+            ++to_submit;
+        }
+
+        Completion wait() {
+            while (true) {
+                unsigned head = *cq_head;
+                if (head != std::atomic_ref{*cq_tail}.load(std::memory_order_acquire)) {
+                    const io_uring_cqe &cqe = cqes[head & cq_mask];
+                    Completion completion{cqe.user_data, cqe.res};
+                    std::atomic_ref{*cq_head}.store(head + 1, std::memory_order_release);
+                    return completion;
+                }
+                long submitted = ::syscall(__NR_io_uring_enter, ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS,
+                                           nullptr, 0);
+                if (submitted < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw FileReaderException(fmt::format("io_uring_enter failed: {}", std::strerror(errno)));
+                }
+                to_submit -= static_cast<unsigned>(submitted);
+            }
+        }
+    private:
+        void *map(std::size_t size, off_t offset) const {
+            return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        }
+
+        void release() {
+            if (sqes != MAP_FAILED) {
+                ::munmap(sqes, sqes_size);
+            }
+            if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+                ::munmap(cq_ring, cq_ring_size);
+            }
+            if (sq_ring != MAP_FAILED) {
+                ::munmap(sq_ring, sq_ring_size);
+            }
+            ::close(ring_fd);
+        }
+
+        int ring_fd{-1};
+        void *sq_ring{MAP_FAILED};
+        void *cq_ring{MAP_FAILED};
+        io_uring_sqe *sqes{static_cast<io_uring_sqe *>(MAP_FAILED)};
+        std::size_t sq_ring_size{0};
+        std::size_t cq_ring_size{0};
+        std::size_t sqes_size{0};
+        unsigned *sq_tail{nullptr};
+        unsigned sq_mask{0};
+        unsigned *sq_array{nullptr};
+        unsigned *cq_head{nullptr};
+        unsigned *cq_tail{nullptr};
+        unsigned cq_mask{0};
+        io_uring_cqe *cqes{nullptr};
+        unsigned to_submit{0};
+    };
+
+
+    // Block n is read into slot n % QUEUE_DEPTH, a slot gets its next block once the previous one has been handed out.
+    class IoUringEngine: public FileReader::Engine {
+    public:
+        IoUringEngine(std::shared_ptr<FileDescriptor> file, ByteRange range, std::size_t block_size)
+                : file(std::move(file)), range(range), block_size(std::max(std::min(block_size, range.size()),
+                                                                            std::size_t{1})),
+                  block_count(range.size() / this->block_size + (range.size() % this->block_size != 0 ? 1 : 0)),
+                  slot_count(std::min(FileReader::QUEUE_DEPTH, std::max(block_count, std::size_t{1}))),
+                  buffers(slot_count * this->block_size, '\0'), results(slot_count),
+                  ring(static_cast<unsigned>(slot_count)) {
+            std::vector<iovec> iovecs;
+            for (std::size_t slot = 0; slot < slot_count; ++slot) {
+                iovecs.push_back({slotBuffer(slot), this->block_size});
+            }
+            has_fixed_buffers = ring.registerBuffers(iovecs);
+            while (submitted < slot_count && submitted < block_count) {
+                submit(submitted++);
+            }
+        }
+
+        ~IoUringEngine() override {
+            try {
+                while (in_flight > 0) { // kernel must not write into the buffers once they are freed
+                    ring.wait();
+                    --in_flight;
+                }
+            } catch (const FileReaderException &) {
+                // closing the ring cancels what is left
+            }
+        }
+
+        std::string_view next() override {
+            if (handed_out > 0 && submitted < block_count) {
+                submit(submitted++); // into the slot of the block handed out last time
+            }
+            if (handed_out == block_count) {
+                return {};
+            }
+            std::size_t block = handed_out++;
+            std::size_t slot = block % slot_count;
+            while (!results[slot]) {
+                auto completion = ring.wait();
+                --in_flight;
+                results[completion.user_data] = completion.result;
+            }
+            int result = *std::exchange(results[slot], std::nullopt);
+            std::size_t offset = range.begin + block * block_size;
+            std::size_t size = std::min(block_size, range.end - offset);
+            if (result < 0 && result != -EINTR && result != -EAGAIN) {
+                throw file->readError(offset, -result);
+            }
+            auto bytes_read = static_cast<std::size_t>(std::max(result, 0));
+            if (bytes_read < size) { // short read, the rest is read right away
+                file->readExactly(offset + bytes_read, slotBuffer(slot) + bytes_read, size - bytes_read);
+            }
+            return {slotBuffer(slot), size};
+        }
+
+        FileIOEngine kind() const override {
+            return FileIOEngine::io_uring;
+        }
+
+        int nativeHandle() const override {
+            return file->get();
+        }
+    private:
+        void submit(std::size_t block) {
+            std::size_t slot = block % slot_count;
+            std::size_t offset = range.begin + block * block_size;
+            auto size = static_cast<unsigned>(std::min(block_size, range.end - offset));
+            ring.prepareRead(file->get(), slotBuffer(slot), size, offset,
+                             has_fixed_buffers ? std::optional{static_cast<unsigned>(slot)} : std::nullopt, slot);
+            ++in_flight;
+        }
+
+        char *slotBuffer(std::size_t slot) {
+            return buffers.data() + slot * block_size;
+        }
+
+        std::shared_ptr<FileDescriptor> file;
+        ByteRange range;
+        std::size_t block_size;
+        std::size_t block_count;
+        std::size_t slot_count;
+        std::string buffers;
+        std::vector<std::optional<int>> results; // of completed reads, by slot
+        IoUring ring;
+        bool has_fixed_buffers{false};
+        std::size_t submitted{0};
+        std::size_t handed_out{0};
+        std::size_t in_flight{0};
+    };
+
+    std::unique_ptr<FileReader::Engine> createEngine(const std::filesystem::path &path, std::optional<ByteRange> range,
+                                                     std::size_t block_size, FileIOEngine engine) {
+        auto file = std::make_shared<FileDescriptor>(path);
+        ByteRange file_range = range.value_or(ByteRange{0, file->size()});
+        if (engine == FileIOEngine::mmap) {
+            // Special files, and ranges the file does not have (reading them fails), are streamed.
+            if (file_range.size() > 0 && file->isRegular() && file_range.end <= file->size()) {
+                try {
+                    return std::make_unique<MmapEngine>(file, file_range, block_size);
+                } catch (const FileReaderException &e) {
+                    spdlog::debug("{}, streaming it instead.", e.what());
+                }
+            }
+            engine = FileIOEngine::io_uring;
+        }
+        if (engine == FileIOEngine::io_uring && file_range.size() > 0) {
+            try {
+                return std::make_unique<IoUringEngine>(file, file_range, block_size);
+            } catch (const FileReaderException &e) {
+                spdlog::debug("{}, reading with pread.", e.what());
+            }
+        }
+        return std::make_unique<PreadEngine>(std::move(file), file_range, block_size);
+    }
+}
+
+
+FileReader::FileReader(const std::filesystem::path &path, ByteRange range, std::size_t block_size,
+                       FileIOEngine engine) : engine_impl(createEngine(path, range, block_size, engine)) {}
+
+FileReader::FileReader(const std::filesystem::path &path, std::size_t block_size, FileIOEngine engine)
+        : engine_impl(createEngine(path, std::nullopt, block_size, engine)) {}
+
+FileReader::FileReader(FileReader &&other) noexcept = default;
+
+FileReader::~FileReader() = default;
+
+std::string_view FileReader::next() {
+    return engine_impl->next();
+}
+
+FileIOEngine FileReader::engine() const {
+    return engine_impl->kind();
+}
+
+std::optional<std::string_view> FileReader::mapped() const {
+    return engine_impl->mapped();
+}
+
+int FileReader::nativeHandle() const {
+    return engine_impl->nativeHandle();
+}
+
+
+FileReaderStream::FileReaderStream(const std::filesystem::path &path, FileIOEngine engine)
+        : std::istream(&buffer), buffer(FileReader{path, FileReader::DEFAULT_BLOCK_SIZE, engine}) {}
+
+std::optional<std::string_view> FileReaderStream::take(std::size_t size) {
+    return buffer.take(size);
+}
+
+// Mapped range is the get area from the start, there is nothing to read after it.
+FileReaderStream::Buffer::Buffer(FileReader reader) : reader(std::move(reader)) {
+    if (auto whole = this->reader.mapped()) {
+        char *begin = const_cast<char *>(whole->data());
+        setg(begin, begin, begin + whole->size());
+    }
+}
+
+std::optional<std::string_view> FileReaderStream::Buffer::take(std::size_t size) {
+    if (static_cast<std::size_t>(egptr() - gptr()) < size) {
+        return std::nullopt;
+    }
+    std::string_view taken{gptr(), size};
+    setg(eback(), gptr() + size, egptr()); // gbump takes an int, too small for large files
+    return taken;
+}
+
+// Get area is never written to, it is the reader's block as it is.
+FileReaderStream::Buffer::int_type FileReaderStream::Buffer::underflow() {
+    if (reader.mapped()) {
+        return traits_type::eof();
+    }
+    consumed += static_cast<std::size_t>(egptr() - eback());
+    std::string_view block = reader.next();
+    char *begin = const_cast<char *>(block.data());
+    setg(begin, begin, begin + block.size());
+    return block.empty() ? traits_type::eof() : traits_type::to_int_type(*begin);
+}
+
+// Only telling the current position is supported.
+FileReaderStream::Buffer::pos_type FileReaderStream::Buffer::seekoff(off_type offset, std::ios_base::seekdir direction,
+                                                                     std::ios_base::openmode mode) {
+    if (offset != 0 || direction != std::ios_base::cur || (mode & std::ios_base::in) == 0) {
+        return pos_type(off_type(-1));
+    }
+    return pos_type(static_cast<off_type>(consumed + static_cast<std::size_t>(gptr() - eback())));
+}
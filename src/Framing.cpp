@@ -0,0 +1,157 @@
+#include "Framing.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <utility>
+
+FrameType validateFrameType(std::uint8_t raw_type);
+std::optional<std::pair<std::uint64_t, std::size_t>> decodeVarintPrefix(std::span<const char> payload);
+
+
+std::string_view toString(FrameType type) {
+    switch (type) {
+        case FrameType::data:
+            return "DATA";
+        case FrameType::ack:
+            return "ACK";
+        case FrameType::abort:
+            return "ABORT";
+        case FrameType::metadata:
+            return "METADATA";
+        case FrameType::error:
+            return "ERROR";
+        case FrameType::credit:
+            return "CREDIT";
+        case FrameType::chunk_hashes:
+            return "CHUNK_HASHES";
+        case FrameType::direct:
+            return "DIRECT";
+        case FrameType::end:
+            return "END";
+    }
+    return "UNKNOWN";
+}
+
+std::size_t encodeVarint(std::uint64_t value, std::span<std::uint8_t, MAX_VARINT_SIZE> out) {
+    std::size_t size{0};
+    while (value >= 0x80) {
+        out[size++] = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<std::uint8_t>(value);
+    return size;
+}
+
+std::size_t encodeFrameHeader(FrameType type, std::uint64_t payload_size, FrameHeaderBuffer &out) {
+    out[0] = static_cast<std::uint8_t>(type);
+    return 1 + encodeVarint(payload_size, std::span{out}.subspan<1, MAX_VARINT_SIZE>());
+}
+
+FrameType validateFrameType(std::uint8_t raw_type) {
+    if (raw_type < static_cast<std::uint8_t>(FrameType::data) || raw_type > static_cast<std::uint8_t>(FrameType::end)) {
+        throw FramingException(fmt::format("Unknown frame type: {:#04x}.", raw_type));
+    }
+    return static_cast<FrameType>(raw_type);
+}
+
+std::optional<FrameHeader> decodeFrameHeader(std::span<const char> bytes) {
+    if (bytes.empty()) {
+        return std::nullopt;
+    }
+    FrameType type = validateFrameType(static_cast<std::uint8_t>(bytes[0]));
+    std::uint64_t payload_size{0};
+    for (std::size_t i = 0; i < MAX_VARINT_SIZE; ++i) {
+        if (1 + i >= bytes.size()) {
+            return std::nullopt;
+        }
+        auto byte = static_cast<std::uint8_t>(bytes[1 + i]);
+        if (i == MAX_VARINT_SIZE - 1 && byte > 1) {
+            throw FramingException("Frame length does not fit in 64 bits.");
+        }
+        payload_size |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return FrameHeader{type, payload_size, 2 + i};
+        }
+    }
+    throw FramingException("Frame length does not fit in 64 bits.");
+}
+
+std::string encodeCredit(std::size_t bytes) {
+    std::array<std::uint8_t, MAX_VARINT_SIZE> buffer{};
+    std::size_t size = encodeVarint(bytes, buffer);
+    return {std::bit_cast<const char *>(buffer.data()), size};
+}
+
+// Returns the value and the number of bytes it took, std::nullopt when payload does not start with a whole varint.
+std::optional<std::pair<std::uint64_t, std::size_t>> decodeVarintPrefix(std::span<const char> payload) {
+    std::uint64_t value{0};
+    for (std::size_t i = 0; i < std::min(payload.size(), MAX_VARINT_SIZE); ++i) {
+        auto byte = static_cast<std::uint8_t>(payload[i]);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return std::pair{value, i + 1};
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t decodeCredit(std::span<const char> payload) {
+    auto credit = decodeVarintPrefix(payload);
+    if (!credit || credit->second != payload.size()) {
+        throw FramingException("Malformed credit frame.");
+    }
+    return credit->first;
+}
+
+std::string encodeChunkHashes(std::size_t first_chunk, std::string_view digests) {
+    std::array<std::uint8_t, MAX_VARINT_SIZE> buffer{};
+    std::size_t size = encodeVarint(first_chunk, buffer);
+    std::string payload{std::bit_cast<const char *>(buffer.data()), size};
+    payload += digests;
+    return payload;
+}
+
+ChunkHashes decodeChunkHashes(std::string_view payload) {
+    auto first_chunk = decodeVarintPrefix(payload);
+    if (!first_chunk) {
+        throw FramingException("Malformed chunk hashes frame.");
+    }
+    return {first_chunk->first, payload.substr(first_chunk->second)};
+}
+
+HelloBuffer encodeHello(const Hello &hello) {
+    HelloBuffer buffer{};
+    std::ranges::copy(Hello::MAGIC, buffer.begin());
+    buffer[Hello::MAGIC.size()] = static_cast<char>(hello.version);
+    buffer[Hello::MAGIC.size() + 1] = static_cast<char>(std::bit_width(normalizeFrameSize(hello.max_frame_size)) - 1);
+    return buffer;
+}
+
+bool isHello(std::span<const char> bytes) {
+    return bytes.size() >= Hello::SIZE && std::ranges::equal(bytes.first(Hello::MAGIC.size()), Hello::MAGIC);
+}
+
+Hello decodeHello(std::span<const char> bytes) {
+    if (!isHello(bytes)) {
+        throw FramingException("Peer did not respond with framed protocol hello.");
+    }
+    Hello hello{};
+    hello.version = static_cast<std::uint8_t>(bytes[Hello::MAGIC.size()]);
+    if (hello.version == 0) {
+        throw FramingException("Peer announced invalid protocol version 0.");
+    }
+    auto frame_size_log2 = static_cast<std::uint8_t>(bytes[Hello::MAGIC.size() + 1]);
+    if (frame_size_log2 >= std::numeric_limits<std::size_t>::digits ||
+        normalizeFrameSize(std::size_t{1} << frame_size_log2) != std::size_t{1} << frame_size_log2) {
+        throw FramingException(fmt::format("Peer announced unsupported frame size 2^{}.", frame_size_log2));
+    }
+    hello.max_frame_size = std::size_t{1} << frame_size_log2;
+    return hello;
+}
+
+std::size_t normalizeFrameSize(std::size_t frame_size) {
+    return std::bit_floor(std::clamp(frame_size, MIN_FRAME_SIZE, MAX_FRAME_SIZE));
+}
@@ -0,0 +1,64 @@
+#include "Hasher.hpp"
+
+#include <bit>
+
+
+std::string_view toString(HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::sha256:
+            return "sha256";
+        case HashAlgorithm::blake2b:
+            return "blake2b";
+    }
+    return "unknown";
+}
+
+std::optional<HashAlgorithm> parseHashAlgorithm(std::string_view name) {
+    for (auto algorithm: {HashAlgorithm::sha256, HashAlgorithm::blake2b}) {
+        if (name == toString(algorithm)) {
+            return algorithm;
+        }
+    }
+    return std::nullopt;
+}
+
+
+namespace {
+    const EVP_MD *evpDigest(HashAlgorithm algorithm) {
+        switch (algorithm) {
+            case HashAlgorithm::blake2b:
+                return EVP_blake2b512();
+            case HashAlgorithm::sha256:
+            default:
+                return EVP_sha256();
+        }
+    }
+}
+
+Hasher::Hasher(HashAlgorithm algorithm) : md(evpDigest(algorithm)), context(EVP_MD_CTX_new(), EVP_MD_CTX_free) {
+    if (!context) {
+        throw HasherException("Error creating context for hashing.");
+    }
+    reset();
+}
+
+void Hasher::update(std::string_view data) {
+    if (EVP_DigestUpdate(context.get(), data.data(), data.size()) != 1) {
+        throw HasherException("Error updating digest.");
+    }
+}
+
+std::string Hasher::finish() {
+    std::string digest(static_cast<std::size_t>(EVP_MD_get_size(md)), '\0');
+    if (EVP_DigestFinal_ex(context.get(), std::bit_cast<unsigned char *>(digest.data()), nullptr) != 1) {
+        throw HasherException("Error finalizing digest.");
+    }
+    reset();
+    return digest;
+}
+
+void Hasher::reset() {
+    if (EVP_DigestInit_ex(context.get(), md, nullptr) != 1) {
+        throw HasherException("Error initializing digest context.");
+    }
+}
@@ -1,10 +1,16 @@
 #include "InitSessionMessage.hpp"
+#include "MerkleTree.hpp"
 #include "Utils.hpp"
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <limits>
 
-nlohmann::json InitSessionMessage::createSendMessage(const std::filesystem::path &file_path, bool is_compressed) {
+
+nlohmann::json InitSessionMessage::createSendMessage(const std::filesystem::path &file_path, bool is_compressed,
+                                                     std::size_t streams, std::size_t chunk_size,
+                                                     HashAlgorithm hash_algorithm) {
     if (!std::filesystem::exists(file_path)) {
         throw InitSessionMessageException(fmt::format("Given path {} does not exist!", file_path.string()));
     }
@@ -13,16 +19,45 @@ nlohmann::json InitSessionMessage::createSendMessage(const std::filesystem::path
     json[ACTION_KEY] = "send";
     json[FILENAME_KEY] = file_path.filename().string();
     json[FILE_SIZE_KEY] = std::filesystem::file_size(file_path);
-    std::cout << "Calculating control hash..." << std::endl;
-    json[FILE_HASH_KEY] = calculateFileHash(file_path);
+    json[FILE_ID_KEY] = fingerprint(file_path);
+    json[CHUNK_SIZE_KEY] = chunk_size;
+    json[HASH_ALGORITHM_KEY] = toString(hash_algorithm);
     json[IS_COMPRESSED_KEY] = is_compressed;
+    json[STREAMS_KEY] = streams;
     return json;
 }
 
-nlohmann::json InitSessionMessage::createReceiveMessage(const std::string &code) {
+// Only tells files apart for resuming, their content is never trusted because of it.
+std::string InitSessionMessage::fingerprint(const std::filesystem::path &file_path) {
+    auto modified = std::filesystem::last_write_time(file_path).time_since_epoch();
+    std::string identity = fmt::format("{}\n{}\n{}", std::filesystem::absolute(file_path).string(),
+                                       std::filesystem::file_size(file_path), modified.count());
+    return binaryToHumanReadable(MerkleTree::hashLeaf(identity));
+}
+
+nlohmann::json InitSessionMessage::createPipeSendMessage(const std::string &name, HashAlgorithm hash_algorithm) {
+    nlohmann::json json{};
+    json[ACTION_KEY] = "send";
+    json[FILENAME_KEY] = name;
+    json[FILE_SIZE_KEY] = 0;
+    json[FILE_ID_KEY] = ""; // never resumed, so never compared
+    json[HASH_ALGORITHM_KEY] = toString(hash_algorithm);
+    json[IS_COMPRESSED_KEY] = false;
+    json[PIPE_KEY] = true;
+    return json;
+}
+
+bool InitSessionMessage::isPipe(const nlohmann::json &send_json) {
+    return send_json.is_object() && send_json.value(PIPE_KEY, false);
+}
+
+nlohmann::json InitSessionMessage::createReceiveMessage(const std::string &code, bool auto_accept) {
     nlohmann::json json{};
     json[ACTION_KEY] = "receive";
     json[CODE_WORDS_KEY] = code;
+    json[AUTO_ACCEPT_KEY] = auto_accept;
+    json[VERIFY_CHUNKS_KEY] = true;
+    json[ACCEPTS_PIPE_KEY] = true;
     return json;
 }
 
@@ -38,13 +73,284 @@ nlohmann::json InitSessionMessage::create(const std::string_view &str) {
 
 void InitSessionMessage::validate(const nlohmann::json &json) {
     validateActionKey(json);
-    if (json[ACTION_KEY] == "send") {
+    if (json.contains(STREAM_INDEX_KEY)) {
+        validateStreamJoin(json);
+    } else if (json[ACTION_KEY] == "send") {
         validateKeysExist(json);
         validateKeysTypes(json);
+        if (json.contains(RESUME_TOKEN_KEY)) {
+            validateStringKey(json, RESUME_TOKEN_KEY);
+        }
+        if (json.contains(STREAMS_KEY)) {
+            validateUnsignedKey(json, STREAMS_KEY);
+            if (json[STREAMS_KEY] == 0 || json[STREAMS_KEY] > MAX_STREAMS) {
+                throw InitSessionMessageException(
+                        fmt::format("InitSessionMessage json key {} should be between 1 and {}.", STREAMS_KEY,
+                                    MAX_STREAMS));
+            }
+        }
+        if (json.contains(CHUNK_SIZE_KEY)) {
+            validateChunkSizeKey(json);
+        }
+        if (json.contains(HASH_ALGORITHM_KEY)) {
+            validateStringKey(json, HASH_ALGORITHM_KEY);
+        }
+        if (json.contains(ENTRIES_KEY)) {
+            validateEntriesKey(json);
+        }
+        if (json.contains(DIRECT_KEY)) {
+            validateDirectKey(json);
+        }
+        if (json.contains(PIPE_KEY)) {
+            validatePipeKey(json);
+        }
     } else {
         validateSingleKeyExists(json, CODE_WORDS_KEY);
         validateStringKey(json, CODE_WORDS_KEY);
+        if (json.contains(AUTO_ACCEPT_KEY) && !json[AUTO_ACCEPT_KEY].is_boolean()) {
+            throw InitSessionMessageException(
+                    fmt::format("InitSessionMessage json key {} should be a boolean.", AUTO_ACCEPT_KEY));
+        }
+        for (auto key: {VERIFY_CHUNKS_KEY, ACCEPTS_PIPE_KEY}) {
+            if (json.contains(key) && !json[key].is_boolean()) {
+                throw InitSessionMessageException(
+                        fmt::format("InitSessionMessage json key {} should be a boolean.", key));
+            }
+        }
+        validateResumeKeys(json);
+    }
+}
+
+void InitSessionMessage::validateResumeKeys(const nlohmann::json &json) {
+    if (!json.contains(RESUME_OFFSET_KEY)) {
+        return;
+    }
+    validateUnsignedKey(json, RESUME_OFFSET_KEY);
+    validateFileIdKey(json);
+}
+
+void InitSessionMessage::validateFileIdKey(const nlohmann::json &json) {
+    const char *key = json.contains(FILE_ID_KEY) ? FILE_ID_KEY : FILE_HASH_KEY;
+    validateSingleKeyExists(json, key);
+    validateStringKey(json, key);
+}
+
+// Entries are unpacked right into receiver's current directory, so they have to be plain names.
+void InitSessionMessage::validateEntriesKey(const nlohmann::json &json) {
+    if (!json[ENTRIES_KEY].is_array() || json[ENTRIES_KEY].empty()) {
+        throw InitSessionMessageException(
+                fmt::format("InitSessionMessage json key {} should be a non-empty array.", ENTRIES_KEY));
+    }
+    for (const auto &entry: json[ENTRIES_KEY]) {
+        if (!entry.is_string() || std::filesystem::path{entry.get<std::string>()}.filename() != entry.get<std::string>() ||
+            entry == "" || entry == "." || entry == "..") {
+            throw InitSessionMessageException(
+                    fmt::format("InitSessionMessage json key {} should hold only file names, got {}.", ENTRIES_KEY,
+                                entry.dump()));
+        }
+    }
+}
+
+void InitSessionMessage::validateDirectKey(const nlohmann::json &json) {
+    const auto &offer = json[DIRECT_KEY];
+    if (!offer.is_object() || streamCount(json) != 1) {
+        throw InitSessionMessageException(
+                fmt::format("InitSessionMessage json key {} should be an object of a single-stream transfer.",
+                            DIRECT_KEY));
+    }
+    validateSingleKeyExists(offer, DIRECT_ADDRESSES_KEY);
+    const auto &addresses = offer[DIRECT_ADDRESSES_KEY];
+    if (!addresses.is_array() || addresses.empty() || addresses.size() > MAX_DIRECT_ADDRESSES ||
+        !std::ranges::all_of(addresses, [](const auto &address) { return address.is_string(); })) {
+        throw InitSessionMessageException(
+                fmt::format("InitSessionMessage json key {} should hold from 1 to {} addresses.", DIRECT_ADDRESSES_KEY,
+                            MAX_DIRECT_ADDRESSES));
+    }
+    validateSingleKeyExists(offer, DIRECT_PORT_KEY);
+    validateUnsignedKey(offer, DIRECT_PORT_KEY);
+    if (offer[DIRECT_PORT_KEY] == 0 || offer[DIRECT_PORT_KEY] > std::numeric_limits<unsigned short>::max()) {
+        throw InitSessionMessageException(
+                fmt::format("InitSessionMessage json key {} should be a port number.", DIRECT_PORT_KEY));
+    }
+    for (auto key: {DIRECT_SESSION_KEY, DIRECT_FINGERPRINT_KEY}) {
+        validateSingleKeyExists(offer, key);
+        validateStringKey(offer, key);
+    }
+}
+
+// Piped data has no size to stripe or chunk it by, nor to resume it at.
+void InitSessionMessage::validatePipeKey(const nlohmann::json &json) {
+    if (!json[PIPE_KEY].is_boolean()) {
+        throw InitSessionMessageException(fmt::format("InitSessionMessage json key {} should be a boolean.", PIPE_KEY));
+    }
+    if (json[PIPE_KEY] && (streamCount(json) != 1 || json.contains(CHUNK_SIZE_KEY) || json.contains(RESUME_TOKEN_KEY) ||
+                           json[FILE_SIZE_KEY] != 0)) {
+        throw InitSessionMessageException(
+                fmt::format("InitSessionMessage with {} key should be a single-stream transfer of size 0, "
+                            "without chunk size nor resume token.", PIPE_KEY));
+    }
+}
+
+void InitSessionMessage::validateStreamJoin(const nlohmann::json &json) {
+    validateSingleKeyExists(json, CODE_WORDS_KEY);
+    validateStringKey(json, CODE_WORDS_KEY);
+    for (auto key: {STREAM_INDEX_KEY, STRIPE_BEGIN_KEY, STRIPE_END_KEY}) {
+        validateSingleKeyExists(json, key);
+        validateUnsignedKey(json, key);
+    }
+    if (json[STREAM_INDEX_KEY] == 0 || json[STREAM_INDEX_KEY] >= MAX_STREAMS) {
+        throw InitSessionMessageException(fmt::format("InitSessionMessage json key {} should be between 1 and {}.",
+                                                      STREAM_INDEX_KEY, MAX_STREAMS - 1));
+    }
+    if (json[STRIPE_BEGIN_KEY] > json[STRIPE_END_KEY]) {
+        throw InitSessionMessageException("InitSessionMessage stripe ends before it begins.");
+    }
+    if (json.contains(CHUNK_SIZE_KEY)) {
+        validateChunkSizeKey(json);
+    }
+}
+
+void InitSessionMessage::validateChunkSizeKey(const nlohmann::json &json) {
+    validateUnsignedKey(json, CHUNK_SIZE_KEY);
+    try {
+        MerkleTree::validateChunkSize(json[CHUNK_SIZE_KEY].get<std::size_t>());
+    } catch (const MerkleTreeException &e) {
+        throw InitSessionMessageException(e.what());
+    }
+}
+
+void InitSessionMessage::validateUnsignedKey(const nlohmann::json &json, const char *key) {
+    if (!json[key].is_number_unsigned()) {
+        throw InitSessionMessageException(fmt::format("InitSessionMessage json key {} should be a number.", key));
+    }
+}
+
+bool InitSessionMessage::isAutoAccepted(const nlohmann::json &json) {
+    return json.value(AUTO_ACCEPT_KEY, false);
+}
+
+bool InitSessionMessage::acceptsPipe(const nlohmann::json &receive_json) {
+    return receive_json.is_object() && receive_json.value(ACCEPTS_PIPE_KEY, false);
+}
+
+void InitSessionMessage::setResumeToken(nlohmann::json &send_json, const std::string &code) {
+    send_json[RESUME_TOKEN_KEY] = code;
+}
+
+void InitSessionMessage::setBundleEntries(nlohmann::json &send_json, const std::vector<std::string> &entries) {
+    send_json[ENTRIES_KEY] = entries;
+}
+
+std::vector<std::string> InitSessionMessage::bundleEntries(const nlohmann::json &send_json) {
+    if (!send_json.is_object() || !send_json.contains(ENTRIES_KEY)) {
+        return {};
+    }
+    return send_json[ENTRIES_KEY].get<std::vector<std::string>>();
+}
+
+void InitSessionMessage::setDirectOffer(nlohmann::json &send_json, const DirectOffer &offer) {
+    send_json[DIRECT_KEY] = {{DIRECT_ADDRESSES_KEY, offer.addresses},
+                             {DIRECT_PORT_KEY, offer.port},
+                             {DIRECT_SESSION_KEY, offer.session_key},
+                             {DIRECT_FINGERPRINT_KEY, offer.certificate_fingerprint}};
+}
+
+std::optional<DirectOffer> InitSessionMessage::directOffer(const nlohmann::json &send_json) {
+    if (!send_json.is_object() || !send_json.contains(DIRECT_KEY)) {
+        return std::nullopt;
+    }
+    const auto &offer = send_json[DIRECT_KEY];
+    return DirectOffer{.addresses = offer[DIRECT_ADDRESSES_KEY].get<std::vector<std::string>>(),
+                       .port = offer[DIRECT_PORT_KEY].get<unsigned short>(),
+                       .session_key = offer[DIRECT_SESSION_KEY].get<std::string>(),
+                       .certificate_fingerprint = offer[DIRECT_FINGERPRINT_KEY].get<std::string>()};
+}
+
+void InitSessionMessage::setResumePoint(nlohmann::json &receive_json, std::size_t offset,
+                                        const std::string &file_id) {
+    receive_json[RESUME_OFFSET_KEY] = offset;
+    receive_json[FILE_ID_KEY] = file_id;
+}
+
+std::string InitSessionMessage::fileId(const nlohmann::json &json) {
+    if (!json.is_object()) {
+        return {};
+    }
+    return json.value(FILE_ID_KEY, json.value(FILE_HASH_KEY, std::string{}));
+}
+
+std::optional<std::string> InitSessionMessage::resumeToken(const nlohmann::json &json) {
+    if (!json.is_object() || !json.contains(RESUME_TOKEN_KEY)) {
+        return std::nullopt;
+    }
+    return json[RESUME_TOKEN_KEY].get<std::string>();
+}
+
+std::size_t InitSessionMessage::resumeOffset(const nlohmann::json &json) {
+    if (!json.is_object() || !json.contains(RESUME_OFFSET_KEY)) {
+        return 0;
     }
+    return json[RESUME_OFFSET_KEY].get<std::size_t>();
+}
+
+nlohmann::json InitSessionMessage::createStreamJoinMessage(const std::string &action, const std::string &code,
+                                                           std::size_t stream_index, ByteRange stripe,
+                                                           std::optional<std::size_t> chunk_size) {
+    nlohmann::json json{};
+    json[ACTION_KEY] = action;
+    json[CODE_WORDS_KEY] = code;
+    json[STREAM_INDEX_KEY] = stream_index;
+    json[STRIPE_BEGIN_KEY] = stripe.begin;
+    json[STRIPE_END_KEY] = stripe.end;
+    if (chunk_size) {
+        json[CHUNK_SIZE_KEY] = *chunk_size;
+    }
+    return json;
+}
+
+bool InitSessionMessage::isStreamJoin(const nlohmann::json &json) {
+    return json.is_object() && json.contains(STREAM_INDEX_KEY);
+}
+
+std::size_t InitSessionMessage::streamCount(const nlohmann::json &json) {
+    return json.is_object() ? json.value(STREAMS_KEY, std::size_t{1}) : 1;
+}
+
+std::optional<std::size_t> InitSessionMessage::chunkSize(const nlohmann::json &json) {
+    if (!json.is_object() || !json.contains(CHUNK_SIZE_KEY)) {
+        return std::nullopt;
+    }
+    return json[CHUNK_SIZE_KEY].get<std::size_t>();
+}
+
+bool InitSessionMessage::verifiesChunks(const nlohmann::json &json) {
+    return json.is_object() && json.value(VERIFY_CHUNKS_KEY, false);
+}
+
+std::optional<HashAlgorithm> InitSessionMessage::hashAlgorithm(const nlohmann::json &send_json) {
+    if (!send_json.is_object() || !send_json.contains(HASH_ALGORITHM_KEY)) {
+        return HashAlgorithm::sha256;
+    }
+    return parseHashAlgorithm(send_json[HASH_ALGORITHM_KEY].get<std::string>());
+}
+
+ByteRange InitSessionMessage::stripeOf(const nlohmann::json &send_json, std::size_t stream_index) {
+    return stripeRange(send_json[FILE_SIZE_KEY].get<std::size_t>(), streamCount(send_json), stream_index,
+                       chunkSize(send_json).value_or(1));
+}
+
+std::vector<std::size_t> InitSessionMessage::extraStreams(const nlohmann::json &send_json) {
+    std::vector<std::size_t> indexes;
+    for (std::size_t index = 1; index < streamCount(send_json); ++index) {
+        if (stripeOf(send_json, index).size() > 0) {
+            indexes.push_back(index);
+        }
+    }
+    return indexes;
+}
+
+ByteRange InitSessionMessage::stripe(const nlohmann::json &json) {
+    return {json[STRIPE_BEGIN_KEY].get<std::size_t>(), json[STRIPE_END_KEY].get<std::size_t>()};
 }
 
 void InitSessionMessage::validateActionKey(const nlohmann::json &json) {
@@ -64,7 +370,7 @@ void InitSessionMessage::validateStringKey(const nlohmann::json &json, const cha
 }
 
 void InitSessionMessage::validateKeysExist(const nlohmann::json &json) {
-    for (auto key: {FILENAME_KEY, FILE_SIZE_KEY, FILE_HASH_KEY, IS_COMPRESSED_KEY}) {
+    for (auto key: {FILENAME_KEY, FILE_SIZE_KEY, IS_COMPRESSED_KEY}) {
         validateSingleKeyExists(json, key);
     }
 }
@@ -77,7 +383,7 @@ void InitSessionMessage::validateSingleKeyExists(const nlohmann::json &json, con
 
 void InitSessionMessage::validateKeysTypes(const nlohmann::json &json) {
     validateStringKey(json, FILENAME_KEY);
-    validateStringKey(json, FILE_HASH_KEY);
+    validateFileIdKey(json);
 
     if (!json[FILE_SIZE_KEY].is_number_unsigned()) {
         throw InitSessionMessageException(fmt::format("InitSessionMessage json key {} should be a number.", FILE_SIZE_KEY));
@@ -0,0 +1,177 @@
+#include "KernelTls.hpp"
+
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <spdlog/spdlog.h>
+
+#include <linux/tls.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+
+namespace {
+    constexpr std::string_view CLIENT_SECRET_LABEL{"CLIENT_TRAFFIC_SECRET_0"};
+    constexpr std::string_view SERVER_SECRET_LABEL{"SERVER_TRAFFIC_SECRET_0"};
+    constexpr std::size_t IV_SIZE{12};
+
+    // TLS 1.3 cipher suites the kernel can encrypt with.
+    struct CipherSuite {
+        std::uint16_t protocol_id;
+        const char *digest;
+        std::size_t key_size;
+        unsigned short kernel_cipher;
+    };
+
+    constexpr CipherSuite CIPHER_SUITES[]{
+            {0x1301, "SHA256", 16, TLS_CIPHER_AES_GCM_128},
+            {0x1302, "SHA384", 32, TLS_CIPHER_AES_GCM_256},
+            {0x1303, "SHA256", 32, TLS_CIPHER_CHACHA20_POLY1305},
+    };
+
+    void freeSecret(void *, void *secret, CRYPTO_EX_DATA *, int, long, void *) {
+        if (secret != nullptr) {
+            auto *stored = static_cast<std::string *>(secret);
+            OPENSSL_cleanse(stored->data(), stored->size());
+            delete stored;
+        }
+    }
+
+    int secretIndex() {
+        static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeSecret);
+        return index;
+    }
+
+    // Key log lines look like "<label> <client random> <secret>", both in hex.
+    void recordSecret(const SSL *ssl, const char *line) {
+        std::string_view entry{line};
+        std::string_view label = SSL_is_server(ssl) ? SERVER_SECRET_LABEL : CLIENT_SECRET_LABEL;
+        if (!entry.starts_with(label) || entry.size() <= label.size() || entry[label.size()] != ' ') {
+            return;
+        }
+        std::string hex_secret{entry.substr(entry.rfind(' ') + 1)};
+        long size{0};
+        unsigned char *secret = OPENSSL_hexstr2buf(hex_secret.c_str(), &size);
+        if (secret == nullptr) {
+            return;
+        }
+        auto *stored = new std::string(reinterpret_cast<const char *>(secret), static_cast<std::size_t>(size));
+        OPENSSL_clear_free(secret, static_cast<std::size_t>(size));
+        auto *mutable_ssl = const_cast<SSL *>(ssl);
+        freeSecret(nullptr, SSL_get_ex_data(mutable_ssl, secretIndex()), nullptr, 0, 0, nullptr);
+        SSL_set_ex_data(mutable_ssl, secretIndex(), stored);
+    }
+
+    const CipherSuite *cipherSuiteOf(const SSL *ssl) {
+        const SSL_CIPHER *cipher = SSL_get_current_cipher(ssl);
+        if (SSL_version(ssl) != TLS1_3_VERSION || cipher == nullptr) {
+            return nullptr;
+        }
+        for (const auto &suite: CIPHER_SUITES) {
+            if (suite.protocol_id == SSL_CIPHER_get_protocol_id(cipher)) {
+                return &suite;
+            }
+        }
+        return nullptr;
+    }
+
+    // HKDF-Expand-Label of RFC 8446, section 7.1, with empty context.
+    std::optional<std::string> expandLabel(const std::string &secret, const char *digest, std::string_view label,
+                                           std::size_t size) {
+        std::string full_label = "tls13 " + std::string{label};
+        std::string info;
+        info += static_cast<char>(size >> 8);
+        info += static_cast<char>(size & 0xff);
+        info += static_cast<char>(full_label.size());
+        info += full_label;
+        info += '\0';
+
+        std::unique_ptr<EVP_KDF, decltype(&EVP_KDF_free)> kdf{EVP_KDF_fetch(nullptr, "HKDF", nullptr), &EVP_KDF_free};
+        std::unique_ptr<EVP_KDF_CTX, decltype(&EVP_KDF_CTX_free)> kdf_context{
+                kdf ? EVP_KDF_CTX_new(kdf.get()) : nullptr, &EVP_KDF_CTX_free};
+        int mode{EVP_KDF_HKDF_MODE_EXPAND_ONLY};
+        OSSL_PARAM params[]{
+                OSSL_PARAM_construct_int(OSSL_KDF_PARAM_MODE, &mode),
+                OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char *>(digest), 0),
+                OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<char *>(secret.data()),
+                                                  secret.size()),
+                OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, info.data(), info.size()),
+                OSSL_PARAM_construct_end()};
+        std::string expanded(size, '\0');
+        if (!kdf_context || EVP_KDF_derive(kdf_context.get(), reinterpret_cast<unsigned char *>(expanded.data()),
+                                           size, params) != 1) {
+            return std::nullopt;
+        }
+        return expanded;
+    }
+
+    // AES-GCM takes the first 4 bytes of the IV as salt, ChaCha20-Poly1305 has none.
+    template<class CryptoInfo>
+    bool setTransmitKeys(int socket, const TrafficKeys &keys, unsigned short kernel_cipher) {
+        CryptoInfo crypto_info{};
+        crypto_info.info.version = TLS_1_3_VERSION;
+        crypto_info.info.cipher_type = kernel_cipher;
+        std::memcpy(crypto_info.key, keys.key.data(), sizeof(crypto_info.key));
+        std::memcpy(crypto_info.salt, keys.iv.data(), sizeof(crypto_info.salt));
+        std::memcpy(crypto_info.iv, keys.iv.data() + sizeof(crypto_info.salt), sizeof(crypto_info.iv));
+        bool is_set = ::setsockopt(socket, SOL_TLS, TLS_TX, &crypto_info, sizeof(crypto_info)) == 0;
+        if (!is_set) {
+            spdlog::debug("Kernel refused TLS keys ({}), encrypting in user space.", std::strerror(errno));
+        }
+        OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+        return is_set;
+    }
+}
+
+
+void captureTrafficSecrets(SSL_CTX *context) {
+    SSL_CTX_set_keylog_callback(context, &recordSecret);
+}
+
+std::optional<TrafficKeys> sendingTrafficKeys(const SSL *ssl) {
+    const CipherSuite *suite = cipherSuiteOf(ssl);
+    const auto *secret = static_cast<const std::string *>(SSL_get_ex_data(ssl, secretIndex()));
+    if (suite == nullptr || secret == nullptr) {
+        return std::nullopt;
+    }
+    auto key = expandLabel(*secret, suite->digest, "key", suite->key_size);
+    auto iv = expandLabel(*secret, suite->digest, "iv", IV_SIZE);
+    if (!key || !iv) {
+        return std::nullopt;
+    }
+    return TrafficKeys{std::move(*key), std::move(*iv)};
+}
+
+bool enableKernelTlsSend(const SSL *ssl, int socket) {
+    const CipherSuite *suite = cipherSuiteOf(ssl);
+    auto keys = sendingTrafficKeys(ssl);
+    if (suite == nullptr || !keys) {
+        spdlog::debug("Kernel TLS needs TLS 1.3 with AES-GCM or ChaCha20-Poly1305, encrypting in user space.");
+        return false;
+    }
+    if (::setsockopt(socket, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+        spdlog::debug("Kernel TLS is not available ({}), encrypting in user space.", std::strerror(errno));
+        return false;
+    }
+    bool is_set{false};
+    switch (suite->kernel_cipher) {
+        case TLS_CIPHER_AES_GCM_128:
+            is_set = setTransmitKeys<tls12_crypto_info_aes_gcm_128>(socket, *keys, suite->kernel_cipher);
+            break;
+        case TLS_CIPHER_AES_GCM_256:
+            is_set = setTransmitKeys<tls12_crypto_info_aes_gcm_256>(socket, *keys, suite->kernel_cipher);
+            break;
+        default:
+            is_set = setTransmitKeys<tls12_crypto_info_chacha20_poly1305>(socket, *keys, suite->kernel_cipher);
+    }
+    OPENSSL_cleanse(keys->key.data(), keys->key.size());
+    return is_set;
+}
@@ -0,0 +1,212 @@
+#include "MerkleTree.hpp"
+#include "Utils.hpp"
+#include "FileReader.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+
+namespace {
+    constexpr unsigned char LEAF_PREFIX{0x00};
+    constexpr unsigned char NODE_PREFIX{0x01};
+}
+
+MerkleTree::MerkleTree(std::size_t chunk_size, std::vector<Digest> leaves, HashAlgorithm algorithm)
+        : chunk_size(chunk_size), leaf_digests(std::move(leaves)) {
+    validateChunkSize(chunk_size);
+    if (leaf_digests.empty()) {
+        throw MerkleTreeException("Merkle tree needs at least one leaf.");
+    }
+    Hasher hasher{algorithm};
+    std::vector<Digest> level = leaf_digests;
+    while (level.size() > 1) {
+        std::vector<Digest> next_level;
+        next_level.reserve(level.size() / 2 + 1);
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+            next_level.push_back(hashNode(hasher, level[i], level[i + 1]));
+        }
+        if (level.size() % 2 == 1) {
+            next_level.push_back(std::move(level.back()));
+        }
+        level = std::move(next_level);
+    }
+    root_digest = std::move(level.front());
+}
+
+MerkleTree MerkleTree::fromFile(const std::filesystem::path &path, std::size_t chunk_size, HashAlgorithm algorithm,
+                                std::size_t threads) {
+    validateChunkSize(chunk_size);
+    std::error_code error;
+    std::size_t file_size = std::filesystem::file_size(path, error);
+    if (error) {
+        throw MerkleTreeException("Error opening file: " + path.string());
+    }
+    std::vector<std::size_t> chunk_indexes(chunkCount(file_size, chunk_size));
+    std::iota(chunk_indexes.begin(), chunk_indexes.end(), std::size_t{0});
+    return {chunk_size, hashChunks(path, chunk_size, chunk_indexes, algorithm, threads), algorithm};
+}
+
+// Every thread takes the next chunk that nobody has taken yet and puts its leaf at the chunk's place,
+// so the leaves do not depend on how the chunks got spread across the threads.
+std::vector<MerkleTree::Digest> MerkleTree::hashChunks(const std::filesystem::path &path, std::size_t chunk_size,
+                                                       const std::vector<std::size_t> &chunk_indexes,
+                                                       HashAlgorithm algorithm, std::size_t threads) {
+    validateChunkSize(chunk_size);
+    std::error_code size_error;
+    std::size_t file_size = std::filesystem::file_size(path, size_error);
+    if (size_error) {
+        throw MerkleTreeException("Error opening file: " + path.string());
+    }
+    std::vector<Digest> leaves(chunk_indexes.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto hash_chunks = [&] {
+        try {
+            LeafHasher hasher{algorithm};
+            for (std::size_t i = next++; i < chunk_indexes.size() && !failed; i = next++) {
+                std::size_t chunk_begin = std::min(chunk_indexes[i] * chunk_size, file_size);
+                std::size_t chunk_end = std::min(chunk_begin + chunk_size, file_size);
+                hasher.updateFromFile(path, {chunk_begin, chunk_end});
+                leaves[i] = hasher.finish();
+            }
+        } catch (...) {
+            std::lock_guard lock{error_mutex};
+            if (!failed.exchange(true)) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::size_t thread_count = std::clamp(threads, std::size_t{1}, std::max(chunk_indexes.size(), std::size_t{1}));
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            workers.emplace_back(hash_chunks);
+        }
+        hash_chunks();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return leaves;
+}
+
+std::size_t MerkleTree::defaultHashingThreads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+std::string MerkleTree::root() const {
+    return binaryToHumanReadable(root_digest);
+}
+
+std::size_t MerkleTree::chunkSize() const {
+    return chunk_size;
+}
+
+const std::vector<MerkleTree::Digest> &MerkleTree::leaves() const {
+    return leaf_digests;
+}
+
+MerkleTree::Digest MerkleTree::hashLeaf(std::string_view chunk, HashAlgorithm algorithm) {
+    LeafHasher hasher{algorithm};
+    hasher.update(chunk);
+    return hasher.finish();
+}
+
+MerkleTree::Digest MerkleTree::hashNode(Hasher &hasher, const Digest &left, const Digest &right) {
+    hasher.update({std::bit_cast<const char *>(&NODE_PREFIX), 1});
+    hasher.update(left);
+    hasher.update(right);
+    return hasher.finish().substr(0, DIGEST_SIZE);
+}
+
+std::size_t MerkleTree::chunkCount(std::size_t file_size, std::size_t chunk_size) {
+    return std::max(std::size_t{1}, file_size / chunk_size + (file_size % chunk_size != 0 ? 1 : 0));
+}
+
+ChunkSpan MerkleTree::chunksOf(ByteRange range, std::size_t chunk_size) {
+    std::size_t first = range.begin / chunk_size;
+    if (range.size() == 0) {
+        return {first, first};
+    }
+    return {first, range.end / chunk_size + (range.end % chunk_size != 0 ? 1 : 0)};
+}
+
+ChunkSpan MerkleTree::leavesOf(ByteRange stripe, std::size_t file_size, std::size_t chunk_size) {
+    if (file_size == 0) {
+        return {0, 1};
+    }
+    return chunksOf(stripe, chunk_size);
+}
+
+void MerkleTree::validateChunkSize(std::size_t chunk_size) {
+    if (chunk_size < MIN_CHUNK_SIZE || chunk_size > MAX_CHUNK_SIZE) {
+        throw MerkleTreeException(fmt::format("Chunk size must be between {} and {} bytes, got {}.", MIN_CHUNK_SIZE,
+                                              MAX_CHUNK_SIZE, chunk_size));
+    }
+}
+
+
+LeafHasher::LeafHasher(HashAlgorithm algorithm) : hasher(algorithm) {
+    startLeaf();
+}
+
+void LeafHasher::update(std::string_view data) {
+    hasher.update(data);
+}
+
+void LeafHasher::updateFromFile(const std::filesystem::path &path, ByteRange range, std::size_t read_buffer_size) {
+    try {
+        FileReader reader{path, range, read_buffer_size};
+        for (std::string_view block = reader.next(); !block.empty(); block = reader.next()) {
+            update(block);
+        }
+    } catch (const FileReaderException &e) {
+        throw MerkleTreeException(e.what());
+    }
+}
+
+MerkleTree::Digest LeafHasher::finish() {
+    MerkleTree::Digest digest = hasher.finish().substr(0, MerkleTree::DIGEST_SIZE);
+    startLeaf();
+    return digest;
+}
+
+void LeafHasher::startLeaf() {
+    hasher.update({std::bit_cast<const char *>(&LEAF_PREFIX), 1});
+}
+
+
+RangeHasher::RangeHasher(const std::filesystem::path &path, std::size_t file_size, std::size_t chunk_size,
+                         ByteRange range, HashAlgorithm algorithm)
+        : file_size(file_size), chunk_size(chunk_size), position(range.begin), chunk_index(range.begin / chunk_size),
+          hasher(algorithm) {
+    std::size_t chunk_begin = chunk_index * chunk_size;
+    if (range.size() > 0 && chunk_begin < range.begin) {
+        hasher.updateFromFile(path, {chunk_begin, range.begin});
+    }
+}
+
+void RangeHasher::update(std::string_view data, const LeafCallback &on_leaf) {
+    while (!data.empty()) {
+        std::size_t chunk_end = std::min((chunk_index + 1) * chunk_size, file_size);
+        if (position >= chunk_end) {
+            throw MerkleTreeException("Data goes past the end of file.");
+        }
+        std::size_t part_size = std::min(data.size(), chunk_end - position);
+        hasher.update(data.substr(0, part_size));
+        data.remove_prefix(part_size);
+        position += part_size;
+        if (position == chunk_end) {
+            on_leaf(chunk_index++, hasher.finish());
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#include "RateLimiter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+
+RateLimiter::RateLimiter(std::size_t bytes_per_second, Clock::time_point now)
+        : bytes_per_second(bytes_per_second),
+          burst_size(std::max(MIN_BURST_SIZE, bytes_per_second * BURST_DURATION.count() / 1000)),
+          tokens(static_cast<double>(burst_size)), last_refill(now) {
+    if (bytes_per_second == 0) {
+        throw RateLimiterException("Rate limit must be greater than 0.");
+    }
+}
+
+RateLimiter::Clock::duration RateLimiter::reserve(std::size_t bytes, Clock::time_point now) {
+    std::lock_guard lock{m};
+    if (now > last_refill) {
+        double refill = std::chrono::duration<double>(now - last_refill).count() * static_cast<double>(bytes_per_second);
+        tokens = std::min(static_cast<double>(burst_size), tokens + refill);
+        last_refill = now;
+    }
+    tokens -= static_cast<double>(bytes);
+    if (tokens >= 0) {
+        return Clock::duration::zero();
+    }
+    return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(-tokens / static_cast<double>(bytes_per_second)));
+}
+
+void RateLimiter::acquire(std::size_t bytes) {
+    std::this_thread::sleep_for(reserve(bytes, Clock::now()));
+}
+
+std::size_t RateLimiter::burstSize() const {
+    return burst_size;
+}
+
+std::size_t RateLimiter::bytesPerSecond() const {
+    return bytes_per_second;
+}
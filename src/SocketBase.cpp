@@ -4,152 +4,579 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <sys/sendfile.h>
+
 namespace asio = boost::asio;
 using boost::system::error_code;
 
-SocketBase::SocketBase(boost::asio::ssl::stream<tcp::socket> socket_) : socket_(std::move(socket_)),
-                                                                        data_buffer(
-                                                                                std::make_unique<char[]>(
-                                                                                        BUFFER_SIZE)) {}
+template<class Stream_t>
+SocketBase<Stream_t>::SocketBase(Stream_t socket_) : socket_(std::move(socket_)),
+                                                     read_buffer(allocateReadBuffer(max_frame_size)) {}
 
-void SocketBase::send(std::string_view data) {
+template<class Stream_t>
+void SocketBase<Stream_t>::send(std::string_view data) {
     MSG_HEADER_t message_length = data.size();
     MSG_HEADER_t ptr_cursor = 0;
-    while (message_length >= BUFFER_SIZE) {
-        sendChunk({data.data() + ptr_cursor, BUFFER_SIZE});
-        message_length -= BUFFER_SIZE;
-        ptr_cursor += BUFFER_SIZE;
+    while (message_length >= max_frame_size) {
+        sendFrame(FrameType::data, {data.data() + ptr_cursor, max_frame_size});
+        message_length -= max_frame_size;
+        ptr_cursor += max_frame_size;
     }
     if (message_length > 0) {
-        sendChunk({data.data() + ptr_cursor, message_length});
+        sendFrame(FrameType::data, {data.data() + ptr_cursor, message_length});
     }
 }
 
-void SocketBase::sendChunk(std::string_view data) {
-    MSG_HEADER_t message_length = data.size();
-    std::vector<boost::asio::const_buffer> message{};
-    message.emplace_back(boost::asio::buffer(&message_length, sizeof(message_length)));
-    message.push_back(boost::asio::buffer(data));
-    boost::asio::write(socket_, message);
+template<class Stream_t>
+void SocketBase<Stream_t>::sendFrame(FrameType type, std::string_view payload) {
+    FrameHeaderBuffer header{};
+    std::size_t header_size = prepareHeader(type, payload, header);
+    write({std::bit_cast<const char *>(header.data()), header_size}, payload);
+}
+
+// Once the kernel does the sending, bytes go straight to the TCP socket, past the TLS stream.
+template<class Stream_t>
+void SocketBase<Stream_t>::write(std::string_view header, std::string_view payload) {
+    has_sent = true;
+    std::array<boost::asio::const_buffer, 2> message{asio::buffer(header), asio::buffer(payload)};
+    if (kernel_send) {
+        boost::asio::write(StreamPolicy<Stream_t>::socketOf(socket_), message);
+    } else {
+        boost::asio::write(socket_, message);
+    }
+}
+
+template<class Stream_t>
+bool SocketBase<Stream_t>::enableKernelSend() {
+    if (!kernel_send && !has_sent) {
+        kernel_send = StreamPolicy<Stream_t>::enableKernelSend(socket_);
+    }
+    return kernel_send;
+}
+
+template<class Stream_t>
+bool SocketBase<Stream_t>::sendsFromKernel() const {
+    return kernel_send;
+}
+
+// Header goes with MSG_MORE, so that the kernel puts it in the same TLS record (or TCP segment) as the payload.
+template<class Stream_t>
+void SocketBase<Stream_t>::sendFileFrame(int file, std::size_t offset, std::size_t size) {
+    if (!kernel_send || protocol != WireProtocol::framed) {
+        throw SocketException("Frames are sent straight from files only in framed protocol, by the kernel.");
+    }
+    FrameHeaderBuffer header{};
+    std::size_t header_size = encodeFrameHeader(FrameType::data, size, header);
+    tcp::socket &tcp_socket = StreamPolicy<Stream_t>::socketOf(socket_);
+    for (std::size_t sent = 0; sent < header_size;) {
+        sent += tcp_socket.send(asio::buffer(header.data() + sent, header_size - sent), MSG_MORE);
+    }
+    auto file_offset = static_cast<off_t>(offset);
+    while (size > 0) {
+        ssize_t sent = ::sendfile(tcp_socket.native_handle(), file, &file_offset, size);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && errno == EAGAIN) {
+            tcp_socket.wait(tcp::socket::wait_write);
+            continue;
+        }
+        if (sent < 0) {
+            throw boost::system::system_error{error_code{errno, boost::system::system_category()}, "sendfile"};
+        }
+        if (sent == 0) {
+            throw SocketException(fmt::format("File has ended at {}, before the frame did.", file_offset));
+        }
+        size -= static_cast<std::size_t>(sent);
+    }
+}
+
+// Legacy protocol has no frame types, so ACK and ABORT are sent the way old clients expect them.
+template<class Stream_t>
+std::size_t SocketBase<Stream_t>::prepareHeader(FrameType type, std::string_view &payload,
+                                                FrameHeaderBuffer &header) const {
+    if (protocol == WireProtocol::framed) {
+        return encodeFrameHeader(type, payload.size(), header);
+    }
+    if (type == FrameType::ack) {
+        payload = ACK;
+    } else if (type == FrameType::abort) {
+        payload = ABORT;
+    }
+    MSG_HEADER_t message_length = payload.size();
+    std::memcpy(header.data(), &message_length, sizeof(message_length));
+    return sizeof(message_length);
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncSend(std::string_view data, SentHandler sent_handler) {
+    asyncSendFrame(FrameType::data, data, std::move(sent_handler));
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncSendFrame(FrameType type, std::string_view payload, SentHandler sent_handler) {
+    if (payload.size() > max_frame_size) {
+        throw SocketException(
+                fmt::format("Tried to asynchronously send {} bytes in single message, where buffer size is {}.",
+                            payload.size(), max_frame_size));
+    }
+    std::size_t header_size = prepareHeader(type, payload, async_send_header);
+    has_sent = true;
+    std::array<boost::asio::const_buffer, 2> message{asio::buffer(async_send_header.data(), header_size),
+                                                     asio::buffer(payload)};
+    boost::asio::async_write(socket_, message,
+                             [self = this->shared_from_this(), sent_handler = std::move(sent_handler)](error_code ec,
+                                                                                                 std::size_t) {
+                                 if (!ec) {
+                                     sent_handler();
+                                 } else {
+                                     spdlog::debug("Encountered an error during async send, aborting. Details: {}",
+                                                   ec.what());
+                                     self->onAsyncError(ec);
+                                 }
+                             });
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::queueFrame(FrameType type, std::string_view payload) {
+    FrameHeaderBuffer header{};
+    std::size_t header_size = prepareHeader(type, payload, header);
+    std::string frame{std::bit_cast<const char *>(header.data()), header_size};
+    frame += payload;
+    write_queue.push_back(std::move(frame));
+    has_sent = true;
+    if (write_queue.size() == 1) {
+        writeQueuedFrames();
+    }
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::writeQueuedFrames() {
+    boost::asio::async_write(socket_, asio::buffer(write_queue.front()),
+                             [this, self = this->shared_from_this()](error_code ec, std::size_t) {
+                                 if (ec) {
+                                     spdlog::debug("Encountered an error during queued send, aborting. Details: {}",
+                                                   ec.what());
+                                     write_queue.clear();
+                                     onAsyncError(ec);
+                                     return;
+                                 }
+                                 write_queue.pop_front();
+                                 if (!write_queue.empty()) {
+                                     writeQueuedFrames();
+                                 }
+                             });
 }
 
-void SocketBase::disconnect(std::optional<std::string> disconnect_msg) {
+template<class Stream_t>
+void SocketBase<Stream_t>::disconnect(std::optional<std::string> disconnect_msg) {
     spdlog::debug("Disconnecting... {}", disconnect_msg.value_or(""));
     if (disconnect_msg.has_value()) {
-        send(*disconnect_msg);
+        sendFrame(FrameType::error, *disconnect_msg);
     }
     socket_.lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_send);
 }
 
-std::string SocketBase::receive() {
-    MSG_HEADER_t message_length = getMessageLength();
-    std::string message{};
-    message.resize(message_length);
-    boost::asio::read(socket_, boost::asio::buffer(message), boost::asio::transfer_exactly(message_length));
-    return message;
+template<class Stream_t>
+void SocketBase<Stream_t>::close() {
+    error_code ec;
+    socket_.lowest_layer().close(ec);
+    if (ec) {
+        spdlog::debug("Error while closing socket: {}", ec.what());
+    }
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::shutdown() {
+    error_code ec;
+    socket_.lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
 }
 
-std::size_t SocketBase::getMessageLength() {
-    MSG_HEADER_t message_length{};
-    boost::asio::mutable_buffer buffer{&message_length, sizeof(message_length)};
-    boost::asio::read(socket_, buffer, boost::asio::transfer_exactly(buffer.size()));
-    if (message_length > BUFFER_SIZE) {
+template<class Stream_t>
+std::string SocketBase<Stream_t>::receive() {
+    return std::string{receiveFrame().payload};
+}
+
+template<class Stream_t>
+std::string_view SocketBase<Stream_t>::receiveToBuffer() {
+    return receiveFrame().payload;
+}
+
+template<class Stream_t>
+Frame SocketBase<Stream_t>::receiveFrame() {
+    Frame frame = receiveAnyFrame();
+    while (absorbCredit(frame)) {
+        frame = receiveAnyFrame();
+    }
+    return frame;
+}
+
+template<class Stream_t>
+Frame SocketBase<Stream_t>::receiveAnyFrame() {
+    if (awaiting_hello) {
+        receiveHello();
+    }
+    FrameHeader header = readFrameHeader();
+    if (header.payload_size > max_frame_size) {
         safeDisconnect("Cannot receive message of this size.");
         throw SocketException(
                 fmt::format("Somebody is trying to send {} bytes in single message, which is more than allowed ({})",
-                            message_length, BUFFER_SIZE));
+                            header.payload_size, max_frame_size));
+    }
+    alignPayload(header);
+    fillReadBuffer(header.header_size + header.payload_size);
+    return takeFrame(header);
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::receiveHello() {
+    fillReadBuffer(Hello::SIZE);
+    Hello hello = decodeHello(bufferedBytes());
+    consume(Hello::SIZE);
+    awaiting_hello = false;
+    setMaxFrameSize(std::min(hello.max_frame_size, requested_frame_size));
+    spdlog::debug("Peer speaks framed protocol version {}, max frame size: {}.", hello.version, max_frame_size);
+}
+
+template<class Stream_t>
+FrameHeader SocketBase<Stream_t>::readFrameHeader() {
+    if (protocol == WireProtocol::legacy) {
+        fillReadBuffer(sizeof(MSG_HEADER_t));
+        return parseLegacyHeader();
+    }
+    std::optional<FrameHeader> header;
+    while (!(header = decodeFrameHeader(bufferedBytes()))) {
+        fillReadBuffer(bufferedBytes().size() + 1);
+    }
+    return *header;
+}
+
+template<class Stream_t>
+FrameHeader SocketBase<Stream_t>::parseLegacyHeader() const {
+    MSG_HEADER_t message_length{};
+    std::memcpy(&message_length, read_buffer.get() + read_begin, sizeof(message_length));
+    return {FrameType::data, message_length, sizeof(message_length)};
+}
+
+template<class Stream_t>
+Frame SocketBase<Stream_t>::takeFrame(const FrameHeader &header) {
+    Frame frame{header.type, {read_buffer.get() + read_begin + header.header_size, header.payload_size}};
+    consume(header.header_size + header.payload_size);
+    return frame;
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::fillReadBuffer(std::size_t bytes) {
+    reserveReadSpace(bytes);
+    while (read_end - read_begin < bytes) {
+        read_end += socket_.read_some(asio::buffer(read_buffer.get() + read_end, readLimit() - read_end));
+    }
+}
+
+// Makes sure that `bytes` counted from the first unconsumed one fit in the buffer, so frames are always contiguous.
+template<class Stream_t>
+void SocketBase<Stream_t>::reserveReadSpace(std::size_t bytes) {
+    if (read_begin + bytes > readLimit()) {
+        std::memmove(read_buffer.get(), read_buffer.get() + read_begin, read_end - read_begin);
+        read_end -= read_begin;
+        read_begin = 0;
     }
-    return message_length;
 }
 
-std::string_view SocketBase::receiveToBuffer() {
-    MSG_HEADER_t message_length = getMessageLength();
-    boost::asio::read(socket_, boost::asio::mutable_buffer(data_buffer.get(), message_length),
-                      boost::asio::transfer_exactly(message_length));
-    return {data_buffer.get(), message_length};
+// Moves already buffered bytes so that the payload starts exactly at getBuffer(). Only bytes that were read
+// together with the header are moved, the rest of the payload is read straight into place.
+// Reads never go past readLimit(), so the extra PAYLOAD_OFFSET bytes of allocation leave room to shift forward.
+template<class Stream_t>
+void SocketBase<Stream_t>::alignPayload(const FrameHeader &header) {
+    std::size_t aligned_begin = PAYLOAD_OFFSET - header.header_size;
+    if (read_begin != aligned_begin) {
+        std::size_t buffered = read_end - read_begin;
+        std::memmove(read_buffer.get() + aligned_begin, read_buffer.get() + read_begin, buffered);
+        read_begin = aligned_begin;
+        read_end = aligned_begin + buffered;
+    }
+}
+
+template<class Stream_t>
+std::span<const char> SocketBase<Stream_t>::bufferedBytes() const {
+    return {read_buffer.get() + read_begin, read_end - read_begin};
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::consume(std::size_t bytes) {
+    read_begin += bytes;
+    if (read_begin == read_end) {
+        read_begin = read_end = 0;
+    }
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncReadMessage(std::size_t max_msg_size, MessageHandler message_handler) {
+    asyncReadFrame(max_msg_size, [message_handler = std::move(message_handler)](const Frame &frame) {
+        message_handler(frame.payload);
+    });
 }
 
-void SocketBase::asyncReadMessage(std::size_t max_msg_size, MessageHandler message_handler) {
-    if (max_msg_size > BUFFER_SIZE) {
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncReadFrame(std::size_t max_payload_size, FrameHandler frame_handler) {
+    if (max_payload_size > max_frame_size) {
         throw SocketException(
                 fmt::format("Tried to schedule receiving message with max size of {} bytes, where buffer size is {}.",
-                            max_msg_size, BUFFER_SIZE));
-    }
-    asyncReadHeader(max_msg_size, std::move(message_handler));
-}
-
-void SocketBase::asyncReadHeader(size_t max_msg_size, SocketBase::MessageHandler message_handler) {
-    constexpr std::size_t HEADER_SIZE = sizeof(MSG_HEADER_t);
-    boost::asio::async_read(socket_, asio::buffer(data_buffer.get(), HEADER_SIZE),
-                            asio::transfer_exactly(HEADER_SIZE),
-                            [this, self = shared_from_this(), max_msg_size, message_handler = std::move(
-                                    message_handler)](error_code ec, std::size_t) mutable {
-                                if (!ec) {
-                                    MSG_HEADER_t message_size = *std::bit_cast<MSG_HEADER_t *>(data_buffer.get());
-                                    if (message_size > max_msg_size) {
-                                        spdlog::warn(
-                                                "Somebody tried to send {} bytes, which is more than allowed ({}) for this callback.",
-                                                message_size, max_msg_size);
-                                        safeDisconnect(
-                                                fmt::format("Tried to send {} bytes, which is more than allowed ({}).",
-                                                            message_size, max_msg_size));
-                                        return;
-                                    }
-                                    asyncReadMessageImpl(std::move(self), std::move(message_handler), message_size);
-                                } else {
-                                    spdlog::debug("Encountered an error during async read, aborting. Details: {}",
-                                                  ec.what());
-                                }
-                            });
+                            max_payload_size, max_frame_size));
+    }
+    asyncReadFrameHeader(max_payload_size, std::move(frame_handler));
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncAcceptProtocol(std::size_t max_first_message_size, std::size_t frame_size_limit,
+                                               FrameHandler frame_handler) {
+    asyncFillReadBuffer(Hello::SIZE, [this, max_first_message_size, frame_size_limit,
+                                      frame_handler = std::move(frame_handler)]() mutable {
+        if (!isHello(bufferedBytes())) {
+            asyncReadFrame(max_first_message_size, std::move(frame_handler)); // legacy client
+            return;
+        }
+        Hello peer_hello{};
+        try {
+            peer_hello = decodeHello(bufferedBytes());
+        } catch (const FramingException &e) {
+            safeDisconnect(e.what());
+            return;
+        }
+        consume(Hello::SIZE);
+        protocol = WireProtocol::framed;
+        Hello answer{std::min(peer_hello.version, Hello::PROTOCOL_VERSION),
+                     std::min(peer_hello.max_frame_size, normalizeFrameSize(frame_size_limit))};
+        try {
+            setMaxFrameSize(answer.max_frame_size);
+        } catch (const SocketException &e) {
+            safeDisconnect(e.what());
+            return;
+        }
+        hello_buffer = encodeHello(answer);
+        has_sent = true;
+        boost::asio::async_write(socket_, asio::buffer(hello_buffer),
+                                 [this, self = this->shared_from_this(), max_first_message_size, frame_handler = std::move(
+                                         frame_handler)](error_code ec, std::size_t) mutable {
+                                     if (!ec) {
+                                         asyncReadFrame(max_first_message_size, std::move(frame_handler));
+                                     } else {
+                                         spdlog::debug("Could not send hello, aborting. Details: {}", ec.what());
+                                     }
+                                 });
+    });
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncReadFrameHeader(std::size_t max_payload_size, FrameHandler frame_handler) {
+    if (protocol == WireProtocol::legacy) {
+        asyncFillReadBuffer(sizeof(MSG_HEADER_t), [this, max_payload_size, frame_handler = std::move(frame_handler)]() mutable {
+            asyncReadFramePayload(parseLegacyHeader(), max_payload_size, std::move(frame_handler));
+        });
+        return;
+    }
+    std::optional<FrameHeader> header;
+    try {
+        header = decodeFrameHeader(bufferedBytes());
+    } catch (const FramingException &e) {
+        spdlog::warn("Received malformed frame: {}", e.what());
+        safeDisconnect(e.what());
+        return;
+    }
+    if (header) {
+        asyncReadFramePayload(*header, max_payload_size, std::move(frame_handler));
+        return;
+    }
+    asyncFillReadBuffer(bufferedBytes().size() + 1, [this, max_payload_size, frame_handler = std::move(frame_handler)]() mutable {
+        asyncReadFrameHeader(max_payload_size, std::move(frame_handler));
+    });
 }
 
-void
-SocketBase::asyncReadMessageImpl(std::shared_ptr<SocketBase> self,
-                                 std::function<void(std::string_view)> message_handler,
-                                 unsigned long message_size) {
-    boost::asio::async_read(socket_, asio::buffer(data_buffer.get(), message_size),
-                            asio::transfer_exactly(message_size),
-                            [self = std::move(self), message_handler = std::move(
-                                    message_handler), this](error_code ec,
-                                                            std::size_t message_size) {
-                                if (!ec) {
-                                    message_handler(std::string_view{data_buffer.get(),
-                                                                     message_size});
-                                } else {
-                                    spdlog::error(
-                                            "Encountered an error during async read, aborting. Details: {}",
-                                            ec.what());
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncReadFramePayload(const FrameHeader &header, std::size_t max_payload_size,
+                                                 FrameHandler frame_handler) {
+    if (header.payload_size > max_payload_size) {
+        spdlog::warn("Somebody tried to send {} bytes, which is more than allowed ({}) for this callback.",
+                     header.payload_size, max_payload_size);
+        safeDisconnect(fmt::format("Tried to send {} bytes, which is more than allowed ({}).",
+                                   header.payload_size, max_payload_size));
+        return;
+    }
+    alignPayload(header);
+    asyncFillReadBuffer(header.header_size + header.payload_size,
+                        [this, header, frame_handler = std::move(frame_handler)] {
+                            frame_handler(takeFrame(header));
+                        });
+}
+
+// Calls on_filled (never inline) once at least `bytes` are buffered. On error the handler is dropped,
+// which releases the session, as with every other failed async operation, after onAsyncError is called.
+template<class Stream_t>
+void SocketBase<Stream_t>::asyncFillReadBuffer(std::size_t bytes, std::function<void()> on_filled) {
+    reserveReadSpace(bytes);
+    if (read_end - read_begin >= bytes) {
+        asio::post(socket_.get_executor(), [self = this->shared_from_this(), on_filled = std::move(on_filled)] {
+            on_filled();
+        });
+        return;
+    }
+    socket_.async_read_some(asio::buffer(read_buffer.get() + read_end, readLimit() - read_end),
+                            [this, self = this->shared_from_this(), bytes, on_filled = std::move(on_filled)](
+                                    error_code ec, std::size_t bytes_read) mutable {
+                                if (ec) {
+                                    spdlog::debug("Encountered an error during async read, aborting. Details: {}",
+                                                  ec.what());
+                                    onAsyncError(ec);
+                                    return;
                                 }
+                                read_end += bytes_read;
+                                asyncFillReadBuffer(bytes, std::move(on_filled));
                             });
 }
 
-void SocketBase::receiveACK() {
-    auto response = receiveToBuffer();
-    if (response != SocketBase::ACK) {
+template<class Stream_t>
+std::string SocketBase<Stream_t>::receiveACK() {
+    Frame response = receiveFrame();
+    if (!isACK(response)) {
         std::string_view additional_message;
         constexpr std::size_t MAX_PRINTABLE_STR_LENGTH{100}; // totally arbitrary number
-        if (response.size() < MAX_PRINTABLE_STR_LENGTH) {
-            additional_message = response;
+        if (response.payload.size() < MAX_PRINTABLE_STR_LENGTH) {
+            additional_message = response.payload;
         } else {
             additional_message = "Too large to print.";
         }
         throw SocketException(
-                fmt::format("Response not ok. Response size: {}. {}", response.size(), additional_message));
+                fmt::format("Response not ok. Response size: {}. {}", response.payload.size(), additional_message));
+    }
+    return isFramed() ? std::string{response.payload} : std::string{};
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::sendACK() {
+    sendFrame(FrameType::ack, {});
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::grantCredit(std::size_t bytes) {
+    if (isFramed()) {
+        sendFrame(FrameType::credit, encodeCredit(bytes));
+    }
+}
+
+// Blocks until the peer lets us send at least one more byte. Any other frame than CREDIT means
+// the transfer is over from the peer's point of view.
+template<class Stream_t>
+std::size_t SocketBase<Stream_t>::awaitCredit() {
+    if (!isFramed()) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    while (send_credit == 0) {
+        Frame frame = receiveAnyFrame();
+        if (!absorbCredit(frame)) {
+            throw SocketException(fmt::format("Waiting for credit, got {} frame instead: {}", toString(frame.type),
+                                              frame.payload.substr(0, 100)));
+        }
+    }
+    return send_credit;
+}
+
+template<class Stream_t>
+void SocketBase<Stream_t>::consumeCredit(std::size_t bytes) {
+    if (isFramed()) {
+        send_credit -= std::min(bytes, send_credit);
+    }
+}
+
+template<class Stream_t>
+bool SocketBase<Stream_t>::absorbCredit(const Frame &frame) {
+    if (!isFramed() || frame.type != FrameType::credit) {
+        return false;
+    }
+    send_credit += decodeCredit(frame.payload);
+    return true;
+}
+
+template<class Stream_t>
+bool SocketBase<Stream_t>::isACK(const Frame &frame) const {
+    if (protocol == WireProtocol::framed) {
+        return frame.type == FrameType::ack;
+    }
+    return frame.payload == ACK;
+}
+
+template<class Stream_t>
+bool SocketBase<Stream_t>::isFramed() const {
+    return protocol == WireProtocol::framed;
+}
+
+template<class Stream_t>
+std::pair<char *, std::size_t> SocketBase<Stream_t>::getBuffer() {
+    return {read_buffer.get() + PAYLOAD_OFFSET, max_frame_size};
+}
+
+template<class Stream_t>
+std::size_t SocketBase<Stream_t>::maxFrameSize() const {
+    return max_frame_size;
+}
+
+template<class Stream_t>
+int SocketBase<Stream_t>::nativeHandle() {
+    return socket_.lowest_layer().native_handle();
+}
+
+// Reallocates the receive buffer for the negotiated frame size, keeping bytes that were already read.
+template<class Stream_t>
+void SocketBase<Stream_t>::setMaxFrameSize(std::size_t frame_size) {
+    std::size_t buffered = read_end - read_begin;
+    if (buffered > PAYLOAD_OFFSET + frame_size) {
+        throw SocketException(fmt::format("Peer sent {} bytes before agreeing on frame size of {} bytes.",
+                                          buffered, frame_size));
     }
+    auto new_buffer = allocateReadBuffer(frame_size);
+    std::memcpy(new_buffer.get(), read_buffer.get() + read_begin, buffered);
+    read_buffer = std::move(new_buffer);
+    read_begin = 0;
+    read_end = buffered;
+    max_frame_size = frame_size;
 }
 
-void SocketBase::sendACK() {
-    send(SocketBase::ACK);
+// Forgets everything that was negotiated or buffered on the previous connection, before the stream is reconnected.
+template<class Stream_t>
+void SocketBase<Stream_t>::resetConnectionState() {
+    protocol = WireProtocol::legacy;
+    awaiting_hello = false;
+    read_begin = read_end = 0;
+    send_credit = 0;
+    write_queue.clear();
+    has_sent = kernel_send = false;
+    setMaxFrameSize(DEFAULT_FRAME_SIZE);
 }
 
-std::pair<char *, std::size_t> SocketBase::getBuffer() {
-    return {data_buffer.get(), BUFFER_SIZE};
+template<class Stream_t>
+void SocketBase<Stream_t>::onAsyncError(const error_code &) {}
+
+template<class Stream_t>
+std::size_t SocketBase<Stream_t>::readLimit() const {
+    return PAYLOAD_OFFSET + max_frame_size;
+}
+
+template<class Stream_t>
+std::unique_ptr<char[]> SocketBase<Stream_t>::allocateReadBuffer(std::size_t frame_size) {
+    return std::make_unique<char[]>(2 * PAYLOAD_OFFSET + frame_size);
 }
 
-void SocketBase::safeDisconnect(std::optional<std::string> disconnect_msg) {
+template<class Stream_t>
+void SocketBase<Stream_t>::safeDisconnect(std::optional<std::string> disconnect_msg) {
     try {
         disconnect(std::move(disconnect_msg));
     } catch(const std::exception& e) {
         spdlog::warn(e.what());
     }
 }
+
+template class SocketBase<TlsStream>;
+template class SocketBase<PlainStream>;
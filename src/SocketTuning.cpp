@@ -0,0 +1,99 @@
+#include "SocketTuning.hpp"
+#include "Utils.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+
+std::string toString(const TuningReport &report) {
+    return fmt::format("congestion control {}, RTT {:.1f} ms, throughput {}/s, send buffer {}, receive buffer {}",
+                       report.congestion_control.empty() ? "unknown" : report.congestion_control,
+                       std::chrono::duration<double, std::milli>(report.rtt).count(),
+                       bytesToHumanReadable(static_cast<std::size_t>(report.bytes_per_second)),
+                       bytesToHumanReadable(report.send_buffer), bytesToHumanReadable(report.receive_buffer));
+}
+
+SocketTuner::SocketTuner(NativeHandle socket, const TuningProfile &profile, Clock::time_point now)
+        : socket(socket), started(now) {
+    applyCongestionControl(profile.congestion_control);
+    tuning_report.send_buffer = bufferSize(SO_SNDBUF);
+    tuning_report.receive_buffer = bufferSize(SO_RCVBUF);
+}
+
+// Unprivileged processes may use only what net.ipv4.tcp_allowed_congestion_control lists, otherwise the default stays.
+void SocketTuner::applyCongestionControl(const std::string &congestion_control) {
+    if (!congestion_control.empty() &&
+        setsockopt(socket, IPPROTO_TCP, TCP_CONGESTION, congestion_control.data(),
+                   static_cast<socklen_t>(congestion_control.size())) != 0) {
+        spdlog::warn("Could not use {} congestion control: {}", congestion_control, std::strerror(errno));
+    }
+    std::array<char, 16> name{}; // TCP_CA_NAME_MAX
+    auto size = static_cast<socklen_t>(name.size());
+    if (getsockopt(socket, IPPROTO_TCP, TCP_CONGESTION, name.data(), &size) == 0) {
+        tuning_report.congestion_control = std::string{name.data(), strnlen(name.data(), size)};
+    }
+}
+
+bool SocketTuner::recordTransferred(std::size_t bytes, Clock::time_point now) {
+    if (is_tuned) {
+        return false;
+    }
+    bytes_transferred += bytes;
+    if (now - started < MEASUREMENT_PERIOD) {
+        return false;
+    }
+    sizeBuffers(now);
+    is_tuned = true;
+    return true;
+}
+
+void SocketTuner::sizeBuffers(Clock::time_point now) {
+    tcp_info info{};
+    auto info_size = static_cast<socklen_t>(sizeof(info));
+    if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &info_size) == 0) {
+        tuning_report.rtt = std::chrono::microseconds{info.tcpi_rtt};
+    }
+    tuning_report.bytes_per_second = static_cast<double>(bytes_transferred) /
+                                     std::chrono::duration<double>(now - started).count();
+    std::size_t target = bufferSizeFor(tuning_report.rtt, tuning_report.bytes_per_second);
+    tuning_report.send_buffer = growBuffer(SO_SNDBUF, target);
+    tuning_report.receive_buffer = growBuffer(SO_RCVBUF, target);
+}
+
+// Kernel doubles the requested size for its bookkeeping and caps it at net.core.[rw]mem_max.
+std::size_t SocketTuner::growBuffer(int option, std::size_t size) const {
+    if (bufferSize(option) < size) {
+        int requested = static_cast<int>(size / 2);
+        if (setsockopt(socket, SOL_SOCKET, option, &requested, sizeof(requested)) != 0) {
+            spdlog::debug("Could not resize socket buffer: {}", std::strerror(errno));
+        }
+    }
+    return bufferSize(option);
+}
+
+std::size_t SocketTuner::bufferSize(int option) const {
+    int size{0};
+    auto option_size = static_cast<socklen_t>(sizeof(size));
+    if (getsockopt(socket, SOL_SOCKET, option, &size, &option_size) != 0 || size < 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(size);
+}
+
+const TuningReport &SocketTuner::report() const {
+    return tuning_report;
+}
+
+std::size_t SocketTuner::bufferSizeFor(std::chrono::microseconds rtt, double bytes_per_second) {
+    double bdp = bytes_per_second * std::chrono::duration<double>(rtt).count();
+    return std::clamp(static_cast<std::size_t>(2 * bdp), MIN_BUFFER_SIZE, MAX_BUFFER_SIZE);
+}
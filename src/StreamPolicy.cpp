@@ -0,0 +1,26 @@
+#include "StreamPolicy.hpp"
+#include "KernelTls.hpp"
+
+
+StreamPolicy<TlsStream>::Context StreamPolicy<TlsStream>::createServerContext(const std::filesystem::path &key_cert_dir) {
+    Context context{boost::asio::ssl::context::sslv23};
+    context.set_options(
+            boost::asio::ssl::context::default_workarounds
+            | boost::asio::ssl::context::no_sslv2
+            | boost::asio::ssl::context::verify_fail_if_no_peer_cert);
+    context.use_certificate_chain_file(key_cert_dir / "cert.pem");
+    context.use_private_key_file(key_cert_dir / "key.pem",
+                                 boost::asio::ssl::context::pem);
+    return context;
+}
+
+// Traffic secrets are kept, so that sending can be handed to the kernel later.
+StreamPolicy<TlsStream>::Context StreamPolicy<TlsStream>::createClientContext() {
+    Context context{boost::asio::ssl::context::tls};
+    captureTrafficSecrets(context.native_handle());
+    return context;
+}
+
+bool StreamPolicy<TlsStream>::enableKernelSend(TlsStream &stream) {
+    return enableKernelTlsSend(stream.native_handle(), stream.lowest_layer().native_handle());
+}
@@ -0,0 +1,13 @@
+#include "Striping.hpp"
+
+#include <algorithm>
+
+
+ByteRange stripeRange(std::size_t file_size, std::size_t streams, std::size_t index, std::size_t alignment) {
+    std::size_t units = file_size / alignment + (file_size % alignment != 0 ? 1 : 0);
+    std::size_t stripe_units = units / streams;
+    std::size_t remainder = units % streams;
+    std::size_t begin = index * stripe_units + std::min(index, remainder);
+    std::size_t end = begin + stripe_units + (index < remainder ? 1 : 0);
+    return {std::min(begin * alignment, file_size), std::min(end * alignment, file_size)};
+}
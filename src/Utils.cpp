@@ -1,8 +1,9 @@
 #include "Utils.hpp"
+#include "FileReader.hpp"
 
-#include <openssl/evp.h>
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <fstream>
 #include <vector>
 #include <sstream>
@@ -13,43 +14,18 @@
 #include <random>
 
 
-std::string binaryToHumanReadable(std::string_view data);
-
-std::string calculateFileHash(const std::filesystem::path &path) {
-    constexpr int buffer_size = 8192;
-    std::vector<unsigned char> buffer(buffer_size);
-
-    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> mdctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
-    const EVP_MD *md = EVP_sha256();
-
-    if (!mdctx) {
-        throw UtilsException("Error creating context for hashing.");
-    }
-
-    if (EVP_DigestInit_ex(mdctx.get(), md, nullptr) != 1) {
-        throw UtilsException("Error initializing digest context.");
-    }
-
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        throw UtilsException("Error opening file: " + path.string());
-    }
-
-    while (file.good()) {
-        file.read(reinterpret_cast<char *>(buffer.data()), buffer_size);
-        if (file.gcount() > 0) {
-            if (EVP_DigestUpdate(mdctx.get(), buffer.data(), static_cast<size_t>(file.gcount())) != 1) {
-                throw UtilsException("Error updating digest.");
-            }
+std::string calculateFileHash(const std::filesystem::path &path, HashAlgorithm algorithm,
+                              std::size_t read_buffer_size) {
+    Hasher hasher{algorithm};
+    try {
+        FileReader reader{path, read_buffer_size};
+        for (std::string_view block = reader.next(); !block.empty(); block = reader.next()) {
+            hasher.update(block);
         }
+    } catch (const FileReaderException &e) {
+        throw UtilsException(e.what());
     }
-
-    std::vector<unsigned char> hash_result(static_cast<unsigned long>(EVP_MD_size(md)));
-    if (EVP_DigestFinal_ex(mdctx.get(), hash_result.data(), nullptr) != 1) {
-        throw UtilsException("Error finalizing digest.");
-    }
-
-    return binaryToHumanReadable({std::bit_cast<char *>(hash_result.data()), hash_result.size()});
+    return binaryToHumanReadable(hasher.finish());
 }
 
 std::string binaryToHumanReadable(std::string_view data) {
@@ -62,7 +38,7 @@ std::string binaryToHumanReadable(std::string_view data) {
 
 std::string bytesToHumanReadable(std::size_t bytes) {
     constexpr std::size_t step{10};
-    auto order_of_magnitude = static_cast<std::size_t>(std::log2(bytes)) / step;
+    auto order_of_magnitude = bytes > 0 ? static_cast<std::size_t>(std::log2(bytes)) / step : 0;
     switch (order_of_magnitude) {
         case 0:
             return fmt::format("{} B", bytes);
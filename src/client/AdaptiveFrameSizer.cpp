@@ -0,0 +1,26 @@
+#include "client/AdaptiveFrameSizer.hpp"
+#include "Framing.hpp"
+
+#include <algorithm>
+
+
+AdaptiveFrameSizer::AdaptiveFrameSizer(std::size_t max_frame_size)
+        : max_frame_size(normalizeFrameSize(max_frame_size)),
+          frame_size(std::min(INITIAL_FRAME_SIZE, this->max_frame_size)) {}
+
+std::size_t AdaptiveFrameSizer::frameSize() const {
+    return frame_size;
+}
+
+void AdaptiveFrameSizer::recordSend(std::size_t bytes, std::chrono::nanoseconds elapsed) {
+    if (elapsed.count() <= 0) {
+        frame_size = std::min(frame_size * 2, max_frame_size); // faster than the clock can tell
+        return;
+    }
+    double measured = static_cast<double>(bytes) / std::chrono::duration<double>(elapsed).count();
+    bytes_per_second = bytes_per_second == 0 ? measured
+                                             : SMOOTHING_FACTOR * measured + (1 - SMOOTHING_FACTOR) * bytes_per_second;
+    auto ideal_size = static_cast<std::size_t>(bytes_per_second *
+                                               std::chrono::duration<double>(TARGET_FRAME_DURATION).count());
+    frame_size = std::min(normalizeFrameSize(ideal_size), max_frame_size);
+}
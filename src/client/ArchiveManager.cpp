@@ -1,21 +1,21 @@
 #include "client/ArchiveManager.hpp"
 #include "Utils.hpp"
 #include "client/zstd.hpp"
+#include "FileReader.hpp"
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <optional>
 
-ArchiveManager::ArchiveManager(fs::path directory) : directory(std::move(directory)),
-                                                     progress_bar(indicators::option::BarWidth{40},
-                                                                  indicators::option::Start{"["},
-                                                                  indicators::option::Fill{"·"},
-                                                                  indicators::option::Lead{"<==>"},
-                                                                  indicators::option::End{"]"},
-                                                                  indicators::option::ForegroundColor{
-                                                                          indicators::Color::white},
-                                                                  indicators::option::FontStyles{
-                                                                          std::vector<indicators::FontStyle>{
-                                                                                  indicators::FontStyle::bold}}) {}
+
+ArchiveManager::ArchiveManager(fs::path directory, bool quiet)
+        : ArchiveManager(std::vector<fs::path>{directory}, quiet) {
+    this->directory = std::move(directory);
+}
+
+ArchiveManager::ArchiveManager(std::vector<fs::path> entries, bool quiet)
+        : entries(std::move(entries)), quiet(quiet) {}
 
 
 void ArchiveManager::unpackArchive(const fs::path &archive_path) {
@@ -28,32 +28,38 @@ void ArchiveManager::unpackArchive(const fs::path &archive_path) {
         throw ArchiveManagerException(
                 fmt::format("Given archive {} does not exists!", archive_path.string()));
     }
-    std::ifstream compressed_archive(archive_path, std::ios_base::binary);
+    FileReaderStream compressed_archive{archive_path};
     std::size_t archive_size = std::filesystem::file_size(archive_path);
 
-    progress_bar.set_option(indicators::option::PrefixText{"Unpacking... "});
-    while (getRemainingBytes(compressed_archive, archive_size) > 0) {
+    ProgressMeter progress{"Unpacking... ", archive_size, 0, quiet};
+    for (std::size_t remaining = archive_size; remaining > 0;) {
         FSEntryInfo entry_info = FSEntryInfo::readFromStream(compressed_archive, archive_size);
-        progress_bar.tick();
         if (entry_info.is_directory) {
             std::filesystem::create_directories(directory / entry_info.relative_path);
         } else {
             unpackFile(compressed_archive, entry_info);
         }
+        std::size_t left = getRemainingBytes(compressed_archive, archive_size);
+        progress.add(remaining - left);
+        remaining = left;
     }
 
-    progress_bar.set_option(indicators::option::PrefixText{"Unpacked. "});
-    progress_bar.mark_as_completed();
+    progress.finish("Unpacked. ");
 }
 
-void ArchiveManager::unpackFile(std::ifstream &compressed_archive, const FSEntryInfo &entry_info) {
+// Mapped archive is decompressed straight from its pages.
+void ArchiveManager::unpackFile(FileReaderStream &compressed_archive, const FSEntryInfo &entry_info) {
     std::ofstream decompressed_file{directory / entry_info.relative_path, std::ios::binary};
 
     if (!decompressed_file.is_open()) {
         throw ArchiveManagerException(
                 "Failed to open output decompressed_file: " + (directory / entry_info.relative_path).string());
     }
-    zstd::decompress(decompressed_file, compressed_archive, entry_info.compressed_length);
+    if (auto compressed = compressed_archive.take(entry_info.compressed_length)) {
+        zstd::decompress(decompressed_file, *compressed);
+    } else {
+        zstd::decompress(decompressed_file, compressed_archive, entry_info.compressed_length);
+    }
 }
 
 void ArchiveManager::createArchive(const fs::path &new_archive_path) {
@@ -62,27 +68,41 @@ void ArchiveManager::createArchive(const fs::path &new_archive_path) {
                 fmt::format("File that you try to unpackArchive to ({}) already exists!",
                             new_archive_path.string()));
     }
+    std::vector<fs::path> names;
+    for (const auto &entry: entries) {
+        if (!fs::exists(entry)) {
+            throw ArchiveManagerException(fmt::format("Given path {} does not exist!", entry.string()));
+        }
+        if (std::ranges::find(names, entry.filename()) != names.end()) {
+            throw ArchiveManagerException(fmt::format("More than one entry is named {}.", entry.filename().string()));
+        }
+        names.push_back(entry.filename());
+    }
     std::ofstream new_archive(new_archive_path, std::ios::binary | std::ios::trunc);
-    progress_bar.set_option(indicators::option::PrefixText{"Building archive... "});
+    ProgressMeter progress{"Building archive... ", 0, 0, quiet}; // of what is read, compressed size is not known yet
 
-    packDirectory(directory, new_archive, directory.filename());
+    for (const auto &entry: entries) {
+        if (fs::is_directory(entry)) {
+            packDirectory(entry, new_archive, progress, entry.filename());
+        } else {
+            addFile(entry, new_archive, progress, entry.filename());
+        }
+    }
 
-    progress_bar.set_option(indicators::option::PrefixText{"Archive built. "});
-    progress_bar.mark_as_completed();
+    progress.finish("Archive built. ");
 }
 
 void ArchiveManager::packDirectory(const fs::path &dir_to_compress, std::ofstream &new_archive,
-                                   const fs::path &relative_path) {
+                                   ProgressMeter &progress, const fs::path &relative_path) {
     addDirectory(new_archive, relative_path);
     for (const auto &dir_entry: fs::directory_iterator(dir_to_compress)) {
-        progress_bar.tick();
         const fs::path &current = dir_entry.path();
         fs::path new_relative = relative_path / current.filename();
 
         if (fs::is_directory(current)) {
-            packDirectory(current, new_archive, new_relative);
+            packDirectory(current, new_archive, progress, new_relative);
         } else if (fs::is_regular_file(current)) {
-            addFile(current, new_archive, new_relative);
+            addFile(current, new_archive, progress, new_relative);
         }
     }
 }
@@ -92,16 +112,18 @@ void ArchiveManager::addDirectory(std::ofstream &new_archive, const fs::path &re
     info.writeToStream(new_archive);
 }
 
-void ArchiveManager::addFile(const fs::path &file_path, std::ofstream &compressed_archive,
+void ArchiveManager::addFile(const fs::path &file_path, std::ofstream &compressed_archive, ProgressMeter &progress,
                              const fs::path &relative_path) {
     FSEntryInfo file_info{false, relative_path};
     auto pos_to_write_compressed_size = file_info.writeToStream(compressed_archive);
-    std::ifstream input_file{file_path, std::ios::binary};
-    if (!input_file.is_open()) {
+    std::optional<FileReaderStream> input_file;
+    try {
+        input_file.emplace(file_path);
+    } catch (const FileReaderException &) {
         throw ArchiveManagerException("Failed to open input file: " + file_path.string());
     }
-    std::size_t bytes_written = zstd::compress(input_file, compressed_archive, [&] {
-        progress_bar.tick();
+    std::size_t bytes_written = zstd::compress(*input_file, compressed_archive, [&](std::size_t read) {
+        progress.add(read);
     });
 
     file_info.writeCompressedLength(compressed_archive, pos_to_write_compressed_size, bytes_written);
@@ -0,0 +1,102 @@
+#include "client/ChunkVerifier.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+
+CorruptedChunkException::CorruptedChunkException(std::size_t chunk_begin)
+        : ChunkVerifierException(fmt::format("Chunk at byte {} does not match sender's hash.", chunk_begin)),
+          chunk_begin(chunk_begin) {}
+
+std::size_t CorruptedChunkException::chunkBegin() const {
+    return chunk_begin;
+}
+
+
+ChunkVerifier::ChunkVerifier(std::size_t file_size, std::size_t chunk_size, HashAlgorithm algorithm)
+        : file_size(file_size), chunk_size(chunk_size), algorithm(algorithm) {
+    MerkleTree::validateChunkSize(chunk_size);
+    expected_leaves.resize(MerkleTree::chunkCount(file_size, chunk_size));
+    received_leaves.resize(expected_leaves.size());
+}
+
+ChunkVerifier::RangeVerifier ChunkVerifier::verifyRange(ByteRange stripe, std::size_t offset,
+                                                        const std::filesystem::path &partial_path) {
+    return {*this, stripe, offset, partial_path};
+}
+
+std::string ChunkVerifier::root(const std::filesystem::path &partial_path) const {
+    std::vector<MerkleTree::Digest> leaves = received_leaves;
+    std::vector<std::size_t> missing;
+    for (std::size_t index = 0; index < leaves.size(); ++index) {
+        if (leaves[index].empty()) {
+            missing.push_back(index);
+        }
+    }
+    if (!missing.empty()) {
+        auto missing_leaves = MerkleTree::hashChunks(partial_path, chunk_size, missing, algorithm);
+        for (std::size_t i = 0; i < missing.size(); ++i) {
+            leaves[missing[i]] = std::move(missing_leaves[i]);
+        }
+    }
+    return MerkleTree{chunk_size, std::move(leaves), algorithm}.root();
+}
+
+std::string ChunkVerifier::expectedRoot() const {
+    if (std::ranges::any_of(expected_leaves, [](const auto &leaf) { return leaf.empty(); })) {
+        throw ChunkVerifierException("Not all chunk hashes have been received.");
+    }
+    return MerkleTree{chunk_size, expected_leaves, algorithm}.root();
+}
+
+void ChunkVerifier::verifyChunk(std::size_t chunk_index) const {
+    const auto &expected = expected_leaves[chunk_index];
+    const auto &received = received_leaves[chunk_index];
+    if (!expected.empty() && !received.empty() && expected != received) {
+        throw CorruptedChunkException(chunk_index * chunk_size);
+    }
+}
+
+
+// Resumed stripe may begin in the middle of a chunk, its first part is then hashed from what is already on disk.
+ChunkVerifier::RangeVerifier::RangeVerifier(ChunkVerifier &verifier, ByteRange stripe, std::size_t offset,
+                                            const std::filesystem::path &partial_path)
+        : verifier(verifier), leaves(MerkleTree::leavesOf(stripe, verifier.file_size, verifier.chunk_size)),
+          received_chunks(MerkleTree::chunksOf({offset, stripe.end}, verifier.chunk_size)),
+          hasher(partial_path, verifier.file_size, verifier.chunk_size, {offset, stripe.end}, verifier.algorithm) {}
+
+void ChunkVerifier::RangeVerifier::update(std::string_view data) {
+    hasher.update(data, [this](std::size_t chunk_index, MerkleTree::Digest leaf) {
+        std::lock_guard lock{verifier.m};
+        verifier.received_leaves[chunk_index] = std::move(leaf);
+        ++received_count;
+        verifier.verifyChunk(chunk_index);
+    });
+}
+
+void ChunkVerifier::RangeVerifier::addExpectedLeaves(const ChunkHashes &hashes) {
+    std::size_t count = hashes.digests.size() / MerkleTree::DIGEST_SIZE;
+    if (hashes.digests.size() % MerkleTree::DIGEST_SIZE != 0 || count == 0 ||
+        !leaves.contains(hashes.first_chunk) || count > leaves.end - hashes.first_chunk) {
+        throw ChunkVerifierException(fmt::format("Received malformed hashes of chunks from {} ({} bytes).",
+                                                 hashes.first_chunk, hashes.digests.size()));
+    }
+    std::lock_guard lock{verifier.m};
+    for (std::size_t index = hashes.first_chunk; index < hashes.first_chunk + count; ++index) {
+        auto &leaf = verifier.expected_leaves[index];
+        if (leaf.empty()) {
+            ++expected_count;
+        }
+        leaf = hashes.digests.substr((index - hashes.first_chunk) * MerkleTree::DIGEST_SIZE, MerkleTree::DIGEST_SIZE);
+        verifier.verifyChunk(index);
+    }
+}
+
+bool ChunkVerifier::RangeVerifier::isComplete() const {
+    return hasExpectedLeaves() && received_count == received_chunks.size();
+}
+
+bool ChunkVerifier::RangeVerifier::hasExpectedLeaves() const {
+    return expected_count == leaves.size();
+}
@@ -1,8 +1,13 @@
 #include "client/ClientArgParser.hpp"
+#include "client/ReconnectPolicy.hpp"
+#include "Hasher.hpp"
+#include "Striping.hpp"
 
 #include <argparse/argparse.hpp>
 #include <fmt/format.h>
 
+#include <algorithm>
+
 void removeTrailingSlashes(std::string &file_or_code);
 
 ClientArgs parseClientArgs(int argc, char **argv) {
@@ -21,9 +26,10 @@ ClientArgs parseClientArgs(int argc, char **argv) {
             });
 
     program.add_argument("file_or_code")
-            .nargs(1)
+            .nargs(argparse::nargs_pattern::at_least_one)
             .required()
-            .help("Either path to file to send or code words to receive file.");
+            .help("Either paths to files or directories to send (all go in one transfer), "
+                  "'-' to send what is piped to standard input, or code words to receive them.");
 
     program.add_argument("-p", "--port")
             .default_value(std::uint16_t{8080})
@@ -40,6 +46,68 @@ ClientArgs parseClientArgs(int argc, char **argv) {
             .help("Boolean arg specifying whether client should verify server's cert. "
                   "Set to false to allow self signed certs. Only for self-hosted. Use with caution.");
 
+    program.add_argument("-y", "--yes")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Receive without asking for confirmation. Saves a round trip before the transfer starts.");
+
+    program.add_argument("-r", "--reconnect_attempts")
+            .default_value(ReconnectPolicy::DEFAULT_MAX_ATTEMPTS)
+            .scan<'u', std::size_t>()
+            .help("How many times to reconnect and resume a transfer after the connection is lost. 0 disables it.");
+
+    program.add_argument("-s", "--streams")
+            .default_value(std::size_t{1})
+            .scan<'u', std::size_t>()
+            .help(fmt::format("Number of parallel connections the file is striped across when sending, 1 to {}.",
+                              MAX_STREAMS));
+
+    program.add_argument("--hash")
+            .default_value(std::string{toString(DEFAULT_HASH_ALGORITHM)})
+            .help("Hash function the receiver checks the sent file with: blake2b or sha256 (slower, for old receivers).");
+
+    program.add_argument("--direct")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Let the receiver connect straight to this client when on the same network, "
+                  "the server then relays only if that fails. Single stream only.");
+
+    program.add_argument("--congestion_control")
+            .default_value(std::string{})
+            .help("TCP congestion control of the connections carrying data, e.g. bbr. "
+                  "Kernel's default when empty or not allowed.");
+
+    program.add_argument("--limit_rate")
+            .default_value(std::size_t{0})
+            .scan<'u', std::size_t>()
+            .help("Maximum sending rate in KiB/s, paced smoothly. 0 means no limit.");
+
+    program.add_argument("--zero_copy")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Let the kernel encrypt and send the file straight from disk (kernel TLS and sendfile), "
+                  "falls back to sending from user space when it cannot.");
+
+    program.add_argument("--direct_io")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Write the received file with O_DIRECT, bypassing the page cache. Falls back to buffered writes "
+                  "when the file system does not support it.");
+
+    program.add_argument("-o", "--output")
+            .default_value(std::string{})
+            .help("'-' writes received data to standard output instead of the current directory, "
+                  "piped data as it comes.");
+
+    program.add_argument("-q", "--quiet")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Do not draw progress, e.g. in scripts.");
+
+    program.add_argument("--stats")
+            .nargs(0, 1)
+            .help("When done, report wall time, bytes, throughput, CPU time and peak RSS of every phase "
+                  "of the transfer to standard error: as a table, or as JSON with --stats=json.");
 
     try {
         program.parse_args(argc, argv);
@@ -50,23 +118,73 @@ ClientArgs parseClientArgs(int argc, char **argv) {
     }
 
     auto action = program.get<std::string>("action");
-    auto file_or_code = program.get<std::string>("file_or_code");
+    auto files_or_code = program.get<std::vector<std::string>>("file_or_code");
+    auto streams = program.get<std::size_t>("-s");
+    if (streams == 0 || streams > MAX_STREAMS) {
+        throw ClientArgParserException(fmt::format("Streams count must be between 1 and {}, got {}.", MAX_STREAMS,
+                                                   streams));
+    }
+    auto hash_algorithm = parseHashAlgorithm(program.get<std::string>("--hash"));
+    if (!hash_algorithm) {
+        throw ClientArgParserException(fmt::format("Unknown hash algorithm {}, expected blake2b or sha256.",
+                                                   program.get<std::string>("--hash")));
+    }
+    if (program.get<bool>("--direct") && streams > 1) {
+        throw ClientArgParserException("Direct transfer goes over a single stream, drop --streams or --direct.");
+    }
+    TuningProfile tuning_profile{.congestion_control = program.get<std::string>("--congestion_control")};
+    std::optional<StatsFormat> stats;
+    if (program.is_used("--stats")) {
+        auto format = program.present<std::string>("--stats").value_or(std::string{toString(StatsFormat::text)});
+        stats = parseStatsFormat(format);
+        if (!stats) {
+            throw ClientArgParserException(fmt::format("Unknown stats format {}, expected text or json.", format));
+        }
+    }
 
 
 
     if (action == "send") {
-        removeTrailingSlashes(file_or_code);
+        std::ranges::for_each(files_or_code, removeTrailingSlashes);
+        if (std::ranges::find(files_or_code, ClientArgs::STANDARD_STREAM) != files_or_code.end() &&
+            (files_or_code.size() > 1 || streams > 1)) {
+            throw ClientArgParserException("Standard input is sent alone, over a single stream.");
+        }
         return {.action = Action::send,
-                .file_to_send_path = file_or_code,
+                .files_to_send = std::move(files_or_code),
                 .port = program.get<unsigned short>("-p"),
                 .server_domain_name = program.get<std::string>("-d"),
-                .verify_cert = !program.get<bool>("-a")};
+                .verify_cert = !program.get<bool>("-a"),
+                .reconnect_attempts = program.get<std::size_t>("-r"),
+                .streams = streams,
+                .hash_algorithm = *hash_algorithm,
+                .direct = program.get<bool>("--direct"),
+                .tuning_profile = std::move(tuning_profile),
+                .rate_limit = program.get<std::size_t>("--limit_rate") * 1024,
+                .zero_copy = program.get<bool>("--zero_copy"),
+                .quiet = program.get<bool>("-q"),
+                .stats = stats};
     } else {
+        if (files_or_code.size() != 1) {
+            throw ClientArgParserException(fmt::format("Expected a single receive code, got {}.", files_or_code.size()));
+        }
+        auto output = program.get<std::string>("-o");
+        if (!output.empty() && output != ClientArgs::STANDARD_STREAM) {
+            throw ClientArgParserException(fmt::format("Output can only be '{}' (standard output), got {}.",
+                                                       ClientArgs::STANDARD_STREAM, output));
+        }
         return {.action = Action::receive,
-                .receive_code = file_or_code,
+                .receive_code = files_or_code.front(),
                 .port = program.get<unsigned short>("-p"),
                 .server_domain_name = program.get<std::string>("-d"),
-                .verify_cert = !program.get<bool>("-a")};
+                .verify_cert = !program.get<bool>("-a"),
+                .auto_accept = program.get<bool>("-y"),
+                .reconnect_attempts = program.get<std::size_t>("-r"),
+                .tuning_profile = std::move(tuning_profile),
+                .direct_io = program.get<bool>("--direct_io"),
+                .to_stdout = output == ClientArgs::STANDARD_STREAM,
+                .quiet = program.get<bool>("-q"),
+                .stats = stats};
     }
 }
 
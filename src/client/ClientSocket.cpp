@@ -1,33 +1,59 @@
 #include "client/ClientSocket.hpp"
+#include "client/DirectLink.hpp"
 
 #include <spdlog/spdlog.h>
+#include <boost/lexical_cast.hpp>
 
-ClientSocket::ClientSocket(const std::string &host, unsigned short port, bool verify_cert) : ClientSocket(
-        std::make_unique<boost::asio::io_context>(),
-        boost::asio::ssl::context{
-                boost::asio::ssl::context::tls}) {
-    if (verify_cert) {
-        context.set_default_verify_paths();
-        socket_.set_verify_mode(boost::asio::ssl::verify_peer);
-        socket_.set_verify_callback([this](bool preverified, boost::asio::ssl::verify_context &ctx) {
-            return verify_certificate(preverified, ctx);
-        });
-    } else {
-        spdlog::warn("Skipping cert verification.");
-        context.set_verify_mode(boost::asio::ssl::verify_fail_if_no_peer_cert);
-        socket_.set_verify_callback([](bool, boost::asio::ssl::verify_context &) {
-            return true;
-        });
+#include <functional>
+#include <optional>
+
+using boost::system::error_code;
+
+
+std::vector<tcp::endpoint> interleaveAddressFamilies(const std::vector<tcp::endpoint> &endpoints) {
+    std::vector<tcp::endpoint> first_family;
+    std::vector<tcp::endpoint> other_family;
+    for (const auto &endpoint: endpoints) {
+        (endpoint.protocol() == endpoints.front().protocol() ? first_family : other_family).push_back(endpoint);
+    }
+    std::vector<tcp::endpoint> interleaved;
+    for (std::size_t i = 0; i < std::max(first_family.size(), other_family.size()); ++i) {
+        for (const auto *family: {&first_family, &other_family}) {
+            if (i < family->size()) {
+                interleaved.push_back((*family)[i]);
+            }
+        }
     }
+    return interleaved;
+}
 
+template<class Stream_t>
+ClientSocket<Stream_t>::ClientSocket(const std::string &host, unsigned short port, bool verify_cert) : ClientSocket(
+        std::make_unique<boost::asio::io_context>(),
+        StreamPolicy<Stream_t>::createClientContext()) {
+    this->verify_cert = verify_cert;
+    setUpCertVerification(verify_cert);
     connect(host, port);
     start();
 }
 
-ClientSocket::ClientSocket(std::unique_ptr<boost::asio::io_context> io_context, boost::asio::ssl::context context)
-        : SocketBase({*io_context, context}), io_context(std::move(io_context)), context(std::move(context)) {}
+template<class Stream_t>
+ClientSocket<Stream_t>::ClientSocket(tcp::socket connected, Context context)
+        : ClientSocket(std::make_unique<boost::asio::io_context>(), std::move(context)) {
+    auto protocol = connected.local_endpoint().protocol();
+    this->socket_.lowest_layer().assign(protocol, connected.release());
+    this->socket_.lowest_layer().set_option(tcp::no_delay(true));
+    start();
+}
+
+template<class Stream_t>
+ClientSocket<Stream_t>::ClientSocket(std::unique_ptr<boost::asio::io_context> io_context, Context context)
+        : IoContextHolder{std::move(io_context)},
+          SocketBase<Stream_t>(StreamPolicy<Stream_t>::createStream(*IoContextHolder::io_context, context)),
+          context(std::move(context)) {}
 
-ClientSocket::~ClientSocket() {
+template<class Stream_t>
+ClientSocket<Stream_t>::~ClientSocket() {
     if (io_context) {
         io_context->stop();
         if (context_thread.joinable()) {
@@ -36,28 +62,197 @@ ClientSocket::~ClientSocket() {
     }
 }
 
-void ClientSocket::connect(const std::string &host, unsigned short port) {
+template<class Stream_t>
+void ClientSocket<Stream_t>::setUpCertVerification(bool verify_cert) {
+    if constexpr (StreamPolicy<Stream_t>::IS_ENCRYPTED) {
+        if (verify_cert) {
+            context.set_default_verify_paths();
+        } else {
+            spdlog::warn("Skipping cert verification.");
+            context.set_verify_mode(boost::asio::ssl::verify_fail_if_no_peer_cert);
+        }
+    } else {
+        spdlog::warn("Using plaintext transport, nothing is encrypted.");
+    }
+}
+
+// Every racing connection has a stream of its own, so each of them checks the server's certificate.
+template<class Stream_t>
+void ClientSocket<Stream_t>::verifyCertificateOf(Stream_t &stream) {
+    if constexpr (StreamPolicy<Stream_t>::IS_ENCRYPTED) {
+        if (verify_cert) {
+            stream.set_verify_mode(boost::asio::ssl::verify_peer);
+            stream.set_verify_callback([this](bool preverified, boost::asio::ssl::verify_context &ctx) {
+                return verify_certificate(preverified, ctx);
+            });
+        } else {
+            stream.set_verify_callback([](bool, boost::asio::ssl::verify_context &) {
+                return true;
+            });
+        }
+    }
+}
+
+// Racing streams live on the socket's io_context, so that the winner can be moved into place.
+// All the handlers have run by the time io_context runs out of work, the losers have been closed by then.
+template<class Stream_t>
+void ClientSocket<Stream_t>::connect(const std::string &host, unsigned short port) {
+    using Clock = std::chrono::steady_clock;
     spdlog::debug("Connecting to the endpoint: {}:{}", host, port);
-    tcp::resolver resolver(socket_.get_executor());
-    auto endpoints = resolver.resolve(host, std::to_string(port));
+    this->host = host;
+    this->port = port;
+    connect_timings = {};
+    auto resolve_start = Clock::now();
+    tcp::resolver resolver(*io_context);
+    auto resolved = resolver.resolve(host, std::to_string(port));
+    connect_timings.dns = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - resolve_start);
+    std::vector<tcp::endpoint> endpoints = interleaveAddressFamilies({resolved.begin(), resolved.end()});
     if (endpoints.empty()) {
         throw SocketException(fmt::format("Did not find {}:{}", host, port));
     }
-    socket_.lowest_layer().connect(*endpoints.begin());
-    socket_.handshake(boost::asio::ssl::stream_base::client);
-    spdlog::debug("Connected to the endpoint {}:{}.", host, port);
+
+    struct Attempt {
+        Stream_t stream;
+        Clock::time_point started;
+        Clock::time_point connected{};
+    };
+    std::vector<std::unique_ptr<Attempt>> attempts;
+    std::optional<std::size_t> winner;
+    error_code last_error;
+    boost::asio::steady_timer next_attempt_timer{*io_context};
+    std::function<void()> start_next_attempt;
+    auto on_failure = [&](std::size_t index, const error_code &ec) {
+        spdlog::debug("Connecting to {} failed: {}", boost::lexical_cast<std::string>(endpoints[index]), ec.message());
+        last_error = ec;
+        start_next_attempt();
+    };
+    start_next_attempt = [&] {
+        if (winner || attempts.size() == endpoints.size()) {
+            return;
+        }
+        std::size_t index = attempts.size();
+        auto &attempt = *attempts.emplace_back(std::make_unique<Attempt>(
+                Attempt{StreamPolicy<Stream_t>::createStream(*io_context, context), Clock::now()}));
+        verifyCertificateOf(attempt.stream);
+        attempt.stream.lowest_layer().async_connect(endpoints[index], [&, index](const error_code &ec) {
+            if (winner) {
+                return;
+            }
+            if (ec) {
+                on_failure(index, ec);
+                return;
+            }
+            Attempt &connected = *attempts[index];
+            connected.connected = Clock::now();
+            error_code ignored;
+            // Setup frames are small and pipelined, Nagle's algorithm would hold them back for a round trip.
+            connected.stream.lowest_layer().set_option(tcp::no_delay(true), ignored);
+            StreamPolicy<Stream_t>::asyncHandshake(connected.stream, boost::asio::ssl::stream_base::client,
+                                                   [&, index](const error_code &ec) {
+                if (winner) {
+                    return;
+                }
+                if (ec) {
+                    on_failure(index, ec);
+                    return;
+                }
+                winner = index;
+                next_attempt_timer.cancel();
+                for (std::size_t other = 0; other < attempts.size(); ++other) {
+                    if (other != index) {
+                        error_code ignored_close;
+                        attempts[other]->stream.lowest_layer().close(ignored_close);
+                    }
+                }
+            });
+        });
+        if (attempts.size() < endpoints.size()) {
+            next_attempt_timer.expires_after(CONNECTION_ATTEMPT_DELAY);
+            next_attempt_timer.async_wait([&](const error_code &ec) {
+                if (!ec) {
+                    start_next_attempt();
+                }
+            });
+        }
+    };
+    start_next_attempt();
+    io_context->restart();
+    io_context->run();
+    if (!winner) {
+        boost::throw_exception(boost::system::system_error{last_error, "connect"});
+    }
+
+    const Attempt &won = *attempts[*winner];
+    connect_timings.tcp = std::chrono::duration_cast<std::chrono::microseconds>(won.connected - won.started);
+    connect_timings.tls = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - won.connected);
+    connect_timings.attempts = attempts.size();
+    this->socket_ = std::move(attempts[*winner]->stream);
+    auto milliseconds = [](std::chrono::microseconds duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    spdlog::debug("Connected to the endpoint {}:{} ({}) after {} attempt(s): DNS {:.1f} ms, TCP {:.1f} ms, TLS {:.1f} ms.",
+                  host, port, boost::lexical_cast<std::string>(endpoints[*winner]), connect_timings.attempts,
+                  milliseconds(connect_timings.dns), milliseconds(connect_timings.tcp),
+                  milliseconds(connect_timings.tls));
+}
+
+template<class Stream_t>
+const ConnectTimings &ClientSocket<Stream_t>::connectTimings() const {
+    return connect_timings;
 }
 
-void ClientSocket::start() {
+template<class Stream_t>
+void ClientSocket<Stream_t>::reconnect() {
+    this->close();
+    this->socket_ = StreamPolicy<Stream_t>::createStream(*io_context, context);
+    this->resetConnectionState();
+    connect(host, port);
+}
+
+template<class Stream_t>
+ClientSocket<Stream_t> ClientSocket<Stream_t>::connectAnother() const {
+    return {host, port, verify_cert};
+}
+
+template<class Stream_t>
+void ClientSocket<Stream_t>::requestFramedProtocol(std::size_t frame_size_limit) {
+    this->requested_frame_size = normalizeFrameSize(frame_size_limit);
+    HelloBuffer hello = encodeHello(Hello{.max_frame_size = this->requested_frame_size});
+    this->write({hello.data(), hello.size()});
+    this->protocol = WireProtocol::framed;
+    this->awaiting_hello = true;
+}
+
+template<class Stream_t>
+void ClientSocket<Stream_t>::handshakeWithPeer(HandshakeType type, const std::string &peer_fingerprint) {
+    if constexpr (StreamPolicy<Stream_t>::IS_ENCRYPTED) {
+        if (type == boost::asio::ssl::stream_base::client) {
+            this->socket_.set_verify_mode(boost::asio::ssl::verify_peer);
+            this->socket_.set_verify_callback([peer_fingerprint](bool, boost::asio::ssl::verify_context &ctx) {
+                X509 *cert = X509_STORE_CTX_get_current_cert(ctx.native_handle());
+                return X509_STORE_CTX_get_error_depth(ctx.native_handle()) > 0 ||
+                       (!peer_fingerprint.empty() && certificateFingerprint(cert) == peer_fingerprint);
+            });
+        }
+    }
+    StreamPolicy<Stream_t>::handshake(this->socket_, type);
+}
+
+template<class Stream_t>
+void ClientSocket<Stream_t>::start() {
     context_thread = std::jthread{[io_context_ptr = io_context.get()] {
         io_context_ptr->run();
     }};
 }
 
-bool ClientSocket::verify_certificate(bool preverified, boost::asio::ssl::verify_context &ctx) {
+template<class Stream_t>
+bool ClientSocket<Stream_t>::verify_certificate(bool preverified, boost::asio::ssl::verify_context &ctx) {
     char subject_name[256];
     X509 *cert = X509_STORE_CTX_get_current_cert(ctx.native_handle());
     X509_NAME_oneline(X509_get_subject_name(cert), subject_name, sizeof(subject_name));
     spdlog::debug("Preverified {}, verifying {}", preverified, subject_name);
     return preverified;
 }
+
+template class ClientSocket<TlsStream>;
+template class ClientSocket<PlainStream>;
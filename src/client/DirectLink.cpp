@@ -0,0 +1,240 @@
+#include "client/DirectLink.hpp"
+#include "DropFileBaseException.hpp"
+#include "Utils.hpp"
+
+#include <spdlog/spdlog.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+
+#include <ifaddrs.h>
+#include <net/if.h>
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+namespace {
+    class DirectLinkException: public DropFileBaseException {
+    public:
+        using DropFileBaseException::DropFileBaseException;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t SESSION_KEY_SIZE{16};
+    constexpr long CERTIFICATE_VALIDITY{24 * 60 * 60}; // seconds, the certificate lives only as long as the sender
+    constexpr long CERTIFICATE_CLOCK_SKEW{60 * 60};
+
+    // Shuts the socket down unless the link is set up in time, which makes the blocking calls on it fail.
+    template<class Stream_t>
+    class SetupDeadline {
+    public:
+        SetupDeadline(ClientSocket<Stream_t> &socket, Clock::time_point deadline)
+                : watchdog([&socket, deadline](std::stop_token stop_token) {
+            std::mutex mutex;
+            std::condition_variable_any stopped;
+            std::unique_lock lock{mutex};
+            stopped.wait_until(lock, stop_token, deadline, [] { return false; });
+            if (!stop_token.stop_requested()) {
+                socket.shutdown();
+            }
+        }) {}
+    private:
+        std::jthread watchdog;
+    };
+
+    std::string randomSessionKey() {
+        std::array<unsigned char, SESSION_KEY_SIZE> key{};
+        if (RAND_bytes(key.data(), static_cast<int>(key.size())) != 1) {
+            throw DirectLinkException("Could not generate session key for direct connection.");
+        }
+        return binaryToHumanReadable({reinterpret_cast<const char *>(key.data()), key.size()});
+    }
+
+    bool isSessionKey(std::string_view received, const std::string &session_key) {
+        return received.size() == session_key.size() &&
+               CRYPTO_memcmp(received.data(), session_key.data(), session_key.size()) == 0;
+    }
+
+    // Receiver pins the certificate by its fingerprint, so it needs no name nor issuer it could check.
+    template<class Stream_t>
+    typename StreamPolicy<Stream_t>::Context createListenerContext(std::string &certificate_fingerprint) {
+        if constexpr (StreamPolicy<Stream_t>::IS_ENCRYPTED) {
+            std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key{EVP_EC_gen("P-256"), &EVP_PKEY_free};
+            std::unique_ptr<X509, decltype(&X509_free)> certificate{X509_new(), &X509_free};
+            if (!key || !certificate) {
+                throw DirectLinkException("Could not generate certificate for direct connection.");
+            }
+            X509_set_version(certificate.get(), 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 1);
+            X509_gmtime_adj(X509_getm_notBefore(certificate.get()), -CERTIFICATE_CLOCK_SKEW);
+            X509_gmtime_adj(X509_getm_notAfter(certificate.get()), CERTIFICATE_VALIDITY);
+            X509_NAME *name = X509_get_subject_name(certificate.get());
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("drop-file"),
+                                       -1, -1, 0);
+            X509_set_issuer_name(certificate.get(), name);
+            X509_set_pubkey(certificate.get(), key.get());
+            if (X509_sign(certificate.get(), key.get(), EVP_sha256()) == 0) {
+                throw DirectLinkException("Could not sign certificate for direct connection.");
+            }
+            boost::asio::ssl::context context{boost::asio::ssl::context::tls_server};
+            if (SSL_CTX_use_certificate(context.native_handle(), certificate.get()) != 1 ||
+                SSL_CTX_use_PrivateKey(context.native_handle(), key.get()) != 1) {
+                throw DirectLinkException("Could not use certificate for direct connection.");
+            }
+            certificate_fingerprint = certificateFingerprint(certificate.get());
+            return context;
+        } else {
+            return {};
+        }
+    }
+}
+
+
+template<class Stream_t>
+DirectListener<Stream_t>::DirectListener()
+        : acceptor(io_context), context(createListenerContext<Stream_t>(direct_offer.certificate_fingerprint)) {
+    boost::system::error_code ec;
+    tcp::endpoint any_address{tcp::v4(), 0};
+    acceptor.open(any_address.protocol(), ec);
+    if (!ec) {
+        acceptor.bind(any_address, ec);
+    }
+    if (!ec) {
+        acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+    }
+    if (ec) {
+        throw DirectLinkException(fmt::format("Could not listen for direct connection: {}", ec.message()));
+    }
+    direct_offer.addresses = localAddresses();
+    direct_offer.port = acceptor.local_endpoint().port();
+    direct_offer.session_key = randomSessionKey();
+}
+
+template<class Stream_t>
+const DirectOffer &DirectListener<Stream_t>::offer() const {
+    return direct_offer;
+}
+
+// Listener is good for a single connection, its certificate goes with it.
+template<class Stream_t>
+std::optional<ClientSocket<Stream_t>> DirectListener<Stream_t>::accept(std::chrono::milliseconds timeout) {
+    auto deadline = Clock::now() + timeout;
+    tcp::socket connected{io_context};
+    boost::system::error_code accept_error{boost::asio::error::timed_out};
+    acceptor.async_accept(connected, [&accept_error](const boost::system::error_code &ec) {
+        accept_error = ec;
+    });
+    io_context.restart();
+    if (io_context.run_until(deadline) == 0) {
+        acceptor.cancel();
+        io_context.run();
+    }
+    if (accept_error) {
+        spdlog::info("Other client has not connected directly: {}", accept_error.message());
+        return std::nullopt;
+    }
+    try {
+        ClientSocket<Stream_t> peer{std::move(connected), std::move(context)};
+        {
+            SetupDeadline<Stream_t> setup_deadline{peer, deadline};
+            peer.handshakeWithPeer(boost::asio::ssl::stream_base::server);
+            peer.requestFramedProtocol();
+            Frame frame = peer.receiveFrame();
+            if (frame.type != FrameType::metadata || !isSessionKey(frame.payload, direct_offer.session_key)) {
+                spdlog::warn("Client connected directly without the session key, ignoring it.");
+                return std::nullopt;
+            }
+            peer.sendACK();
+        }
+        return peer;
+    } catch (const boost::system::system_error &e) {
+        spdlog::info("Could not set up direct connection: {}", e.what());
+    } catch (const DropFileBaseException &e) {
+        spdlog::info("Could not set up direct connection: {}", e.what());
+    }
+    return std::nullopt;
+}
+
+template<class Stream_t>
+std::optional<ClientSocket<Stream_t>> connectDirectly(const DirectOffer &offer, std::chrono::milliseconds timeout) {
+    auto deadline = Clock::now() + timeout;
+    boost::asio::io_context io_context;
+    for (const auto &address: offer.addresses) {
+        boost::system::error_code ec;
+        auto ip = boost::asio::ip::make_address(address, ec);
+        if (ec) {
+            spdlog::debug("Skipping invalid direct address {}.", address);
+            continue;
+        }
+        tcp::socket connected{io_context};
+        boost::system::error_code connect_error{boost::asio::error::timed_out};
+        connected.async_connect({ip, offer.port}, [&connect_error](const boost::system::error_code &ec) {
+            connect_error = ec;
+        });
+        io_context.restart();
+        if (io_context.run_until(deadline) == 0) {
+            connected.close();
+            io_context.run();
+        }
+        if (connect_error) {
+            spdlog::debug("Could not connect directly to {}:{}: {}", address, offer.port, connect_error.message());
+            continue;
+        }
+        try {
+            ClientSocket<Stream_t> peer{std::move(connected), StreamPolicy<Stream_t>::createClientContext()};
+            {
+                SetupDeadline<Stream_t> setup_deadline{peer, deadline};
+                peer.handshakeWithPeer(boost::asio::ssl::stream_base::client, offer.certificate_fingerprint);
+                peer.requestFramedProtocol();
+                peer.sendFrame(FrameType::metadata, offer.session_key);
+                peer.receiveACK();
+            }
+            spdlog::debug("Connected directly to {}:{}.", address, offer.port);
+            return peer;
+        } catch (const boost::system::system_error &e) {
+            spdlog::debug("Could not set up direct connection with {}:{}: {}", address, offer.port, e.what());
+        } catch (const DropFileBaseException &e) {
+            spdlog::debug("Could not set up direct connection with {}:{}: {}", address, offer.port, e.what());
+        }
+    }
+    return std::nullopt;
+}
+
+// Loopback goes last, it leads to the sender only when both clients run on the same host.
+std::vector<std::string> localAddresses() {
+    std::vector<std::string> addresses;
+    ifaddrs *interfaces{nullptr};
+    if (getifaddrs(&interfaces) == 0) {
+        for (ifaddrs *interface = interfaces; interface != nullptr; interface = interface->ifa_next) {
+            if (interface->ifa_addr == nullptr || interface->ifa_addr->sa_family != AF_INET ||
+                (interface->ifa_flags & IFF_UP) == 0 || (interface->ifa_flags & IFF_LOOPBACK) != 0) {
+                continue;
+            }
+            auto *address = reinterpret_cast<sockaddr_in *>(interface->ifa_addr);
+            addresses.push_back(boost::asio::ip::address_v4{ntohl(address->sin_addr.s_addr)}.to_string());
+        }
+        freeifaddrs(interfaces);
+    }
+    addresses.resize(std::min(addresses.size(), InitSessionMessage::MAX_DIRECT_ADDRESSES - 1));
+    addresses.push_back(boost::asio::ip::address_v4::loopback().to_string());
+    return addresses;
+}
+
+std::string certificateFingerprint(X509 *certificate) {
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    unsigned int size{0};
+    if (certificate == nullptr || X509_digest(certificate, EVP_sha256(), digest.data(), &size) != 1) {
+        return {};
+    }
+    return binaryToHumanReadable({reinterpret_cast<const char *>(digest.data()), size});
+}
+
+template class DirectListener<TlsStream>;
+template class DirectListener<PlainStream>;
+template std::optional<ClientSocket<TlsStream>> connectDirectly(const DirectOffer &, std::chrono::milliseconds);
+template std::optional<ClientSocket<PlainStream>> connectDirectly(const DirectOffer &, std::chrono::milliseconds);
@@ -1,116 +1,591 @@
 #include "client/DropFileReceiveClient.hpp"
 #include "InitSessionMessage.hpp"
 #include "client/ArchiveManager.hpp"
+#include "client/BoundedQueue.hpp"
+#include "client/ProgressMeter.hpp"
+#include "client/RangeWriter.hpp"
 #include "Utils.hpp"
 
 #include <spdlog/spdlog.h>
+#include <fmt/ranges.h>
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <future>
+#include <utility>
 
-DropFileReceiveClient::DropFileReceiveClient(ClientSocket socket, std::istream &interaction_stream) : socket(
-        std::move(socket)), interaction_stream(interaction_stream) {
-    std::filesystem::remove_all(DROP_FILE_RECEIVER_TMP_DIR);
-    std::filesystem::create_directories(DROP_FILE_RECEIVER_TMP_DIR);
+
+template<class Stream_t>
+DropFileReceiveClient<Stream_t>::DropFileReceiveClient(ClientSocket<Stream_t> socket,
+                                                       std::istream &interaction_stream, bool auto_accept,
+                                                       ReconnectPolicy reconnect_policy,
+                                                       TuningProfile tuning_profile, bool direct_io,
+                                                       std::ostream *output, bool quiet, TransferStats *stats)
+        : socket(std::move(socket)), interaction_stream(interaction_stream), auto_accept(auto_accept),
+          reconnect_policy(reconnect_policy), tuning_profile(std::move(tuning_profile)), direct_io(direct_io),
+          output(output), quiet(quiet), stats(stats) {
+    this->socket.requestFramedProtocol();
+    std::filesystem::create_directories(DROP_FILE_RECEIVER_PARTIAL_DIR);
 }
 
-DropFileReceiveClient::~DropFileReceiveClient() {
-    std::filesystem::remove_all(DROP_FILE_RECEIVER_TMP_DIR);
+// Server refuses to resume until the sender has come back, so while reconnecting that is retried too.
+// Corrupted chunk is requested again the same way, the checkpoint then ends right before it.
+// Piped data cannot be requested again, so it is not.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receiveFile(const std::string &code_words) {
+    ReconnectBackoff backoff{reconnect_policy};
+    bool reconnecting{false};
+    while (true) {
+        try {
+            if (reconnecting) {
+                TransferStats::Measurement connect{stats, TransferStats::CONNECT};
+                socket.reconnect();
+                socket.requestFramedProtocol();
+            }
+            nlohmann::json server_response = requestTransfer(code_words);
+            if (reconnecting) {
+                backoff.reset();
+                reconnecting = false;
+            }
+            receiveTransfer(code_words, server_response);
+            return;
+        } catch (const boost::system::system_error &e) {
+            if (!transfer_started || receives_pipe || !backoff.waitForNextAttempt(e.what())) {
+                throw;
+            }
+        } catch (const CorruptedChunkException &e) {
+            if (!backoff.waitForNextAttempt(e.what())) {
+                throw DropFileReceiveException(e.what());
+            }
+        } catch (const DropFileReceiveException &e) {
+            if (!reconnecting || !backoff.waitForNextAttempt(e.what())) {
+                throw;
+            }
+        }
+        reconnecting = true;
+    }
 }
 
-void DropFileReceiveClient::receiveFile(const std::string &code_words) {
-    nlohmann::json message_json = InitSessionMessage::createReceiveMessage(code_words);
+// Once the user has agreed to the transfer, resuming it does not ask again.
+template<class Stream_t>
+nlohmann::json DropFileReceiveClient<Stream_t>::requestTransfer(const std::string &code_words) {
+    bool accepted_in_advance = auto_accept || transfer_started;
+    nlohmann::json message_json = InitSessionMessage::createReceiveMessage(code_words, accepted_in_advance);
+    auto checkpoint_path = checkpointPath(code_words);
+    checkpoint = checkpoint_path ? ResumeCheckpoint::load(*checkpoint_path) : std::nullopt;
+    if (checkpoint) {
+        InitSessionMessage::setResumePoint(message_json, checkpoint->offset, checkpoint->file_id);
+    }
     std::cout << "Requesting server for file metadata..." << std::endl;
-    socket.SocketBase::send(message_json.dump());
+    socket.sendFrame(FrameType::metadata, message_json.dump());
+    if (accepted_in_advance) {
+        grantInitialCredit(socket);
+    }
+    TransferStats::Measurement wait_for_peer{stats, TransferStats::WAIT_FOR_PEER};
     nlohmann::json server_response = getServerResponse();
+    wait_for_peer.stop();
+    confirmTransfer(server_response, accepted_in_advance);
+    transfer_started = true;
+    return server_response;
+}
 
-    getUserConfirmation();
-
-
+// Server resumes only at the offset it was asked for, otherwise the whole file is sent again.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receiveTransfer(const std::string &code_words,
+                                                      const nlohmann::json &server_response) {
+    if (InitSessionMessage::isPipe(server_response)) {
+        receivePipe(server_response);
+        return;
+    }
     std::string filename = server_response[InitSessionMessage::FILENAME_KEY].get<std::string>();
     bool is_compressed = server_response[InitSessionMessage::IS_COMPRESSED_KEY].get<bool>();
-    std::filesystem::path receive_path_base = is_compressed
-                                              ? DROP_FILE_RECEIVER_TMP_DIR
-                                              : std::filesystem::current_path();
-
-    std::filesystem::path file_to_receive_path = receive_path_base / filename;
+    ResumeCheckpoint progress{.file_id = InitSessionMessage::fileId(server_response),
+                              .partial_path = partialFilePath(filename, is_compressed),
+                              .offset = InitSessionMessage::resumeOffset(server_response)};
+    if (progress.offset > 0 && (!checkpoint || checkpoint->offset != progress.offset ||
+                                checkpoint->partial_path != progress.partial_path)) {
+        throw DropFileReceiveException(
+                fmt::format("Server offered to resume at {}, which does not match local checkpoint.", progress.offset));
+    }
 
-    receiveFileImpl(file_to_receive_path, server_response[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>());
-    validateFileHash(file_to_receive_path, server_response[InitSessionMessage::FILE_HASH_KEY].get<std::string>());
-    handleCompressedFile(is_compressed, file_to_receive_path);
+    if (progress.offset > 0) {
+        std::cout << "Resuming transfer at " << bytesToHumanReadable(progress.offset) << std::endl;
+    }
+    std::optional<std::size_t> chunk_size = InitSessionMessage::chunkSize(server_response);
+    chunk_verifier.reset();
+    if (chunk_size) {
+        chunk_verifier.emplace(server_response[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>(), *chunk_size,
+                               InitSessionMessage::hashAlgorithm(server_response).value());
+    }
+    {
+        TransferStats::Measurement transfer{stats, TransferStats::TRANSFER};
+        receiveFileImpl(code_words, progress, server_response);
+        transfer.addBytes(server_response[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>() - progress.offset);
+    }
+    try {
+        acknowledgeWithChecksum(progress.partial_path, chunk_verifier
+                ? chunk_verifier->expectedRoot()
+                : server_response[InitSessionMessage::FILE_HASH_KEY].get<std::string>());
+    } catch (const DropFileReceiveException &) {
+        std::filesystem::remove(progress.partial_path);
+        discardCheckpoint(code_words);
+        throw;
+    }
+    discardCheckpoint(code_words);
+    TransferStats::Measurement unpack{is_compressed ? stats : nullptr, TransferStats::UNPACK};
+    unpack.addBytes(std::filesystem::file_size(progress.partial_path));
+    finalizeReceivedFile(is_compressed, progress.partial_path, filename);
 }
 
-nlohmann::json DropFileReceiveClient::getServerResponse() {
-    auto received = socket.SocketBase::receive();
+template<class Stream_t>
+nlohmann::json DropFileReceiveClient<Stream_t>::getServerResponse() {
+    Frame response = socket.receiveFrame();
+    std::string received{response.payload};
+    if (response.type != FrameType::metadata) {
+        throw DropFileReceiveException(fmt::format("Error, server response: {}", received));
+    }
     try {
-        auto json = nlohmann::json::parse(received);
+        nlohmann::json json = nlohmann::json::parse(received);
         bool is_compressed = json[InitSessionMessage::IS_COMPRESSED_KEY].get<bool>();
         std::string filename = json[InitSessionMessage::FILENAME_KEY].get<std::string>();
         std::size_t file_size = json[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>();
+        if (InitSessionMessage::isPipe(json)) {
+            std::cout << "Piped data to receive: " << filename << std::endl;
+            return json;
+        }
         std::cout << (is_compressed ? "Archive" : "File") << " to receive: " << filename << std::endl;
+        if (auto entries = InitSessionMessage::bundleEntries(json); !entries.empty()) {
+            std::cout << "It holds: " << fmt::format("{}", fmt::join(entries, ", ")) << std::endl;
+        }
         std::cout << (is_compressed ? "Compressed size: " : "Size: ") << bytesToHumanReadable(file_size) << std::endl;
-        assertJsonProperties(json);
         return json;
     } catch (const nlohmann::json::exception &e) {
         throw DropFileReceiveException(fmt::format("Error, server response: {}", received));
     }
 }
 
-void DropFileReceiveClient::validateFileHash(const std::filesystem::path &compressed_file_path,
-                                             const std::string &expected_file_hash) const {
+// Final ACK carries the checksum even if it does not match, so that the sender learns about it too.
+// Chunks verified during the transfer are not read again, only those which were on disk before it.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::acknowledgeWithChecksum(const std::filesystem::path &received_file_path,
+                                                              const std::string &expected_file_hash) {
     std::cout << "Comparing file hashes..." << std::endl;
-    auto actual_file_hash = calculateFileHash(compressed_file_path);
+    TransferStats::Measurement hash{stats, TransferStats::HASH};
+    if (!chunk_verifier) {
+        hash.addBytes(std::filesystem::file_size(received_file_path));
+    }
+    auto actual_file_hash = chunk_verifier ? chunk_verifier->root(received_file_path)
+                                           : calculateFileHash(received_file_path);
+    hash.stop();
+    socket.sendFrame(FrameType::ack, actual_file_hash);
     if (actual_file_hash != expected_file_hash) {
         throw DropFileReceiveException("Received file's hash is not equal to the expected one.");
     }
     std::cout << "File hashes match." << std::endl;
 }
 
-void DropFileReceiveClient::handleCompressedFile(bool is_compressed,
-                                                 const std::filesystem::path &compressed_file_path) const {
-    if (is_compressed) {
-        ArchiveManager compressor{std::filesystem::current_path()};
-        compressor.unpackArchive(compressed_file_path);
-        std::filesystem::remove(compressed_file_path);
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::finalizeReceivedFile(bool is_compressed,
+                                                           const std::filesystem::path &partial_path,
+                                                           const std::string &filename) const {
+    if (output) {
+        if (std::filesystem::file_size(partial_path) > 0) {
+            std::ifstream received{partial_path, std::ios::binary};
+            *output << received.rdbuf() << std::flush;
+        }
+        std::filesystem::remove(partial_path);
+        if (!*output) {
+            throw DropFileReceiveException("Could not write received file to the output.");
+        }
+    } else if (is_compressed) {
+        ArchiveManager compressor{std::filesystem::current_path(), quiet};
+        compressor.unpackArchive(partial_path);
+        std::filesystem::remove(partial_path);
+    } else {
+        std::filesystem::rename(partial_path, std::filesystem::current_path() / filename);
     }
 }
 
-void DropFileReceiveClient::getUserConfirmation() {
+// When auto-accepted, the transfer has already started, so refusing it must be explicit.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::confirmTransfer(const nlohmann::json &server_response,
+                                                      bool accepted_in_advance) {
+    try {
+        assertJsonProperties(server_response);
+    } catch (const DropFileReceiveException &) {
+        socket.sendFrame(FrameType::abort, {});
+        throw;
+    }
+    if (!accepted_in_advance) {
+        getUserConfirmation();
+        grantInitialCredit(socket);
+    }
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::grantInitialCredit(ClientSocket<Stream_t> &data_socket) {
+    flow_control_window.emplace(data_socket.maxFrameSize());
+    credit_granted_at = FlowControlWindow::Clock::now();
+    data_socket.grantCredit(flow_control_window->initialCredit(credit_granted_at));
+}
+
+// Sender waits for the direct connection only once, right after the confirmation, so it is not tried when resuming.
+// Credit granted through the server is then left unused, the data comes with the credit granted here.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::setUpDirectLink(const nlohmann::json &server_response) {
+    direct_link.reset();
+    auto offer = InitSessionMessage::directOffer(server_response);
+    if (!offer || std::exchange(tried_direct_link, true)) {
+        return;
+    }
+    if (auto connected = connectDirectly<Stream_t>(*offer, DIRECT_CONNECT_TIMEOUT)) {
+        direct_link.emplace(std::move(*connected));
+        std::cout << "Connected directly to the other client." << std::endl;
+        grantInitialCredit(*direct_link);
+    } else {
+        std::cout << "Could not connect directly to the other client, the server relays the data." << std::endl;
+    }
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::getUserConfirmation() {
     std::cout << "Do you want to proceed? [y/n]" << std::endl;
     char confirmation{};
     interaction_stream >> confirmation;
     if (confirmation != 'y') {
-        socket.SocketBase::send("abort");
+        socket.sendFrame(FrameType::abort, {});
         throw DropFileReceiveException(fmt::format("Entered '{}', aborting.", confirmation));
     }
-    socket.SocketBase::sendACK();
+    socket.sendACK();
 }
 
-void
-DropFileReceiveClient::receiveFileImpl(const std::filesystem::path &file_to_receive_path, std::size_t expected_bytes) {
-    if (std::filesystem::exists(file_to_receive_path)) {
-        throw DropFileReceiveException(fmt::format("Path {} already exists!", file_to_receive_path.string()));
+// Piped data is written as it comes, to the output or to a file of its name, and checked as a whole against
+// the checksum in the END frame. Partial file is of no use without a way to resume, so it is removed on failure.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receivePipe(const nlohmann::json &server_response) {
+    receives_pipe = true;
+    std::string filename = server_response[InitSessionMessage::FILENAME_KEY].get<std::string>();
+    std::filesystem::path partial_path = partialFilePath(filename, false);
+    setUpDirectLink(server_response);
+    ClientSocket<Stream_t> &data_socket = direct_link ? *direct_link : socket;
+    Hasher hasher{InitSessionMessage::hashAlgorithm(server_response).value()};
+    std::optional<PositionalFile> file;
+    std::optional<RangeWriter> writer;
+    std::size_t received{0};
+    ProgressMeter progress{"Receiving piped data", 0, 0, quiet};
+    std::function<void(std::string_view)> write;
+    if (output) {
+        write = [&](std::string_view data) {
+            output->write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!*output) {
+                throw DropFileReceiveException("Could not write received data to the output.");
+            }
+            received += data.size();
+            progress.add(data.size());
+        };
+    } else {
+        file.emplace(partial_path, 0, direct_io);
+        writer.emplace(*file, true); // it can be of any size
+        write = [&](std::string_view data) {
+            writer->write(received, data);
+            received += data.size();
+            progress.add(data.size());
+        };
+    }
+    try {
+        TransferStats::Measurement transfer{stats, TransferStats::TRANSFER};
+        std::string expected_checksum = receivePipeData(data_socket, hasher, write);
+        if (writer) {
+            writer->flush();
+        } else {
+            output->flush();
+        }
+        transfer.addBytes(received);
+        transfer.stop();
+        TransferStats::Measurement hash{stats, TransferStats::HASH};
+        std::string actual_checksum = binaryToHumanReadable(hasher.finish().substr(0, MerkleTree::DIGEST_SIZE));
+        hash.stop();
+        socket.sendFrame(FrameType::ack, actual_checksum);
+        if (actual_checksum != expected_checksum) {
+            throw DropFileReceiveException("Received data's hash is not equal to the expected one.");
+        }
+    } catch (...) {
+        if (file) {
+            std::filesystem::remove(partial_path);
+        }
+        throw;
+    }
+    if (file) {
+        std::filesystem::rename(partial_path, std::filesystem::current_path() / filename);
     }
-    std::ofstream received_file{file_to_receive_path, std::ios::trunc};
-    std::size_t total_transferred_bytes{0};
-    auto progress_bar = createProgressBar("Receiving file");
-    while (total_transferred_bytes < expected_bytes) {
-        std::string_view data = socket.SocketBase::receiveToBuffer();
-        std::size_t left_to_transfer = expected_bytes - total_transferred_bytes;
-        std::size_t write_size = std::min(left_to_transfer, data.size());
-        received_file.write(data.data(), static_cast<std::streamsize>(write_size));
-        total_transferred_bytes += write_size;
-        progress_bar.set_progress(100 * total_transferred_bytes / expected_bytes);
+    progress.finish("Received.");
+    std::cout << "Piped data received: " << bytesToHumanReadable(received) << ", hashes match." << std::endl;
+}
+
+// Returns the checksum that ends the data.
+template<class Stream_t>
+std::string DropFileReceiveClient<Stream_t>::receivePipeData(ClientSocket<Stream_t> &data_socket, Hasher &hasher,
+                                                             const std::function<void(std::string_view)> &write) {
+    bool is_first_frame{true};
+    SocketTuner tuner{data_socket.nativeHandle(), tuning_profile};
+    while (true) {
+        Frame frame = data_socket.receiveFrame();
+        if (std::exchange(is_first_frame, false)) {
+            flow_control_window->onRttSample(FlowControlWindow::Clock::now() - credit_granted_at);
+        }
+        if (frame.type == FrameType::end) {
+            return std::string{frame.payload};
+        }
+        if (frame.type != FrameType::data) {
+            throw DropFileReceiveException(fmt::format("Transfer interrupted, received {} frame: {}",
+                                                       toString(frame.type), frame.payload.substr(0, 100)));
+        }
+        hasher.update(frame.payload);
+        write(frame.payload);
+        if (tuner.recordTransferred(frame.payload.size(), FlowControlWindow::Clock::now())) {
+            spdlog::info("Receiving stream tuned: {}", toString(tuner.report()));
+        }
+        if (std::size_t credit = flow_control_window->onBytesConsumed(frame.payload.size(),
+                                                                      FlowControlWindow::Clock::now()); credit > 0) {
+            data_socket.grantCredit(credit);
+        }
     }
-    socket.SocketBase::sendACK();
-    received_file.flush();
-    progress_bar.set_option(indicators::option::PrefixText{"File received."});
 }
 
-void DropFileReceiveClient::assertJsonProperties(const nlohmann::json &json) {
-    std::string filename = json[InitSessionMessage::FILENAME_KEY].get<std::string>();
-    if (std::filesystem::exists(filename)) {
-        throw DropFileReceiveException(fmt::format("Directory {} already exists!", filename));
+// Main socket receives the first stripe, every extra stream one of the others, each written at its own offset
+// and checked chunk by chunk against the sender's Merkle tree leaves, which trail the data of every chunk.
+// Only single-stream transfers are checkpointed: the checkpoint is saved every CHECKPOINT_INTERVAL bytes
+// and when the transfer breaks, so it never points past what has really been written (and not found corrupted).
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receiveFileImpl(const std::string &code_words, ResumeCheckpoint progress,
+                                                      const nlohmann::json &server_response) {
+    std::size_t file_size = server_response[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>();
+    std::size_t streams = InitSessionMessage::streamCount(server_response);
+    setUpDirectLink(server_response);
+    ClientSocket<Stream_t> &data_socket = direct_link ? *direct_link : socket;
+    PositionalFile file{progress.partial_path, progress.offset, direct_io};
+    file.preallocate(file_size);
+    limits_page_cache = file_size > RangeWriter::PAGE_CACHE_LIMIT;
+    std::vector<std::size_t> extra_streams = InitSessionMessage::extraStreams(server_response);
+    std::vector<ClientSocket<Stream_t>> stream_sockets;
+    for (std::size_t i = 0; i < extra_streams.size(); ++i) {
+        stream_sockets.push_back(socket.connectAnother());
     }
+    ProgressMeter received{"Receiving file", file_size, progress.offset, quiet};
+    std::vector<std::future<void>> stripes;
+    for (std::size_t i = 0; i < extra_streams.size(); ++i) {
+        stripes.push_back(std::async(std::launch::async, [&, i] {
+            receiveStripe(stream_sockets[i], code_words, file, server_response, extra_streams[i], received);
+        }));
+    }
+    bool is_checkpointed = streams == 1;
+    std::size_t next_checkpoint = progress.offset + CHECKPOINT_INTERVAL;
+    try {
+        ByteRange first_stripe = InitSessionMessage::stripeOf(server_response, 0);
+        auto range_verifier = verifyRange(first_stripe, progress.offset, file.path());
+        try {
+            receiveRange(data_socket, *flow_control_window, credit_granted_at, file, {progress.offset, first_stripe.end},
+                         range_verifier, [&](std::size_t bytes) {
+                progress.offset += bytes;
+                received.add(bytes);
+                if (is_checkpointed && progress.offset >= next_checkpoint) {
+                    saveCheckpoint(code_words, progress);
+                    next_checkpoint = progress.offset + CHECKPOINT_INTERVAL;
+                }
+            });
+        } catch (const CorruptedChunkException &e) {
+            progress.offset = std::min(progress.offset, e.chunkBegin());
+            throw;
+        }
+        for (auto &stripe: stripes) {
+            stripe.get();
+        }
+    } catch (...) {
+        if (is_checkpointed) {
+            saveCheckpoint(code_words, progress);
+        }
+        socket.shutdown();
+        data_socket.shutdown();
+        for (auto &stream_socket: stream_sockets) {
+            stream_socket.shutdown();
+        }
+        for (auto &stripe: stripes) {
+            if (stripe.valid()) {
+                stripe.wait();
+            }
+        }
+        throw;
+    }
+    received.finish("File received.");
+}
+
+template<class Stream_t>
+std::optional<ChunkVerifier::RangeVerifier>
+DropFileReceiveClient<Stream_t>::verifyRange(ByteRange stripe, std::size_t offset,
+                                             const std::filesystem::path &partial_path) {
+    if (!chunk_verifier) {
+        return std::nullopt;
+    }
+    return chunk_verifier->verifyRange(stripe, offset, partial_path);
+}
+
+// Consent was given on the main stream, so extra streams grant their credit right away.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receiveStripe(ClientSocket<Stream_t> &stream_socket,
+                                                    const std::string &code_words, PositionalFile &file,
+                                                    const nlohmann::json &server_response, std::size_t index,
+                                                    ProgressMeter &progress) {
+    ByteRange stripe = InitSessionMessage::stripeOf(server_response, index);
+    stream_socket.requestFramedProtocol();
+    stream_socket.sendFrame(FrameType::metadata, InitSessionMessage::createStreamJoinMessage(
+            "receive", code_words, index, stripe, InitSessionMessage::chunkSize(server_response)).dump());
+    FlowControlWindow window{stream_socket.maxFrameSize()};
+    auto granted_at = FlowControlWindow::Clock::now();
+    stream_socket.grantCredit(window.initialCredit(granted_at));
+    auto range_verifier = verifyRange(stripe, stripe.begin, file.path());
+    receiveRange(stream_socket, window, granted_at, file, stripe, range_verifier, [&](std::size_t bytes) {
+        progress.add(bytes);
+    });
+    stream_socket.sendACK();
+}
+
+// With chunk verification the range is done only once the leaves trailing its last chunk have arrived too.
+// Received data is verified and written on its own thread, at most WRITE_BEHIND_FRAMES behind the network,
+// so the range is received at the speed of the slower of the two rather than of both of them one after another.
+// on_written gets only what has reached the file, so a checkpoint never points past it.
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::receiveRange(ClientSocket<Stream_t> &stream_socket, FlowControlWindow &window,
+                                                   FlowControlWindow::Clock::time_point granted_at,
+                                                   PositionalFile &file, ByteRange range,
+                                                   std::optional<ChunkVerifier::RangeVerifier> &range_verifier,
+                                                   const std::function<void(std::size_t)> &on_written) {
+    BoundedQueue<ReceivedData> received{WRITE_BEHIND_FRAMES};
+    auto writer = std::async(std::launch::async, [&] {
+        try {
+            writeRange(file, range_verifier, received, on_written);
+        } catch (...) {
+            received.close();
+            throw;
+        }
+    });
+    try {
+        bool is_first_frame{true};
+        SocketTuner tuner{stream_socket.nativeHandle(), tuning_profile};
+        for (std::size_t position = range.begin;
+             position < range.end || (range_verifier && !range_verifier->hasExpectedLeaves());) {
+            Frame frame = stream_socket.receiveFrame();
+            if (std::exchange(is_first_frame, false)) {
+                window.onRttSample(FlowControlWindow::Clock::now() - granted_at);
+            }
+            if (frame.type == FrameType::chunk_hashes && range_verifier) {
+                range_verifier->addExpectedLeaves(decodeChunkHashes(frame.payload));
+                continue;
+            }
+            if (frame.type != FrameType::data || position == range.end) {
+                throw DropFileReceiveException(fmt::format("Transfer interrupted, received {} frame: {}",
+                                                           toString(frame.type), frame.payload.substr(0, 100)));
+            }
+            std::size_t size = std::min(range.end - position, frame.payload.size());
+            if (!received.push({position, std::string{frame.payload.substr(0, size)}})) {
+                break; // writing has failed
+            }
+            position += size;
+            if (tuner.recordTransferred(size, FlowControlWindow::Clock::now())) {
+                spdlog::info("Receiving stream tuned: {}", toString(tuner.report()));
+            }
+            if (std::size_t credit = window.onBytesConsumed(size, FlowControlWindow::Clock::now());
+                    credit > 0 && position < range.end) {
+                stream_socket.grantCredit(credit);
+            }
+        }
+    } catch (...) {
+        received.close();
+        throw;
+    }
+    received.close();
+    writer.get();
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::writeRange(PositionalFile &file,
+                                                 std::optional<ChunkVerifier::RangeVerifier> &range_verifier,
+                                                 BoundedQueue<ReceivedData> &received,
+                                                 const std::function<void(std::size_t)> &on_written) {
+    RangeWriter writer{file, limits_page_cache};
+    while (auto data = received.pop()) {
+        if (range_verifier) {
+            try {
+                range_verifier->update(data->bytes);
+            } catch (const CorruptedChunkException &) {
+                if (std::size_t written = writer.flush(); written > 0) {
+                    on_written(written); // what precedes the corrupted chunk need not be received again
+                }
+                throw;
+            }
+        }
+        if (std::size_t written = writer.write(data->position, data->bytes); written > 0) {
+            on_written(written);
+        }
+    }
+    if (std::size_t written = writer.flush(); written > 0) {
+        on_written(written);
+    }
+}
+
+template<class Stream_t>
+std::filesystem::path DropFileReceiveClient<Stream_t>::partialFilePath(const std::string &filename,
+                                                                       bool is_compressed) const {
+    std::filesystem::path base_dir = is_compressed ? DROP_FILE_RECEIVER_PARTIAL_DIR : std::filesystem::current_path();
+    return base_dir / (filename + PARTIAL_FILE_SUFFIX);
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::saveCheckpoint(const std::string &code_words,
+                                                     const ResumeCheckpoint &progress) const {
+    if (auto checkpoint_path = checkpointPath(code_words)) {
+        progress.save(*checkpoint_path);
+    }
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::discardCheckpoint(const std::string &code_words) const {
+    if (auto checkpoint_path = checkpointPath(code_words)) {
+        std::filesystem::remove(*checkpoint_path);
+    }
+}
+
+// Code words end up in a file name, so anything else than what the server generates is not checkpointed.
+template<class Stream_t>
+std::optional<std::filesystem::path> DropFileReceiveClient<Stream_t>::checkpointPath(const std::string &code_words) {
+    bool is_safe = !code_words.empty() && std::ranges::all_of(code_words, [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '-';
+    });
+    if (!is_safe) {
+        return std::nullopt;
+    }
+    return DROP_FILE_RECEIVER_PARTIAL_DIR / (code_words + ".json");
+}
+
+template<class Stream_t>
+void DropFileReceiveClient<Stream_t>::assertJsonProperties(const nlohmann::json &json) {
     bool is_compressed = json[InitSessionMessage::IS_COMPRESSED_KEY].get<bool>();
+    if (output && is_compressed) {
+        throw DropFileReceiveException("Directories cannot be written to the output, receive them without it.");
+    }
+    std::vector<std::string> entries = InitSessionMessage::bundleEntries(json);
+    if (entries.empty()) {
+        entries.push_back(json[InitSessionMessage::FILENAME_KEY].get<std::string>());
+    }
+    for (const auto &entry: entries) {
+        if (!output && std::filesystem::exists(entry)) {
+            throw DropFileReceiveException(fmt::format("Directory {} already exists!", entry));
+        }
+    }
+    if (!InitSessionMessage::hashAlgorithm(json)) {
+        throw DropFileReceiveException(fmt::format("Sender hashes the file with unsupported algorithm {}.",
+                                                   json[InitSessionMessage::HASH_ALGORITHM_KEY].dump()));
+    }
 
     std::filesystem::path base_dir = is_compressed ? std::filesystem::temp_directory_path()
                                                    : std::filesystem::current_path();
@@ -120,3 +595,6 @@ void DropFileReceiveClient::assertJsonProperties(const nlohmann::json &json) {
         throw DropFileReceiveException("Not enough disk space to receive this file.");
     }
 }
+
+template class DropFileReceiveClient<TlsStream>;
+template class DropFileReceiveClient<PlainStream>;
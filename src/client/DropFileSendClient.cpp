@@ -1,33 +1,122 @@
 #include "client/DropFileSendClient.hpp"
 #include "InitSessionMessage.hpp"
 #include "client/ArchiveManager.hpp"
+#include "client/AdaptiveFrameSizer.hpp"
+#include "client/BoundedQueue.hpp"
+#include "client/ProgressMeter.hpp"
+#include "FileReader.hpp"
 #include "Utils.hpp"
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <future>
 
-DropFileSendClient::DropFileSendClient(ClientSocket socket) : socket(std::move(socket)) {
+#include <unistd.h>
+
+
+template<class Stream_t>
+DropFileSendClient<Stream_t>::DropFileSendClient(ClientSocket<Stream_t> socket, ReconnectPolicy reconnect_policy,
+                                                 std::size_t streams, HashAlgorithm hash_algorithm, bool direct,
+                                                 TuningProfile tuning_profile, std::size_t rate_limit, bool zero_copy,
+                                                 bool quiet, TransferStats *stats)
+        : socket(std::move(socket)), reconnect_policy(reconnect_policy),
+          streams(std::clamp(streams, std::size_t{1}, MAX_STREAMS)), hash_algorithm(hash_algorithm),
+          tuning_profile(std::move(tuning_profile)), zero_copy(zero_copy), quiet(quiet), stats(stats) {
+    if (direct && this->streams > 1) {
+        throw DropFileSendException("Direct transfer goes over a single stream.");
+    }
+    if (rate_limit > 0) {
+        rate_limiter.emplace(rate_limit);
+    }
+    if (direct) {
+        try {
+            direct_listener.emplace();
+        } catch (const DropFileBaseException &e) {
+            spdlog::warn("{} Data will be relayed by the server.", e.what());
+        }
+    }
+    enableZeroCopy(this->socket);
+    this->socket.requestFramedProtocol();
     std::filesystem::remove_all(DROP_FILE_SENDER_TMP_DIR);
     std::filesystem::create_directories(DROP_FILE_SENDER_TMP_DIR);
 }
 
-DropFileSendClient::~DropFileSendClient() {
+template<class Stream_t>
+DropFileSendClient<Stream_t>::~DropFileSendClient() {
     std::filesystem::remove_all(DROP_FILE_SENDER_TMP_DIR);
 }
 
-SendFileAndReceiveCode DropFileSendClient::sendFSEntryMetadata(const std::string &path) {
+template<class Stream_t>
+SendFileAndReceiveCode DropFileSendClient<Stream_t>::sendFSEntryMetadata(const std::string &path) {
     auto [fs_entry, is_compressed] = compressIfNecessary(path);
     std::cout << (is_compressed ? "Directory" : "File") << " to send: " << fs_entry.path << std::endl;
-    nlohmann::json message_json = InitSessionMessage::createSendMessage(fs_entry.path, is_compressed);
+    nlohmann::json message_json = InitSessionMessage::createSendMessage(fs_entry.path, is_compressed, streams,
+                                                                        MerkleTree::DEFAULT_CHUNK_SIZE, hash_algorithm);
+    return requestReceiveCode(std::move(fs_entry), std::move(message_json));
+}
+
+// Several paths go in a single transfer, so they share one connection, one TLS handshake and one receive code.
+template<class Stream_t>
+SendFileAndReceiveCode DropFileSendClient<Stream_t>::sendFSEntryMetadata(const std::vector<std::string> &paths) {
+    if (paths.empty()) {
+        throw DropFileSendException("Nothing to send.");
+    }
+    if (paths.size() == 1) {
+        return sendFSEntryMetadata(paths.front());
+    }
+    std::vector<std::filesystem::path> entries{paths.begin(), paths.end()};
+    std::filesystem::path bundle_path = DROP_FILE_SENDER_TMP_DIR / fmt::format("{}-and-{}-more",
+                                                                                entries.front().filename().string(),
+                                                                                entries.size() - 1);
+    {
+        TransferStats::Measurement archive{stats, TransferStats::ARCHIVE};
+        ArchiveManager{entries, quiet}.createArchive(bundle_path);
+        archive.addBytes(std::filesystem::file_size(bundle_path));
+    }
+    RAIIFSEntry bundle{std::move(bundle_path), true};
+    std::cout << entries.size() << " files and directories to send: " << bundle.path << std::endl;
+    nlohmann::json message_json = InitSessionMessage::createSendMessage(bundle.path, true, streams,
+                                                                        MerkleTree::DEFAULT_CHUNK_SIZE, hash_algorithm);
+    std::vector<std::string> names;
+    for (const auto &entry: entries) {
+        names.push_back(entry.filename().string());
+    }
+    InitSessionMessage::setBundleEntries(message_json, names);
+    return requestReceiveCode(std::move(bundle), std::move(message_json));
+}
+
+template<class Stream_t>
+std::string DropFileSendClient<Stream_t>::sendPipeMetadata(const std::string &name) {
+    std::cout << "Piped data to send: " << name << std::endl;
+    return requestReceiveCode(RAIIFSEntry{name, false},
+                              InitSessionMessage::createPipeSendMessage(name, hash_algorithm)).second;
+}
+
+template<class Stream_t>
+SendFileAndReceiveCode DropFileSendClient<Stream_t>::requestReceiveCode(RAIIFSEntry fs_entry,
+                                                                        nlohmann::json message_json) {
+    if (direct_listener) {
+        InitSessionMessage::setDirectOffer(message_json, direct_listener->offer());
+    }
     std::cout << "Requesting DropFileServer for unique receive code..." << std::endl;
-    socket.SocketBase::send(message_json.dump());
-    std::string receive_code = getReceiveCodeFromServer();
+    socket.sendFrame(FrameType::metadata, message_json.dump());
+    receive_code = getReceiveCodeFromServer();
+    session_message = std::move(message_json);
     std::cout << fmt::format("Enter on another device: 'drop-file receive {}'", receive_code) << std::endl;
-    return {std::move(fs_entry), std::move(receive_code)};
+    return {std::move(fs_entry), receive_code};
 }
 
-std::string DropFileSendClient::getReceiveCodeFromServer() {
-    std::string received_msg = socket.SocketBase::receive();
+template<class Stream_t>
+std::string DropFileSendClient<Stream_t>::getReceiveCodeFromServer() {
+    Frame response = socket.receiveFrame();
+    std::string received_msg{response.payload};
+    if (response.type == FrameType::error) {
+        throw DropFileSendException(fmt::format("Server refused the transfer: {}", received_msg));
+    }
     try {
         auto json = nlohmann::json::parse(received_msg);
         auto receive_code = json[InitSessionMessage::CODE_WORDS_KEY].get<std::string>();
@@ -38,36 +127,431 @@ std::string DropFileSendClient::getReceiveCodeFromServer() {
     }
 }
 
-std::pair<RAIIFSEntry, bool> DropFileSendClient::compressIfNecessary(const std::string &path) {
+template<class Stream_t>
+std::pair<RAIIFSEntry, bool> DropFileSendClient<Stream_t>::compressIfNecessary(const std::string &path) {
     bool should_compress = std::filesystem::is_directory(path);
     RAIIFSEntry dir_entry{path, false};
     if (should_compress) {
-        ArchiveManager dir_compressor{dir_entry.path};
+        TransferStats::Measurement archive{stats, TransferStats::ARCHIVE};
+        ArchiveManager dir_compressor{dir_entry.path, quiet};
         std::filesystem::path new_path = DROP_FILE_SENDER_TMP_DIR / dir_entry.path.filename();
         dir_compressor.createArchive(new_path);
+        archive.addBytes(std::filesystem::file_size(new_path));
         dir_entry = RAIIFSEntry{std::move(new_path), true};
     }
     return {std::move(dir_entry), should_compress};
 }
 
-void DropFileSendClient::sendFSEntry(RAIIFSEntry data_source) {
+// Failing to resume (e.g. the server has not noticed the broken connection yet) is retried too,
+// until reconnect attempts are used up.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendFSEntry(RAIIFSEntry data_source) {
     std::cout << "Waiting for other client to confirm transfer..." << std::endl;
-    socket.SocketBase::receiveACK();
+    std::size_t offset = awaitConfirmation();
     std::cout<< "Other client confirmed transfer, sending " << data_source.path.filename() << std::endl;
-    std::ifstream file{data_source.path, std::ios::binary};
-    std::size_t file_size = std::filesystem::file_size(data_source.path);
-    std::size_t total_bytes_read{0};
-    auto progress_bar = createProgressBar("Sending file");
-    std::streamsize bytes_read;
-    auto [buffer_ptr, buffer_size] = socket.SocketBase::getBuffer();
-    do {
-        bytes_read = file.readsome(buffer_ptr, static_cast<std::streamsize>(buffer_size));
-        if (bytes_read > 0) {
-            total_bytes_read += static_cast<std::size_t>(bytes_read);
-            socket.SocketBase::send({buffer_ptr, static_cast<std::size_t>(bytes_read)});
-            progress_bar.set_progress(100 * total_bytes_read / file_size);
-        }
-    } while (bytes_read > 0);
-    socket.SocketBase::receiveACK();
-    progress_bar.set_option(indicators::option::PrefixText{"File sent."});
-}
\ No newline at end of file
+    acceptDirectLink();
+    ReconnectBackoff backoff{reconnect_policy};
+    bool reconnecting{false};
+    while (true) {
+        try {
+            if (reconnecting) {
+                direct_link.reset();
+                offset = resumeSession();
+                backoff.reset();
+                reconnecting = false;
+            }
+            sendFile(data_source.path, offset);
+            return;
+        } catch (const boost::system::system_error &e) {
+            if (!backoff.waitForNextAttempt(e.what())) {
+                throw;
+            }
+        } catch (const DropFileSendException &e) {
+            if (!reconnecting || !backoff.waitForNextAttempt(e.what())) {
+                throw;
+            }
+        }
+        reconnecting = true;
+    }
+}
+
+// Confirmation ACK carries the offset at which receiver's partial file ends, it is empty when there is none.
+template<class Stream_t>
+std::size_t DropFileSendClient<Stream_t>::awaitConfirmation() {
+    TransferStats::Measurement wait_for_peer{stats, TransferStats::WAIT_FOR_PEER};
+    std::string payload = socket.receiveACK();
+    std::size_t offset{0};
+    if (!payload.empty()) {
+        auto [end, ec] = std::from_chars(payload.data(), payload.data() + payload.size(), offset);
+        if (ec != std::errc{} || end != payload.data() + payload.size()) {
+            throw DropFileSendException(fmt::format("Server sent invalid resume offset: {}", payload.substr(0, 100)));
+        }
+    }
+    return offset;
+}
+
+// Receiver tries to connect right after it has confirmed the transfer, only once. Server is told to stop relaying
+// before any data is sent, once the receiver has proven it got the offer.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::acceptDirectLink() {
+    if (!direct_listener) {
+        return;
+    }
+    auto accepted = direct_listener->accept(DIRECT_ACCEPT_TIMEOUT);
+    direct_listener.reset();
+    if (accepted) {
+        direct_link.emplace(std::move(*accepted));
+        socket.sendFrame(FrameType::direct, {});
+        std::cout << "Connected directly to the other client." << std::endl;
+    } else {
+        std::cout << "Could not connect directly to the other client, the server relays the data." << std::endl;
+    }
+}
+
+// Main socket sends the first stripe, every extra stream sends one of the others (see Striping.hpp).
+// When any of them fails, all the others are shut down too, so that the whole transfer can be resumed.
+// File is hashed while it is being sent, its Merkle tree root is known only once all the chunks have gone.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendFile(const std::filesystem::path &path, std::size_t offset) {
+    std::size_t file_size = std::filesystem::file_size(path);
+    if (offset > file_size) {
+        throw DropFileSendException(fmt::format("Cannot resume at {}, {} has only {} bytes.", offset, path.string(),
+                                                file_size));
+    }
+    if (offset > 0) {
+        std::cout << "Resuming transfer at " << bytesToHumanReadable(offset) << std::endl;
+    }
+    TransferStats::Measurement transfer{stats, TransferStats::TRANSFER};
+    leaves.resize(MerkleTree::chunkCount(file_size, chunkSize()));
+    ClientSocket<Stream_t> &data_socket = direct_link ? *direct_link : socket;
+    ByteRange first_stripe = InitSessionMessage::stripeOf(session_message, 0);
+    sendSkippedChunkHashes(data_socket, path, first_stripe, offset);
+    std::vector<std::size_t> extra_streams = InitSessionMessage::extraStreams(session_message);
+    std::vector<ClientSocket<Stream_t>> stream_sockets;
+    for (std::size_t i = 0; i < extra_streams.size(); ++i) {
+        stream_sockets.push_back(socket.connectAnother());
+    }
+    ProgressMeter progress{"Sending file", file_size, offset, quiet};
+    std::vector<std::future<void>> stripes;
+    for (std::size_t i = 0; i < extra_streams.size(); ++i) {
+        stripes.push_back(std::async(std::launch::async, [&, i] {
+            sendStripe(stream_sockets[i], path, extra_streams[i],
+                       InitSessionMessage::stripeOf(session_message, extra_streams[i]), progress);
+        }));
+    }
+    try {
+        sendRange(data_socket, path, {offset, first_stripe.end}, [&](std::size_t bytes) {
+            progress.add(bytes);
+        });
+        for (auto &stripe: stripes) {
+            stripe.get();
+        }
+    } catch (...) {
+        socket.shutdown();
+        data_socket.shutdown();
+        for (auto &stream_socket: stream_sockets) {
+            stream_socket.shutdown();
+        }
+        for (auto &stripe: stripes) {
+            if (stripe.valid()) {
+                stripe.wait();
+            }
+        }
+        throw;
+    }
+    transfer.addBytes(progress.value() - offset);
+    transfer.stop();
+    TransferStats::Measurement hash{stats, TransferStats::HASH};
+    file_hash = MerkleTree{chunkSize(), leaves, hash_algorithm}.root();
+    hash.stop();
+    TransferStats::Measurement verify{stats, TransferStats::VERIFY};
+    verifyReceiverChecksum(socket.receiveACK());
+    verify.stop();
+    progress.finish("File sent.");
+}
+
+// Receiver checks also the chunks it has had before the transfer was resumed, so their leaves go ahead of the data.
+// They are mostly known from the interrupted attempt already, the others are read from disk.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendSkippedChunkHashes(ClientSocket<Stream_t> &data_socket,
+                                                          const std::filesystem::path &path, ByteRange first_stripe,
+                                                          std::size_t offset) {
+    std::size_t file_size = session_message[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>();
+    ChunkSpan stripe_chunks = MerkleTree::leavesOf(first_stripe, file_size, chunkSize());
+    ChunkSpan sent_chunks = MerkleTree::chunksOf({offset, first_stripe.end}, chunkSize());
+    std::vector<std::size_t> unknown;
+    for (std::size_t index = stripe_chunks.first; index < stripe_chunks.end && !sent_chunks.contains(index); ++index) {
+        if (leaves[index].empty()) {
+            unknown.push_back(index);
+        }
+    }
+    if (!unknown.empty()) {
+        auto unknown_leaves = MerkleTree::hashChunks(path, chunkSize(), unknown, hash_algorithm);
+        for (std::size_t i = 0; i < unknown.size(); ++i) {
+            leaves[unknown[i]] = std::move(unknown_leaves[i]);
+        }
+    }
+
+    std::string digests;
+    std::size_t first_chunk = stripe_chunks.first;
+    for (std::size_t index = stripe_chunks.first; index < stripe_chunks.end && !sent_chunks.contains(index); ++index) {
+        digests += leaves[index];
+        if (digests.size() == DIGESTS_PER_FRAME * MerkleTree::DIGEST_SIZE) {
+            data_socket.sendFrame(FrameType::chunk_hashes, encodeChunkHashes(first_chunk, digests));
+            first_chunk = index + 1;
+            digests.clear();
+        }
+    }
+    if (!digests.empty()) {
+        data_socket.sendFrame(FrameType::chunk_hashes, encodeChunkHashes(first_chunk, digests));
+    }
+}
+
+// Extra stream joins the session by its code, the server lets it go once the receiver's counterpart is there.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendStripe(ClientSocket<Stream_t> &stream_socket, const std::filesystem::path &path,
+                                              std::size_t index, ByteRange stripe,
+                                              ProgressMeter &progress) {
+    enableZeroCopy(stream_socket);
+    stream_socket.requestFramedProtocol();
+    stream_socket.sendFrame(FrameType::metadata,
+                            InitSessionMessage::createStreamJoinMessage("send", receive_code, index, stripe,
+                                                                        chunkSize()).dump());
+    stream_socket.receiveACK();
+    sendRange(stream_socket, path, stripe, [&](std::size_t bytes) {
+        progress.add(bytes);
+    });
+    stream_socket.receiveACK();
+}
+
+// Leaf of every chunk is sent right after its last byte, so the receiver can check it without reading it back.
+// Reading and hashing run on their own thread, at most READ_AHEAD_BLOCKS ahead of the network, so the range is sent
+// at the speed of the slower of the disk and the network rather than of both of them one after another.
+// When the kernel does the sending, frames go from the page cache to the socket, only hashing reads the blocks.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendRange(ClientSocket<Stream_t> &stream_socket, const std::filesystem::path &path,
+                                             ByteRange range, const std::function<void(std::size_t)> &on_sent) {
+    std::size_t block_size = stream_socket.maxFrameSize();
+    FileReader file{path, range, block_size};
+    BoundedQueue<ReadBlock> read_blocks{READ_AHEAD_BLOCKS};
+    auto reader = std::async(std::launch::async, [&] {
+        try {
+            readRange(file, path, range, read_blocks);
+        } catch (...) {
+            read_blocks.close();
+            throw;
+        }
+        read_blocks.close();
+    });
+    try {
+        AdaptiveFrameSizer frame_sizer{stream_socket.maxFrameSize()};
+        SocketTuner tuner{stream_socket.nativeHandle(), tuning_profile};
+        while (auto block = read_blocks.pop()) {
+            std::string_view data = block->data();
+            std::size_t position = block->offset;
+            while (!data.empty()) {
+                std::size_t frame_size = awaitFrame(stream_socket, frame_sizer, data.size());
+                auto send_start = std::chrono::steady_clock::now();
+                if (stream_socket.sendsFromKernel()) {
+                    stream_socket.sendFileFrame(file.nativeHandle(), position, frame_size);
+                } else {
+                    stream_socket.send(data.substr(0, frame_size));
+                }
+                stream_socket.consumeCredit(frame_size);
+                recordFrame(frame_sizer, tuner, frame_size, send_start);
+                data.remove_prefix(frame_size);
+                position += frame_size;
+                on_sent(frame_size);
+            }
+            for (auto &[chunk_index, leaf]: block->leaves) {
+                stream_socket.sendFrame(FrameType::chunk_hashes, encodeChunkHashes(chunk_index, leaf));
+                leaves[chunk_index] = std::move(leaf);
+            }
+        }
+    } catch (...) {
+        read_blocks.close();
+        throw;
+    }
+    reader.get();
+}
+
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::readRange(FileReader &file, const std::filesystem::path &path, ByteRange range,
+                                             BoundedQueue<ReadBlock> &read_blocks) const {
+    RangeHasher hasher{path, session_message[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>(), chunkSize(), range,
+                       hash_algorithm};
+    bool is_mapped = file.mapped().has_value();
+    std::size_t position = range.begin;
+    for (std::string_view read = file.next(); !read.empty(); read = file.next()) {
+        ReadBlock block{.offset = position};
+        position += read.size();
+        if (is_mapped) {
+            block.mapped = read;
+        } else {
+            block.copied = read;
+        }
+        hasher.update(block.data(), [&](std::size_t chunk_index, MerkleTree::Digest leaf) {
+            block.leaves.emplace_back(chunk_index, std::move(leaf));
+        });
+        if (!read_blocks.push(std::move(block))) {
+            return; // sending has failed
+        }
+    }
+}
+
+// Size of the next frame, once the receiver has granted credit for it and the rate limit lets it go.
+template<class Stream_t>
+std::size_t DropFileSendClient<Stream_t>::awaitFrame(ClientSocket<Stream_t> &stream_socket,
+                                                     AdaptiveFrameSizer &frame_sizer, std::size_t left) {
+    std::size_t frame_size = std::min({frame_sizer.frameSize(), stream_socket.awaitCredit(), left});
+    if (rate_limiter) {
+        frame_size = std::min(frame_size, rate_limiter->burstSize());
+        rate_limiter->acquire(frame_size);
+    }
+    return frame_size;
+}
+
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::recordFrame(AdaptiveFrameSizer &frame_sizer, SocketTuner &tuner,
+                                               std::size_t frame_size,
+                                               std::chrono::steady_clock::time_point send_start) const {
+    frame_sizer.recordSend(frame_size, std::chrono::steady_clock::now() - send_start);
+    if (tuner.recordTransferred(frame_size, std::chrono::steady_clock::now())) {
+        spdlog::info("Sending stream tuned: {}", toString(tuner.report()));
+    }
+}
+
+// Piped data is sent the same way as a range of a file, only its end is not known until the pipe is closed.
+// Data is hashed while it is read, its checksum goes in the END frame. There is nothing to resume from,
+// so the first broken connection ends the transfer.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::sendPipe(int fd) {
+    std::cout << "Waiting for other client to confirm transfer..." << std::endl;
+    if (awaitConfirmation() != 0) {
+        throw DropFileSendException("Piped data cannot be resumed.");
+    }
+    std::cout << "Other client confirmed transfer, sending piped data." << std::endl;
+    acceptDirectLink();
+    TransferStats::Measurement transfer{stats, TransferStats::TRANSFER};
+    ClientSocket<Stream_t> &data_socket = direct_link ? *direct_link : socket;
+    Hasher hasher{hash_algorithm};
+    BoundedQueue<std::string> read_blocks{READ_AHEAD_BLOCKS};
+    auto reader = std::async(std::launch::async, [&] {
+        try {
+            readPipe(fd, data_socket.maxFrameSize(), hasher, read_blocks);
+        } catch (...) {
+            read_blocks.close();
+            throw;
+        }
+        read_blocks.close();
+    });
+    ProgressMeter progress{"Sending piped data", 0, 0, quiet};
+    try {
+        AdaptiveFrameSizer frame_sizer{data_socket.maxFrameSize()};
+        SocketTuner tuner{data_socket.nativeHandle(), tuning_profile};
+        while (auto block = read_blocks.pop()) {
+            for (std::string_view data{*block}; !data.empty();) {
+                std::size_t frame_size = awaitFrame(data_socket, frame_sizer, data.size());
+                auto send_start = std::chrono::steady_clock::now();
+                data_socket.send(data.substr(0, frame_size));
+                data_socket.consumeCredit(frame_size);
+                recordFrame(frame_sizer, tuner, frame_size, send_start);
+                data.remove_prefix(frame_size);
+                progress.add(frame_size);
+            }
+        }
+    } catch (...) {
+        read_blocks.close();
+        throw;
+    }
+    reader.get();
+    transfer.addBytes(progress.value());
+    transfer.stop();
+    TransferStats::Measurement hash{stats, TransferStats::HASH};
+    file_hash = binaryToHumanReadable(hasher.finish().substr(0, MerkleTree::DIGEST_SIZE)); // as long as a root
+    hash.stop();
+    TransferStats::Measurement verify{stats, TransferStats::VERIFY};
+    data_socket.sendFrame(FrameType::end, file_hash);
+    verifyReceiverChecksum(socket.receiveACK());
+    verify.stop();
+    progress.finish("Sent.");
+    std::cout << "Piped data sent: " << bytesToHumanReadable(progress.value()) << std::endl;
+}
+
+// Blocks are filled up before they are sent, whatever sizes the pipe is read in.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::readPipe(int fd, std::size_t block_size, Hasher &hasher,
+                                            BoundedQueue<std::string> &read_blocks) const {
+    for (bool is_open = true; is_open;) {
+        std::string block(block_size, '\0');
+        std::size_t filled{0};
+        while (filled < block_size) {
+            ssize_t size = ::read(fd, block.data() + filled, block_size - filled);
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size < 0) {
+                throw DropFileSendException(fmt::format("Could not read piped data: {}", std::strerror(errno)));
+            }
+            if (size == 0) {
+                is_open = false;
+                break;
+            }
+            filled += static_cast<std::size_t>(size);
+        }
+        block.resize(filled);
+        if (block.empty()) {
+            return;
+        }
+        hasher.update(block);
+        if (!read_blocks.push(std::move(block))) {
+            return; // sending has failed
+        }
+    }
+}
+
+// Interrupted session is registered again with its code as the resume token, nothing is recompressed.
+template<class Stream_t>
+std::size_t DropFileSendClient<Stream_t>::resumeSession() {
+    {
+        TransferStats::Measurement connect{stats, TransferStats::CONNECT};
+        socket.reconnect();
+    }
+    enableZeroCopy(socket);
+    socket.requestFramedProtocol();
+    nlohmann::json message_json = session_message;
+    InitSessionMessage::setResumeToken(message_json, receive_code);
+    socket.sendFrame(FrameType::metadata, message_json.dump());
+    getReceiveCodeFromServer();
+    std::cout << "Session resumed, waiting for other client to reconnect..." << std::endl;
+    return awaitConfirmation();
+}
+
+// Receiver's final ACK carries checksum of what it has written, empty when it is a legacy client.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::verifyReceiverChecksum(const std::string &receiver_checksum) const {
+    if (receiver_checksum.empty()) {
+        return;
+    }
+    if (receiver_checksum != file_hash) {
+        throw DropFileSendException(fmt::format("Receiver got file with checksum {}, while sent one has {}.",
+                                                receiver_checksum, file_hash));
+    }
+    std::cout << "Receiver verified file checksum." << std::endl;
+}
+
+// Socket must not have sent anything since its handshake yet.
+template<class Stream_t>
+void DropFileSendClient<Stream_t>::enableZeroCopy(ClientSocket<Stream_t> &data_socket) const {
+    if (zero_copy && !data_socket.enableKernelSend()) {
+        spdlog::info("Kernel cannot send from the file directly, sending from user space.");
+    }
+}
+
+template<class Stream_t>
+std::size_t DropFileSendClient<Stream_t>::chunkSize() const {
+    return InitSessionMessage::chunkSize(session_message).value_or(MerkleTree::DEFAULT_CHUNK_SIZE);
+}
+
+template class DropFileSendClient<TlsStream>;
+template class DropFileSendClient<PlainStream>;
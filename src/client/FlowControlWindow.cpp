@@ -0,0 +1,36 @@
+#include "client/FlowControlWindow.hpp"
+
+#include <algorithm>
+
+
+FlowControlWindow::FlowControlWindow(std::size_t max_frame_size)
+        : window_size(std::min(INITIAL_WINDOW_FRAMES * max_frame_size, MAX_WINDOW_SIZE)) {}
+
+std::size_t FlowControlWindow::initialCredit(Clock::time_point now) {
+    last_grant = now;
+    return window_size;
+}
+
+void FlowControlWindow::onRttSample(std::chrono::nanoseconds rtt_sample) {
+    rtt = rtt_sample;
+}
+
+std::size_t FlowControlWindow::onBytesConsumed(std::size_t bytes, Clock::time_point now) {
+    consumed_not_granted += bytes;
+    if (consumed_not_granted < window_size / 2) {
+        return 0;
+    }
+    std::size_t credit = consumed_not_granted;
+    consumed_not_granted = 0;
+    if (rtt.count() > 0 && now - last_grant < 2 * rtt && window_size < MAX_WINDOW_SIZE) {
+        std::size_t grown_window = std::min(2 * window_size, MAX_WINDOW_SIZE);
+        credit += grown_window - window_size;
+        window_size = grown_window;
+    }
+    last_grant = now;
+    return credit;
+}
+
+std::size_t FlowControlWindow::windowSize() const {
+    return window_size;
+}
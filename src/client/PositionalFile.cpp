@@ -0,0 +1,116 @@
+#include "client/PositionalFile.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace {
+    // Returns errno of the failed write, 0 when all of it has been written.
+    int writeAll(int fd, std::size_t offset, std::string_view data) {
+        while (!data.empty()) {
+            ssize_t written = ::pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            data.remove_prefix(static_cast<std::size_t>(written));
+            offset += static_cast<std::size_t>(written);
+        }
+        return 0;
+    }
+}
+
+
+PositionalFile::PositionalFile(const std::filesystem::path &path, std::size_t keep_bytes, bool direct_io)
+        : file_path(path), fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644)) {
+    if (fd < 0) {
+        throw PositionalFileException(fmt::format("Could not open {}: {}", path.string(), std::strerror(errno)));
+    }
+    if (::ftruncate(fd, static_cast<off_t>(keep_bytes)) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw PositionalFileException(fmt::format("Could not truncate {}: {}", path.string(), std::strerror(error)));
+    }
+    if (direct_io) {
+        direct_fd = ::open(path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (direct_fd < 0) {
+            spdlog::info("Writing {} through page cache, direct I/O is not possible: {}", path.string(),
+                         std::strerror(errno));
+        }
+    }
+}
+
+PositionalFile::PositionalFile(PositionalFile &&other) noexcept : file_path(std::move(other.file_path)),
+                                                                        fd(std::exchange(other.fd, -1)),
+                                                                        direct_fd(std::exchange(other.direct_fd, -1)),
+                                                                        direct_io_failed(other.direct_io_failed.load()) {}
+
+PositionalFile::~PositionalFile() {
+    for (int descriptor: {fd, direct_fd}) {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+    }
+}
+
+// Filesystem may still refuse direct writes (e.g. of another alignment), then all writes go through page cache.
+void PositionalFile::write(std::size_t offset, std::string_view data) {
+    bool is_aligned = offset % DIRECT_IO_ALIGNMENT == 0 && data.size() % DIRECT_IO_ALIGNMENT == 0 &&
+                      reinterpret_cast<std::uintptr_t>(data.data()) % DIRECT_IO_ALIGNMENT == 0;
+    if (isDirect() && is_aligned) {
+        int error = writeAll(direct_fd, offset, data);
+        if (error == 0) {
+            return;
+        }
+        if (error != EINVAL) {
+            throw PositionalFileException(fmt::format("Could not write to {}: {}", file_path.string(),
+                                                      std::strerror(error)));
+        }
+        if (!direct_io_failed.exchange(true)) {
+            spdlog::info("Writing {} through page cache, direct I/O has failed.", file_path.string());
+        }
+    }
+    if (int error = writeAll(fd, offset, data); error != 0) {
+        throw PositionalFileException(fmt::format("Could not write to {}: {}", file_path.string(),
+                                                  std::strerror(error)));
+    }
+}
+
+void PositionalFile::preallocate(std::size_t size) {
+    if (size == 0 || ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0) {
+        return;
+    }
+    if (errno == ENOSPC) {
+        throw PositionalFileException(fmt::format("Not enough disk space for {}.", file_path.string()));
+    }
+    spdlog::debug("Could not preallocate {}: {}", file_path.string(), std::strerror(errno));
+}
+
+// Both are only hints, failing them costs nothing but page cache.
+void PositionalFile::startWriteBack(ByteRange range) {
+    ::sync_file_range(fd, static_cast<off_t>(range.begin), static_cast<off_t>(range.size()), SYNC_FILE_RANGE_WRITE);
+}
+
+void PositionalFile::evict(ByteRange range) {
+    ::sync_file_range(fd, static_cast<off_t>(range.begin), static_cast<off_t>(range.size()),
+                      SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    ::posix_fadvise(fd, static_cast<off_t>(range.begin), static_cast<off_t>(range.size()), POSIX_FADV_DONTNEED);
+}
+
+bool PositionalFile::isDirect() const {
+    return direct_fd >= 0 && !direct_io_failed;
+}
+
+const std::filesystem::path &PositionalFile::path() const {
+    return file_path;
+}
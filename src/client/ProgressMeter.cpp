@@ -0,0 +1,124 @@
+#include "client/ProgressMeter.hpp"
+#include "Utils.hpp"
+
+#include <fmt/format.h>
+#include <indicators/indeterminate_progress_bar.hpp>
+#include <indicators/progress_bar.hpp>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+
+namespace {
+    std::string scaledBytes(double bytes) {
+        constexpr std::array<const char *, 5> UNITS{"B", "kiB", "MiB", "GiB", "TiB"};
+        std::size_t unit{0};
+        for (; bytes >= 1024.0 && unit + 1 < UNITS.size(); ++unit) {
+            bytes /= 1024.0;
+        }
+        return unit == 0 ? fmt::format("{:.0f} {}", bytes, UNITS[unit]) : fmt::format("{:.1f} {}", bytes, UNITS[unit]);
+    }
+
+    double perSecond(std::size_t amount, ProgressMeter::Clock::duration elapsed) {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0.0 ? static_cast<double>(amount) / seconds : 0.0;
+    }
+
+    indicators::IndeterminateProgressBar createIndeterminateProgressBar(const std::string &initial_text) {
+        return indicators::IndeterminateProgressBar{
+                indicators::option::BarWidth{40},
+                indicators::option::Start{"["},
+                indicators::option::Fill{"·"},
+                indicators::option::Lead{"<==>"},
+                indicators::option::End{"]"},
+                indicators::option::PrefixText{initial_text},
+                indicators::option::ForegroundColor{indicators::Color::white},
+                indicators::option::FontStyles{std::vector<indicators::FontStyle>{indicators::FontStyle::bold}}};
+    }
+}
+
+
+ProgressMeter::ProgressMeter(std::string label, std::size_t total, std::size_t done, bool quiet)
+        : label(std::move(label)), total(total), done_before(done), started_at(Clock::now()), done(done) {
+    if (quiet) {
+        return;
+    }
+    renderer = std::jthread{[this](std::stop_token stop_token) {
+        if (this->total > 0) {
+            auto bar = createProgressBar(this->label);
+            render(bar, stop_token);
+        } else {
+            auto bar = createIndeterminateProgressBar(this->label);
+            render(bar, stop_token);
+        }
+    }};
+}
+
+std::size_t ProgressMeter::value() const noexcept {
+    return done.load(std::memory_order_relaxed);
+}
+
+void ProgressMeter::finish(const std::string &text) {
+    if (!renderer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock{mutex};
+        final_text = text;
+    }
+    renderer.request_stop();
+    renderer.join();
+}
+
+std::string ProgressMeter::throughputToHumanReadable(double bytes_per_second) {
+    return scaledBytes(bytes_per_second) + "/s";
+}
+
+// Bar is touched only by this thread. Percentage stays below 100 until the end, since a full bar is completed
+// and would not be redrawn with the final text.
+template<class Bar>
+void ProgressMeter::render(Bar &bar, std::stop_token stop_token) {
+    constexpr bool is_determinate = std::is_same_v<Bar, indicators::ProgressBar>;
+    std::size_t previous{done_before};
+    Clock::time_point previous_at{started_at};
+    std::unique_lock lock{mutex};
+    while (!refresh.wait_for(lock, stop_token, REFRESH_INTERVAL, [&] { return stop_token.stop_requested(); })) {
+        lock.unlock();
+        auto now = Clock::now();
+        std::size_t current = value();
+        bar.set_option(indicators::option::PostfixText{describe(current, previous, now - previous_at, now)});
+        if constexpr (is_determinate) {
+            bar.set_progress(std::min<std::size_t>(99, 100 * current / total));
+        } else {
+            bar.tick();
+        }
+        previous = current;
+        previous_at = now;
+        lock.lock();
+    }
+    if (!final_text) {
+        return;
+    }
+    std::size_t current = value();
+    std::string summary = throughputToHumanReadable(perSecond(current - done_before, Clock::now() - started_at)) +
+                          " average";
+    if (!is_determinate) {
+        summary = scaledBytes(static_cast<double>(current)) + ", " + summary;
+    }
+    bar.set_option(indicators::option::PrefixText{*final_text});
+    bar.set_option(indicators::option::PostfixText{summary});
+    if constexpr (is_determinate) {
+        bar.set_progress(100);
+    } else {
+        bar.mark_as_completed();
+    }
+}
+
+std::string ProgressMeter::describe(std::size_t current, std::size_t previous, Clock::duration since_previous,
+                                    Clock::time_point now) const {
+    std::string throughput = fmt::format("{} now, {} average",
+                                         throughputToHumanReadable(perSecond(current - previous, since_previous)),
+                                         throughputToHumanReadable(perSecond(current - done_before, now - started_at)));
+    return total > 0 ? throughput : scaledBytes(static_cast<double>(current)) + ", " + throughput;
+}
@@ -0,0 +1,59 @@
+#include "client/RangeWriter.hpp"
+
+#include <cstring>
+#include <new>
+
+
+RangeWriter::RangeWriter(PositionalFile &file, bool limits_page_cache)
+        : file(file), limits_page_cache(limits_page_cache),
+          buffer(static_cast<char *>(std::aligned_alloc(PositionalFile::DIRECT_IO_ALIGNMENT, WRITE_SIZE)), &std::free) {
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+}
+
+// Buffer always holds a part of a single block, from buffer_offset up to at most the block's end.
+std::size_t RangeWriter::write(std::size_t offset, std::string_view data) {
+    std::size_t written{0};
+    if (buffered > 0 && offset != buffer_offset + buffered) {
+        written += flush();
+    }
+    if (buffered == 0) {
+        buffer_offset = offset;
+    }
+    while (!data.empty()) {
+        std::size_t block_end = (buffer_offset / WRITE_SIZE + 1) * WRITE_SIZE;
+        std::size_t size = std::min(data.size(), block_end - buffer_offset - buffered);
+        std::memcpy(buffer.get() + buffered, data.data(), size);
+        buffered += size;
+        data.remove_prefix(size);
+        if (buffer_offset + buffered == block_end) {
+            written += writeBuffer();
+            buffer_offset = block_end;
+        }
+    }
+    return written;
+}
+
+std::size_t RangeWriter::flush() {
+    std::size_t written = buffered > 0 ? writeBuffer() : 0;
+    for (; !written_back.empty(); written_back.pop_front()) {
+        file.evict(written_back.front());
+    }
+    return written;
+}
+
+std::size_t RangeWriter::writeBuffer() {
+    ByteRange block{buffer_offset, buffer_offset + buffered};
+    file.write(block.begin, {buffer.get(), buffered});
+    buffered = 0;
+    if (limits_page_cache) {
+        file.startWriteBack(block);
+        written_back.push_back(block);
+        if (written_back.size() > CACHE_WINDOW) {
+            file.evict(written_back.front());
+            written_back.pop_front();
+        }
+    }
+    return block.size();
+}
@@ -0,0 +1,39 @@
+#include "client/ReconnectPolicy.hpp"
+#include "Utils.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+
+ReconnectBackoff::ReconnectBackoff(ReconnectPolicy policy) : policy(policy), delay(policy.initial_delay) {}
+
+std::optional<std::chrono::milliseconds> ReconnectBackoff::nextDelay() {
+    if (attempts >= policy.max_attempts) {
+        return std::nullopt;
+    }
+    ++attempts;
+    std::chrono::milliseconds current = delay;
+    delay = std::min(2 * delay, policy.max_delay);
+    auto max_jitter = static_cast<std::size_t>(static_cast<double>(current.count()) * JITTER_FRACTION);
+    auto jitter = static_cast<std::chrono::milliseconds::rep>(getRandom(0, max_jitter));
+    return current + std::chrono::milliseconds{jitter};
+}
+
+bool ReconnectBackoff::waitForNextAttempt(std::string_view reason) {
+    auto next_delay = nextDelay();
+    if (!next_delay) {
+        return false;
+    }
+    std::cout << fmt::format("Connection lost ({}), reconnecting in {} ms (attempt {}/{})...", reason,
+                             next_delay->count(), attempts, policy.max_attempts) << std::endl;
+    std::this_thread::sleep_for(*next_delay);
+    return true;
+}
+
+void ReconnectBackoff::reset() {
+    attempts = 0;
+    delay = policy.initial_delay;
+}
@@ -0,0 +1,41 @@
+#include "client/ResumeCheckpoint.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+
+std::optional<ResumeCheckpoint> ResumeCheckpoint::load(const std::filesystem::path &checkpoint_path) {
+    std::ifstream file{checkpoint_path};
+    if (!file) {
+        return std::nullopt;
+    }
+    try {
+        nlohmann::json json = nlohmann::json::parse(file);
+        ResumeCheckpoint checkpoint{.file_id = json.at("file_id").get<std::string>(),
+                                    .partial_path = json.at("partial_path").get<std::string>(),
+                                    .offset = json.at("offset").get<std::size_t>()};
+        if (!std::filesystem::is_regular_file(checkpoint.partial_path)) {
+            return std::nullopt;
+        }
+        checkpoint.offset = std::min(checkpoint.offset, std::filesystem::file_size(checkpoint.partial_path));
+        return checkpoint;
+    } catch (const nlohmann::json::exception &) {
+        return std::nullopt;
+    }
+}
+
+void ResumeCheckpoint::save(const std::filesystem::path &checkpoint_path) const {
+    nlohmann::json json{};
+    json["file_id"] = file_id;
+    json["partial_path"] = partial_path.string();
+    json["offset"] = offset;
+    std::filesystem::path tmp_path = checkpoint_path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file{tmp_path, std::ios::trunc};
+        file << json.dump();
+    }
+    std::filesystem::rename(tmp_path, checkpoint_path);
+}
@@ -0,0 +1,142 @@
+#include "client/TransferStats.hpp"
+#include "Utils.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+#include <sys/resource.h>
+
+
+namespace {
+    constexpr std::size_t KIB{1024};
+
+    std::chrono::microseconds processCpuTime() {
+        rusage usage{};
+        if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+            return {};
+        }
+        auto toDuration = [](const timeval &time) {
+            return std::chrono::seconds{time.tv_sec} + std::chrono::microseconds{time.tv_usec};
+        };
+        return toDuration(usage.ru_utime) + toDuration(usage.ru_stime);
+    }
+
+    // Writing 5 to clear_refs resets the high water mark of the resident set size (Linux 4.0 and later).
+    void resetPeakRss() {
+        std::ofstream clear_refs{"/proc/self/clear_refs"};
+        clear_refs << "5" << std::flush;
+    }
+
+    std::size_t peakRss() {
+        std::ifstream status{"/proc/self/status"};
+        for (std::string key; status >> key;) {
+            if (key == "VmHWM:") {
+                std::size_t kib{0};
+                status >> kib;
+                return kib * KIB;
+            }
+            status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        rusage usage{};
+        return ::getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<std::size_t>(usage.ru_maxrss) * KIB : 0;
+    }
+
+    double seconds(std::chrono::nanoseconds duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+
+std::string_view toString(StatsFormat format) {
+    switch (format) {
+        case StatsFormat::text:
+            return "text";
+        case StatsFormat::json:
+            return "json";
+    }
+    return "unknown";
+}
+
+std::optional<StatsFormat> parseStatsFormat(std::string_view name) {
+    for (auto format: {StatsFormat::text, StatsFormat::json}) {
+        if (name == toString(format)) {
+            return format;
+        }
+    }
+    return std::nullopt;
+}
+
+double TransferStats::Phase::throughput() const {
+    double elapsed = seconds(wall_time);
+    return elapsed > 0.0 ? static_cast<double>(bytes) / elapsed : 0.0;
+}
+
+TransferStats::Measurement::Measurement(TransferStats *stats, std::string name)
+        : stats(stats), name(std::move(name)) {
+    if (!stats) {
+        return;
+    }
+    resetPeakRss();
+    cpu_time_at_start = processCpuTime();
+    started_at = Clock::now();
+}
+
+TransferStats::Measurement::~Measurement() {
+    stop();
+}
+
+void TransferStats::Measurement::stop() {
+    if (!stats) {
+        return;
+    }
+    stats->record({.name = std::move(name),
+                   .wall_time = Clock::now() - started_at,
+                   .cpu_time = processCpuTime() - cpu_time_at_start,
+                   .bytes = bytes,
+                   .peak_rss = peakRss()});
+    stats = nullptr;
+}
+
+void TransferStats::record(const Phase &phase) {
+    auto same = std::ranges::find(recorded, phase.name, &Phase::name);
+    if (same == recorded.end()) {
+        recorded.push_back(phase);
+        return;
+    }
+    same->wall_time += phase.wall_time;
+    same->cpu_time += phase.cpu_time;
+    same->bytes += phase.bytes;
+    same->peak_rss = std::max(same->peak_rss, phase.peak_rss);
+}
+
+const std::vector<TransferStats::Phase> &TransferStats::phases() const {
+    return recorded;
+}
+
+nlohmann::json TransferStats::toJson() const {
+    nlohmann::json phases = nlohmann::json::array();
+    for (const auto &phase: recorded) {
+        phases.push_back({{"name", phase.name},
+                          {"wall_time_s", seconds(phase.wall_time)},
+                          {"cpu_time_s", seconds(phase.cpu_time)},
+                          {"bytes", phase.bytes},
+                          {"throughput_bytes_per_s", phase.throughput()},
+                          {"peak_rss_bytes", phase.peak_rss}});
+    }
+    return {{"phases", std::move(phases)}};
+}
+
+std::string TransferStats::toText() const {
+    std::string text = fmt::format("{:<14}{:>12}{:>12}{:>14}{:>12}{:>14}\n", "phase", "wall time", "bytes",
+                                   "throughput", "CPU time", "peak RSS");
+    for (const auto &phase: recorded) {
+        text += fmt::format("{:<14}{:>10.3f} s{:>12}{:>12}/s{:>10.3f} s{:>14}\n", phase.name,
+                            seconds(phase.wall_time), bytesToHumanReadable(phase.bytes),
+                            bytesToHumanReadable(static_cast<std::size_t>(phase.throughput())),
+                            seconds(phase.cpu_time), bytesToHumanReadable(phase.peak_rss));
+    }
+    return text;
+}
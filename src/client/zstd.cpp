@@ -12,7 +12,8 @@ void assertOk(std::size_t error_code) {
 }
 
 size_t
-zstd::compress(std::istream &input_stream, std::ostream &output_stream, std::function<void()> update_callback) {
+zstd::compress(std::istream &input_stream, std::ostream &output_stream,
+               std::function<void(std::size_t)> update_callback) {
     int const cLevel = 6;
     std::string read_buffer(ZSTD_DStreamInSize(), '\0');
     std::string write_buffer(ZSTD_DStreamOutSize(), '\0');
@@ -23,7 +24,8 @@ zstd::compress(std::istream &input_stream, std::ostream &output_stream, std::fun
         throw ZSTDException{"ZSTD_createCCtx() failed!"};
     }
     assertOk(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, cLevel));
-    assertOk(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1));
+    // archive is checked chunk by chunk during the transfer already, its own checksum would only hash it once more
+    assertOk(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 0));
     assertOk( ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only) );
 
     std::size_t bytes_written_to_stream{0};
@@ -45,7 +47,7 @@ zstd::compress(std::istream &input_stream, std::ostream &output_stream, std::fun
         if (input.pos != input.size) {
             throw ZSTDException("Impossible: zstd only returns 0 when the input is completely consumed!");
         }
-        update_callback();
+        update_callback(read);
     }
     return bytes_written_to_stream;
 }
@@ -84,3 +86,24 @@ std::size_t zstd::decompress(std::ostream &decompressed_out_stream, std::istream
     }
     return bytes_written_to_stream;
 }
+
+std::size_t zstd::decompress(std::ostream &decompressed_out_stream, std::string_view compressed) {
+    std::string write_buffer(ZSTD_DStreamOutSize(), '\0');
+
+    ZSTD_DCtx* const dctx = ZSTD_createDCtx();
+    if (dctx == nullptr)  {
+        throw ZSTDException{"ZSTD_createDCtx() failed!"};
+    }
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> ctx_free_guard{dctx, ZSTD_freeDCtx};
+
+    std::size_t bytes_written_to_stream = 0;
+    ZSTD_inBuffer input = { compressed.data(), compressed.size(), 0 };
+    while (input.pos < input.size) {
+        ZSTD_outBuffer output = {write_buffer.data(), write_buffer.size(), 0 };
+        size_t const ret = ZSTD_decompressStream(dctx, &output , &input);
+        assertOk(ret);
+        bytes_written_to_stream += output.pos;
+        decompressed_out_stream.write(write_buffer.data(), static_cast<std::streamsize>(output.pos));
+    }
+    return bytes_written_to_stream;
+}
@@ -1,6 +1,11 @@
 #include "server/ServerArgParser.hpp"
 
 #include <argparse/argparse.hpp>
+#include <fmt/format.h>
+
+void addDeadlineArgument(argparse::ArgumentParser &program, const std::string &name, std::chrono::seconds default_value,
+                         const std::string &help);
+std::chrono::seconds getDeadline(const argparse::ArgumentParser &program, const std::string &name);
 
 
 ServerArgs parseServerArgs(int argc, char **argv) {
@@ -25,6 +30,38 @@ ServerArgs parseServerArgs(int argc, char **argv) {
             .default_value(static_cast<unsigned int>(ServerArgs::DEFAULT_CLIENT_TIMEOUT.count()))
             .help(R"(Path to the json file of this structure: { "nouns" : [...], "adjectives": [...] })");
 
+    addDeadlineArgument(program, "--handshake_timeout", SessionDeadlines::DEFAULT_HANDSHAKE_TIMEOUT,
+                        "Seconds a new connection has to complete the TLS handshake.");
+    addDeadlineArgument(program, "--first_message_timeout", SessionDeadlines::DEFAULT_FIRST_MESSAGE_TIMEOUT,
+                        "Seconds a connected client has to send its send/receive request.");
+    addDeadlineArgument(program, "--confirmation_timeout", SessionDeadlines::DEFAULT_RECEIVER_CONFIRMATION_TIMEOUT,
+                        "Seconds the receiver has to confirm the transfer after getting file metadata.");
+    addDeadlineArgument(program, "--idle_timeout", SessionDeadlines::DEFAULT_CHUNK_IDLE_TIMEOUT,
+                        "Seconds a single chunk may take to be relayed from sender to receiver.");
+    addDeadlineArgument(program, "--transfer_timeout", SessionDeadlines::DEFAULT_TOTAL_TRANSFER_TIMEOUT,
+                        "Seconds the whole transfer may take. 0 means no limit.");
+
+    program.add_argument("--max_frame_size")
+            .default_value(static_cast<unsigned int>(DEFAULT_FRAME_SIZE / 1024))
+            .scan<'u', unsigned int>()
+            .help(fmt::format("Biggest frame (in KiB) a client may negotiate. Rounded down to power of two, "
+                              "between {} and {}.", MIN_FRAME_SIZE / 1024, MAX_FRAME_SIZE / 1024));
+
+    program.add_argument("--congestion_control")
+            .default_value(std::string{})
+            .help("TCP congestion control of relayed connections, e.g. bbr. Kernel's default when empty or not allowed.");
+
+    program.add_argument("--limit_rate")
+            .default_value(0u)
+            .scan<'u', unsigned int>()
+            .help("Maximum rate in KiB/s every transfer is relayed at, all its streams together. 0 means no limit.");
+
+    program.add_argument("--plaintext")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Serve plain TCP instead of TLS. Only for deployments where TLS is terminated "
+                  "in front of the server (e.g. by a proxy), or for local benchmarks.");
+
     try {
         program.parse_args(argc, argv);
     } catch (const std::runtime_error &err) {
@@ -37,5 +74,27 @@ ServerArgs parseServerArgs(int argc, char **argv) {
     auto port = program.get<unsigned short>("-p");
     std::chrono::seconds timeout{program.get<unsigned int>("-t")};
 
-    return {.certs_directory = std::move(cert_dir), .port = port, .client_timeout = timeout};
+    SessionDeadlines deadlines{.handshake = getDeadline(program, "--handshake_timeout"),
+            .first_message = getDeadline(program, "--first_message_timeout"),
+            .receiver_confirmation = getDeadline(program, "--confirmation_timeout"),
+            .chunk_idle = getDeadline(program, "--idle_timeout"),
+            .total_transfer = getDeadline(program, "--transfer_timeout")};
+
+    return {.certs_directory = std::move(cert_dir), .port = port, .client_timeout = timeout, .deadlines = deadlines,
+            .plaintext = program.get<bool>("--plaintext"),
+            .max_frame_size = normalizeFrameSize(std::size_t{program.get<unsigned int>("--max_frame_size")} * 1024),
+            .tuning_profile = {.congestion_control = program.get<std::string>("--congestion_control")},
+            .rate_limit = std::size_t{program.get<unsigned int>("--limit_rate")} * 1024};
+}
+
+void addDeadlineArgument(argparse::ArgumentParser &program, const std::string &name, std::chrono::seconds default_value,
+                         const std::string &help) {
+    program.add_argument(name)
+            .default_value(static_cast<unsigned int>(default_value.count()))
+            .scan<'u', unsigned int>()
+            .help(help);
+}
+
+std::chrono::seconds getDeadline(const argparse::ArgumentParser &program, const std::string &name) {
+    return std::chrono::seconds{program.get<unsigned int>(name)};
 }
@@ -6,93 +6,494 @@
 #include <spdlog/spdlog.h>
 #include <boost/lexical_cast.hpp>
 
+#include <limits>
 
-ServerSideClientSession::ServerSideClientSession(tcp::socket socket, asio::ssl::context &context,
-                                                 std::weak_ptr<SessionsManager> sessions_manager)
-        : SocketBase({std::move(socket), context}), sessions_manager(std::move(sessions_manager)),
-          endpoint(boost::lexical_cast<std::string>(socket_.next_layer().remote_endpoint())) {
+
+template<class Stream_t>
+ServerSideClientSession<Stream_t>::ServerSideClientSession(tcp::socket socket,
+                                                           typename StreamPolicy<Stream_t>::Context &context,
+                                                           std::weak_ptr<SessionsManager_t> sessions_manager)
+        : SocketBase<Stream_t>(StreamPolicy<Stream_t>::createStream(std::move(socket), context)),
+          sessions_manager(std::move(sessions_manager)),
+          endpoint(boost::lexical_cast<std::string>(this->socket_.lowest_layer().remote_endpoint())),
+          phase_timer(this->socket_.get_executor()), transfer_timer(this->socket_.get_executor()),
+          pacing_timer(this->socket_.get_executor()) {
+    this->socket_.lowest_layer().set_option(tcp::no_delay(true)); // control frames must not wait for peer's ACKs
+    if (auto manager = this->sessions_manager.lock()) {
+        deadlines = manager->sessionDeadlines();
+        frame_size_limit = manager->maxFrameSize();
+        tuning_profile = manager->tuningProfile();
+    }
 }
 
-ServerSideClientSession::~ServerSideClientSession() {
+template<class Stream_t>
+ServerSideClientSession<Stream_t>::~ServerSideClientSession() {
     spdlog::debug("ServerSideClientSession {} is being destroyed.", endpoint);
 }
 
 
-void ServerSideClientSession::start() {
-    socket_.handshake(boost::asio::ssl::stream_base::server);
-    asyncReadMessage(MAX_FIRST_MESSAGE_SIZE, callback(&ServerSideClientSession::handleFirstRead));
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::start() {
+    armDeadline(phase_timer, SessionPhase::handshake);
+    StreamPolicy<Stream_t>::asyncHandshake(this->socket_, boost::asio::ssl::stream_base::server,
+                                           [this, self = sharedFromThis()](error_code ec) {
+        phase_timer.cancel();
+        if (ec) {
+            spdlog::warn("[ServerSideClientSession] {} handshake failed: {}", endpoint, ec.message());
+            return;
+        }
+        armDeadline(phase_timer, SessionPhase::first_message);
+        this->asyncAcceptProtocol(MAX_FIRST_MESSAGE_SIZE, frame_size_limit,
+                                  callback(&ServerSideClientSession::handleFirstRead));
+    });
 }
 
-void ServerSideClientSession::handleFirstRead(std::string_view content) {
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::handleFirstRead(const Frame &frame) {
+    phase_timer.cancel();
+    if (this->isFramed() && frame.type != FrameType::metadata) {
+        this->safeDisconnect(fmt::format("Expected {} frame, got {}.", toString(FrameType::metadata), toString(frame.type)));
+        return;
+    }
     try {
         spdlog::debug("[ServerSideClientSession] {} extracting json...", endpoint);
-        nlohmann::json json = InitSessionMessage::create(content);
+        nlohmann::json json = InitSessionMessage::create(frame.payload);
         spdlog::info("[ServerSideClientSession] {} registering {} session...", endpoint,
                      json[InitSessionMessage::ACTION_KEY].get<std::string>());
         registerSession(std::move(json));
         spdlog::debug("[ServerSideClientSession] {} session registered.", endpoint);
     } catch (const SessionsManagerException &e) {
         std::this_thread::sleep_for(std::chrono::seconds(3)); // to prevent DDOS
-        safeDisconnect(e.what());
+        this->safeDisconnect(e.what());
     } catch (const DropFileBaseException &e) {
-        safeDisconnect(e.what());
+        this->safeDisconnect(e.what());
     } catch (const boost::wrapexcept<boost::system::system_error> &e) {
         spdlog::warn("Boost exception: {}", e.code().message());
     }
 }
 
-void ServerSideClientSession::registerSession(nlohmann::json json) {
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::registerSession(nlohmann::json json) {
     if (auto manager = sessions_manager.lock()) {
-        if (json[InitSessionMessage::ACTION_KEY] == "send") {
-            std::string session_code = manager->registerSender(
-                    std::static_pointer_cast<ServerSideClientSession>(shared_from_this()), std::move(json));
+        if (InitSessionMessage::isStreamJoin(json)) {
+            joinStream(*manager, std::move(json));
+        } else if (json[InitSessionMessage::ACTION_KEY] == "send") {
+            session_code = manager->registerSender(sharedFromThis(), std::move(json));
             nlohmann::json response{};
             response[InitSessionMessage::CODE_WORDS_KEY] = session_code;
-            send(response.dump());
+            this->sendFrame(FrameType::metadata, response.dump());
         } else {
-            std::string code_words_key = json[InitSessionMessage::CODE_WORDS_KEY];
-            auto [sender, session_metadata] = manager->getSenderWithMetadata(code_words_key);
-            receiveFile(std::move(sender), std::move(session_metadata));
+            session_code = json[InitSessionMessage::CODE_WORDS_KEY];
+            auto [sender, session_metadata] = manager->getSenderWithMetadata(session_code);
+            if (InitSessionMessage::isPipe(session_metadata) && !InitSessionMessage::acceptsPipe(json)) {
+                sender->safeDisconnect("Receiver cannot take piped data.");
+                this->safeDisconnect("Sender pipes data of unknown length, which this client cannot receive.");
+                return;
+            }
+            resume_offset = acceptedResumeOffset(json, session_metadata);
+            verifies_chunks = InitSessionMessage::verifiesChunks(json);
+            sender_trails_hashes = InitSessionMessage::chunkSize(session_metadata).has_value();
+            receiveFile(std::move(sender), std::move(session_metadata), InitSessionMessage::isAutoAccepted(json));
         }
     } else {
-        safeDisconnect("Internal error"); // should not ever happen
+        this->safeDisconnect("Internal error"); // should not ever happen
     }
 }
 
-void
-ServerSideClientSession::receiveFile(std::shared_ptr<ServerSideClientSession> sender, nlohmann::json session_metadata) {
-    send(session_metadata.dump());
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::receiveFile(std::shared_ptr<ServerSideClientSession> sender,
+                                                    nlohmann::json session_metadata, bool auto_accept) {
+    paired_sender = sender;
+    sender->paired_receiver = sharedFromThis();
+    transfer_metadata = std::move(session_metadata);
+    transfer_metadata[InitSessionMessage::RESUME_OFFSET_KEY] = resume_offset;
+    relays_pipe = InitSessionMessage::isPipe(transfer_metadata);
+    transfer_size = relays_pipe ? std::numeric_limits<std::size_t>::max() // until its END frame
+                                : InitSessionMessage::stripeOf(transfer_metadata, 0).size() - resume_offset;
+    this->sendFrame(FrameType::metadata, transfer_metadata.dump());
+    if (auto_accept) {
+        spdlog::info("[ServerSideClientSession] {} accepted the transfer in advance.", endpoint);
+        startTransfer(sender);
+        return;
+    }
     spdlog::info("[ServerSideClientSession] Waiting for receiver's '{}' confirmation...", endpoint);
-    receiveACK();
-    sender->sendACK();
+    armDeadline(phase_timer, SessionPhase::receiver_confirmation);
+    this->asyncReadFrame(MAX_CONFIRMATION_SIZE, [this, self = sharedFromThis(), sender](const Frame &response) {
+        handleReceiverConfirmation(response, sender);
+    });
+}
+
+// Streams are paired one-to-one, so every stripe is relayed the same way as the whole file is in a single stream.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::joinStream(SessionsManager_t &manager, nlohmann::json json) {
+    is_stripe = true;
+    session_code = json[InitSessionMessage::CODE_WORDS_KEY];
+    transfer_metadata = std::move(json);
+    auto counterpart = manager.joinStream(sharedFromThis(), transfer_metadata);
+    if (!counterpart) {
+        spdlog::debug("[ServerSideClientSession] {} waits for the other end of stream {} of '{}'.", endpoint,
+                      transfer_metadata[InitSessionMessage::STREAM_INDEX_KEY].get<std::size_t>(), session_code);
+        return;
+    }
+    if (transfer_metadata[InitSessionMessage::ACTION_KEY] == "send") {
+        (*counterpart)->receiveStripe(sharedFromThis());
+    } else {
+        receiveStripe(*counterpart);
+    }
+}
 
-    spdlog::info("[ServerSideClientSession] {} sending '{}' file to {}, size: {}",
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::receiveStripe(const std::shared_ptr<ServerSideClientSession> &sender) {
+    ByteRange stripe = InitSessionMessage::stripe(transfer_metadata);
+    if (stripe != InitSessionMessage::stripe(sender->transfer_metadata)) {
+        spdlog::warn("[ServerSideClientSession] {} and {} disagree on stripe of '{}'.", endpoint, sender->endpoint,
+                     session_code);
+        sender->safeDisconnect("Peers disagree on the stripe.");
+        this->safeDisconnect("Peers disagree on the stripe.");
+        return;
+    }
+    paired_sender = sender;
+    sender->paired_receiver = sharedFromThis();
+    transfer_size = stripe.size();
+    verifies_chunks = InitSessionMessage::chunkSize(transfer_metadata).has_value();
+    sender_trails_hashes = InitSessionMessage::chunkSize(sender->transfer_metadata).has_value();
+    startTransfer(sender);
+}
+
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::handleReceiverConfirmation(
+        const Frame &response, const std::shared_ptr<ServerSideClientSession> &sender) {
+    phase_timer.cancel();
+    if (!this->isACK(response)) {
+        spdlog::info("[ServerSideClientSession] {} declined the transfer.", endpoint);
+        sender->safeDisconnect("Receiver declined the transfer.");
+        return;
+    }
+    startTransfer(sender);
+}
+
+// Receiver may still decline an auto-accepted transfer, then its ABORT ends the transfer in readReceiverControlFrame.
+// Sender's ACK carries the offset to resume from, empty when the whole file has to be sent.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::startTransfer(const std::shared_ptr<ServerSideClientSession> &sender) {
+    sender->queueFrame(FrameType::ack, resume_offset > 0 ? std::to_string(resume_offset) : std::string{});
+    if (!this->isFramed()) {
+        grantSenderCredit(sender, 2 * sender->maxFrameSize());
+    }
+    transfer_started = true;
+
+    spdlog::info("[ServerSideClientSession] {} sending {} of '{}' to {}, starting at byte: {}",
                  sender->endpoint,
-                 session_metadata[InitSessionMessage::FILENAME_KEY].get<std::string>(),
+                 relays_pipe ? std::string{"piped data"} : bytesToHumanReadable(transfer_size),
+                 session_code,
                  endpoint,
-                 bytesToHumanReadable(session_metadata[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>()));
+                 is_stripe ? InitSessionMessage::stripe(transfer_metadata).begin : resume_offset);
+
+    if (auto manager = sessions_manager.lock()) {
+        rate_limiter = manager->rateLimiter(session_code);
+    }
+    tuner.emplace(this->nativeHandle(), tuning_profile);
+    sender->tuner.emplace(sender->nativeHandle(), tuning_profile);
+    armDeadline(transfer_timer, SessionPhase::total_transfer);
+    readReceiverControlFrame(sender);
+    relayNextChunk(sender, transfer_size);
+}
 
-    std::size_t total_received_bytes{0};
-    std::size_t expected_bytes = session_metadata[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>();
-    while (total_received_bytes < expected_bytes) {
-        std::string data = sender->receive();
-        std::size_t left_to_transfer = expected_bytes - total_received_bytes;
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::relayNextChunk(std::shared_ptr<ServerSideClientSession> sender,
+                                                       std::size_t left_to_transfer) {
+    if (transfer_finished) {
+        return;
+    }
+    armDeadline(phase_timer, SessionPhase::chunk_idle);
+    if (left_to_transfer == 0 && !sender_trails_hashes) {
+        return; // receiver's final ACK is handled by readReceiverControlFrame
+    }
+    sender->asyncReadFrame(sender->maxFrameSize(), [this, self = sharedFromThis(), sender, left_to_transfer](
+            const Frame &frame) {
+        if (transfer_finished) {
+            return;
+        }
+        if (frame.type == FrameType::chunk_hashes) {
+            relayChunkHashes(sender, frame.payload, left_to_transfer);
+            return;
+        }
+        if (frame.type == FrameType::direct && !is_stripe && left_to_transfer == transfer_size) {
+            watchDirectTransfer(sender);
+            return;
+        }
+        if (frame.type == FrameType::end && relays_pipe && frame.payload.size() <= MAX_CONFIRMATION_SIZE) {
+            relayEnd(sender, frame.payload);
+            return;
+        }
+        if (frame.type != FrameType::data) {
+            spdlog::info("[ServerSideClientSession] {} interrupted the transfer with {} frame.", sender->endpoint,
+                         toString(frame.type));
+            transfer_finished = true;
+            this->safeDisconnect("Sender aborted the transfer.");
+            return;
+        }
+        if (left_to_transfer == 0) {
+            spdlog::warn("[ServerSideClientSession] {} sent more data than it has announced.", sender->endpoint);
+            sender->close();
+            return;
+        }
+        std::string_view data = frame.payload;
         std::size_t write_size = std::min(left_to_transfer, data.size());
-        send(std::string_view{data.data(), write_size});
+        recordRelayed(sender, write_size);
+        relayPayload(sender, data.substr(0, write_size), data.size(), left_to_transfer - write_size);
+    });
+}
+
+// Sender is not read any further, the receiver answers END with its final ACK.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::relayEnd(std::shared_ptr<ServerSideClientSession> sender,
+                                                 std::string_view checksum) {
+    this->asyncSendFrame(FrameType::end, checksum, [this, self = sharedFromThis(), sender] {
+        relayNextChunk(sender, 0);
+    });
+}
 
-        total_received_bytes += write_size;
+// Chunk hashes trail the data of their chunks and do not count towards transfer size, nor credit.
+// Since the last of them comes after all the data, the sender is read until the receiver sends its final ACK.
+// Receivers that have not asked for them (legacy ones) would not understand them, so they are dropped.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::relayChunkHashes(std::shared_ptr<ServerSideClientSession> sender,
+                                                         std::string_view payload, std::size_t left_to_transfer) {
+    if (!verifies_chunks || !this->isFramed() || payload.size() > this->maxFrameSize()) {
+        relayNextChunk(std::move(sender), left_to_transfer);
+        return;
     }
-    receiveACK();
-    sender->sendACK();
+    this->asyncSendFrame(FrameType::chunk_hashes, payload, [this, self = sharedFromThis(), sender, left_to_transfer] {
+        relayNextChunk(sender, left_to_transfer);
+    });
+}
 
-    spdlog::info("[ServerSideClientSession] {} finished sending '{}' file to {}",
-                 sender->endpoint,
-                 session_metadata[InitSessionMessage::FILENAME_KEY].get<std::string>(),
-                 endpoint);
+// Both ends of the relay are tuned the same way the clients tune theirs, by the relayed throughput.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::recordRelayed(const std::shared_ptr<ServerSideClientSession> &sender,
+                                                      std::size_t bytes) {
+    auto now = SocketTuner::Clock::now();
+    for (ServerSideClientSession *session: {this, sender.get()}) {
+        if (session->tuner && session->tuner->recordTransferred(bytes, now)) {
+            spdlog::info("[ServerSideClientSession] {} tuned: {}", session->endpoint,
+                         toString(session->tuner->report()));
+        }
+    }
 }
 
-SocketBase::MessageHandler ServerSideClientSession::callback(ServerSideClientSession::PMF pmf) {
-    return [this, pmf](std::string_view message) {
-        std::invoke(pmf, this, message);
+// Peers may have negotiated different frame sizes, so single sender's frame can become a few receiver's ones.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::relayPayload(std::shared_ptr<ServerSideClientSession> sender,
+                                                     std::string_view payload, std::size_t sender_frame_size,
+                                                     std::size_t left_after_payload) {
+    std::size_t frame_size = std::min(payload.size(), this->maxFrameSize());
+    this->asyncSend(payload.substr(0, frame_size), [this, self = sharedFromThis(), sender,
+            rest = payload.substr(frame_size), sender_frame_size, left_after_payload] {
+        if (!rest.empty()) {
+            relayPayload(sender, rest, sender_frame_size, left_after_payload);
+            return;
+        }
+        if (!this->isFramed()) {
+            grantSenderCredit(sender, sender_frame_size);
+        }
+        paceNextChunk(sender, sender_frame_size, left_after_payload);
+    });
+}
+
+// Rate limit holds the sender back by not reading its next frame until the bucket allows it.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::paceNextChunk(std::shared_ptr<ServerSideClientSession> sender,
+                                                      std::size_t relayed, std::size_t left_to_transfer) {
+    auto pause = rate_limiter ? rate_limiter->reserve(relayed, RateLimiter::Clock::now())
+                              : RateLimiter::Clock::duration::zero();
+    if (pause <= RateLimiter::Clock::duration::zero()) {
+        relayNextChunk(std::move(sender), left_to_transfer);
+        return;
+    }
+    phase_timer.cancel(); // idle deadline is armed again once the pause is over
+    pacing_timer.expires_after(pause);
+    pacing_timer.async_wait([this, self = sharedFromThis(), sender, left_to_transfer](error_code ec) {
+        if (!ec) {
+            relayNextChunk(sender, left_to_transfer);
+        }
+    });
+}
+
+// Clients have connected to each other (see DirectLink.hpp), so only the receiver's final ACK is relayed,
+// with no idle deadline. Sender is still read, so that it can interrupt the transfer the usual way.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::watchDirectTransfer(std::shared_ptr<ServerSideClientSession> sender) {
+    phase_timer.cancel();
+    spdlog::info("[ServerSideClientSession] {} sends '{}' directly to {}", sender->endpoint, session_code, endpoint);
+    sender->asyncReadFrame(MAX_CONFIRMATION_SIZE, [this, self = sharedFromThis()](const Frame &frame) {
+        if (transfer_finished) {
+            return;
+        }
+        spdlog::info("[ServerSideClientSession] Direct transfer of '{}' interrupted with {} frame.", session_code,
+                     toString(frame.type));
+        transfer_finished = true;
+        this->safeDisconnect("Sender aborted the transfer.");
+    });
+}
+
+// Framed receiver grants credit and sends final ACK with its checksum on its own, while the data is still flowing.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::readReceiverControlFrame(std::shared_ptr<ServerSideClientSession> sender) {
+    this->asyncReadFrame(MAX_CONFIRMATION_SIZE, [this, self = sharedFromThis(), sender](const Frame &frame) {
+        handleReceiverControlFrame(frame, sender);
+    });
+}
+
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::handleReceiverControlFrame(
+        const Frame &frame, const std::shared_ptr<ServerSideClientSession> &sender) {
+    if (this->isFramed() && frame.type == FrameType::credit) {
+        grantSenderCredit(sender, decodeCredit(frame.payload));
+        readReceiverControlFrame(sender);
+    } else if (this->isACK(frame)) {
+        finishTransfer(sender, this->isFramed() ? frame.payload : std::string_view{});
+    } else {
+        spdlog::warn("[ServerSideClientSession] {} did not acknowledge received file, got {} frame.", endpoint,
+                     toString(frame.type));
+        phase_timer.cancel();
+        transfer_timer.cancel();
+        pacing_timer.cancel();
+        transfer_finished = true;
+        if (frame.type == FrameType::abort && sender->isFramed()) {
+            sender->queueFrame(FrameType::error, "Receiver declined the transfer.");
+        } else {
+            sender->close();
+        }
+    }
+}
+
+// Legacy receivers do not know about credit, so the server grants it for them once their data has been written.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::grantSenderCredit(const std::shared_ptr<ServerSideClientSession> &sender,
+                                                          std::size_t bytes) {
+    if (sender->isFramed()) {
+        sender->queueFrame(FrameType::credit, encodeCredit(bytes));
+    }
+}
+
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::finishTransfer(std::shared_ptr<ServerSideClientSession> sender,
+                                                       std::string_view checksum) {
+    phase_timer.cancel();
+    transfer_timer.cancel();
+    pacing_timer.cancel();
+    transfer_finished = true;
+    sender->queueFrame(FrameType::ack, checksum);
+
+    spdlog::info("[ServerSideClientSession] {} finished sending '{}' to {}", sender->endpoint, session_code, endpoint);
+}
+
+// Only a sender that resumed its interrupted session knows how to skip what the receiver already has,
+// and only if the receiver's partial file comes from the very same file. Striped transfers start over.
+template<class Stream_t>
+std::size_t ServerSideClientSession<Stream_t>::acceptedResumeOffset(const nlohmann::json &receive_json,
+                                                                    const nlohmann::json &session_metadata) const {
+    std::size_t offset = InitSessionMessage::resumeOffset(receive_json);
+    if (offset == 0 || !InitSessionMessage::resumeToken(session_metadata).has_value() ||
+        InitSessionMessage::streamCount(session_metadata) > 1 ||
+        InitSessionMessage::fileId(receive_json) != InitSessionMessage::fileId(session_metadata)) {
+        return 0;
+    }
+    return std::min(offset, session_metadata[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>());
+}
+
+// Transfer that has already started is kept resumable, so that both peers can reconnect and continue it.
+// Broken stripe is not registered, the clients tear down the whole striped transfer and resume its main stream.
+// Neither is piped data, it is gone once it has been read.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::interruptTransfer() {
+    if (transfer_started && !transfer_finished && !is_stripe && !relays_pipe) {
+        if (auto manager = sessions_manager.lock()) {
+            manager->markResumable(session_code, transfer_metadata);
+        }
+        spdlog::info("[ServerSideClientSession] {} transfer interrupted, it can be resumed with code '{}'.", endpoint,
+                     session_code);
+    }
+    transfer_finished = true;
+    phase_timer.cancel();
+    transfer_timer.cancel();
+    pacing_timer.cancel();
+    if (auto sender = paired_sender.lock()) {
+        sender->close();
+    }
+    this->close();
+}
+
+// Either peer's connection may break, but it is the receiver's session that drives the transfer.
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::onAsyncError(const error_code &) {
+    if (auto receiver = paired_receiver.lock()) {
+        receiver->interruptTransfer();
+    } else if (!paired_sender.expired()) {
+        interruptTransfer();
+    }
+}
+
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::armDeadline(asio::steady_timer &timer, SessionPhase phase) {
+    timer.cancel();
+    std::chrono::seconds timeout{};
+    switch (phase) {
+        case SessionPhase::handshake:
+            timeout = deadlines.handshake;
+            break;
+        case SessionPhase::first_message:
+            timeout = deadlines.first_message;
+            break;
+        case SessionPhase::receiver_confirmation:
+            timeout = deadlines.receiver_confirmation;
+            break;
+        case SessionPhase::chunk_idle:
+            timeout = deadlines.chunk_idle;
+            break;
+        case SessionPhase::total_transfer:
+            timeout = deadlines.total_transfer;
+            break;
+        case SessionPhase::parked_sender:
+        default:
+            return; // parked senders are handled by SessionsManager
+    }
+    if (timeout.count() == 0) {
+        return;
+    }
+    timer.expires_after(timeout);
+    timer.async_wait([weak_self = std::weak_ptr{sharedFromThis()}, phase](error_code ec) {
+        if (ec == asio::error::operation_aborted) {
+            return;
+        }
+        if (auto self = weak_self.lock()) {
+            self->onDeadlineExpired(phase);
+        }
+    });
+}
+
+template<class Stream_t>
+void ServerSideClientSession<Stream_t>::onDeadlineExpired(SessionPhase phase) {
+    spdlog::warn("[ServerSideClientSession] {} exceeded {} deadline, closing connection.", endpoint, toString(phase));
+    if (auto manager = sessions_manager.lock()) {
+        manager->timeoutCounters().increment(phase);
+    }
+    interruptTransfer();
+}
+
+template<class Stream_t>
+std::shared_ptr<ServerSideClientSession<Stream_t>> ServerSideClientSession<Stream_t>::sharedFromThis() {
+    return std::static_pointer_cast<ServerSideClientSession>(this->shared_from_this());
+}
+
+template<class Stream_t>
+typename ServerSideClientSession<Stream_t>::FrameHandler
+ServerSideClientSession<Stream_t>::callback(ServerSideClientSession::PMF pmf) {
+    return [this, pmf](const Frame &frame) {
+        std::invoke(pmf, this, frame);
     };
 }
+
+template class ServerSideClientSession<TlsStream>;
+template class ServerSideClientSession<PlainStream>;
@@ -0,0 +1,37 @@
+#include "server/SessionDeadlines.hpp"
+
+#include <numeric>
+
+
+std::string_view toString(SessionPhase phase) {
+    switch (phase) {
+        case SessionPhase::handshake:
+            return "handshake";
+        case SessionPhase::first_message:
+            return "first message";
+        case SessionPhase::parked_sender:
+            return "parked sender";
+        case SessionPhase::receiver_confirmation:
+            return "receiver confirmation";
+        case SessionPhase::chunk_idle:
+            return "chunk idle";
+        case SessionPhase::total_transfer:
+        default:
+            return "total transfer";
+    }
+}
+
+void TimeoutCounters::increment(SessionPhase phase) {
+    counters.at(static_cast<std::size_t>(phase)).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t TimeoutCounters::get(SessionPhase phase) const {
+    return counters.at(static_cast<std::size_t>(phase)).load(std::memory_order_relaxed);
+}
+
+std::size_t TimeoutCounters::total() const {
+    return std::accumulate(counters.begin(), counters.end(), std::size_t{0},
+                           [](std::size_t sum, const std::atomic<std::size_t> &counter) {
+                               return sum + counter.load(std::memory_order_relaxed);
+                           });
+}
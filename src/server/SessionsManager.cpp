@@ -11,13 +11,23 @@
 #include <fstream>
 #include <filesystem>
 
-SessionsManager::SessionsManager() : SessionsManager(DEFAULT_CLIENT_TIMEOUT,
-                                                     DEFAULT_CHECK_INTERVAL) {}
+template<class Session_t>
+SessionsManager<Session_t>::SessionsManager() : SessionsManager(DEFAULT_CLIENT_TIMEOUT, DEFAULT_CHECK_INTERVAL) {}
 
-SessionsManager::SessionsManager(std::chrono::seconds client_timeout,
-                                 std::chrono::seconds check_interval) : nouns(extractWords(WORDS_JSON, "nouns")),
-                                                                        adjectives(extractWords(WORDS_JSON,
-                                                                                                "adjectives")) {
+template<class Session_t>
+SessionsManager<Session_t>::SessionsManager(std::chrono::seconds client_timeout,
+                                            std::chrono::seconds check_interval,
+                                            SessionDeadlines deadlines,
+                                            std::size_t max_frame_size,
+                                            TuningProfile tuning_profile,
+                                            std::size_t rate_limit) : deadlines(deadlines),
+                                                                          max_frame_size(
+                                                                                  normalizeFrameSize(max_frame_size)),
+                                                                          tuning_profile(std::move(tuning_profile)),
+                                                                          rate_limit(rate_limit),
+                                                                          nouns(extractWords(WORDS_JSON, "nouns")),
+                                                                          adjectives(extractWords(WORDS_JSON,
+                                                                                                  "adjectives")) {
     connections_controller = std::jthread{[client_timeout, check_interval, this](const std::stop_token &stop_token) {
         while (!stop_token.stop_requested()) {
             terminateTimeoutClients(client_timeout);
@@ -26,25 +36,36 @@ SessionsManager::SessionsManager(std::chrono::seconds client_timeout,
     }};
 }
 
-void SessionsManager::terminateTimeoutClients(std::chrono::seconds client_timeout) {
+template<class Session_t>
+void SessionsManager<Session_t>::terminateTimeoutClients(std::chrono::seconds client_timeout) {
     std::unique_lock lock{m};
     for (auto it = senders_sessions.begin(); it != senders_sessions.end();) {
         auto now = std::chrono::high_resolution_clock::now();
         auto elapsed_time = (now - it->second.time_point);
         if (elapsed_time > client_timeout) {
             spdlog::info("Terminating sender client with code: '{}'", it->first);
+            timeout_counters.increment(SessionPhase::parked_sender);
             it = senders_sessions.erase(it);
         } else {
             ++it;
         }
     }
+    auto is_expired = [client_timeout](const auto &entry) {
+        return std::chrono::high_resolution_clock::now() - entry.second.time_point > client_timeout;
+    };
+    std::erase_if(resumable_sessions, is_expired);
+    std::erase_if(waiting_streams, is_expired);
 }
 
-std::string SessionsManager::registerSender(std::shared_ptr<ServerSideClientSession> sender, nlohmann::json json) {
+template<class Session_t>
+std::string SessionsManager<Session_t>::registerSender(std::shared_ptr<Session_t> sender, nlohmann::json json) {
+    if (auto token = InitSessionMessage::resumeToken(json)) {
+        return resumeSender(std::move(sender), std::move(json), *token);
+    }
     while (true) {
         auto session_id = generateSessionID();
         std::unique_lock lock{m};
-        if (senders_sessions.contains(session_id)) {
+        if (senders_sessions.contains(session_id) || resumable_sessions.contains(session_id)) {
             continue;
         }
         senders_sessions[session_id] = {.client_session = std::move(sender), .session_data = std::move(json),
@@ -53,8 +74,53 @@ std::string SessionsManager::registerSender(std::shared_ptr<ServerSideClientSess
     }
 }
 
-std::pair<std::shared_ptr<ServerSideClientSession>, nlohmann::json>
-SessionsManager::getSenderWithMetadata(const std::string &session_code) {
+template<class Session_t>
+std::string SessionsManager<Session_t>::resumeSender(std::shared_ptr<Session_t> sender, nlohmann::json json,
+                                                     const std::string &token) {
+    std::unique_lock lock{m};
+    auto it = resumable_sessions.find(token);
+    if (it == resumable_sessions.end()) {
+        throw SessionsManagerException{"Unknown resume token."};
+    }
+    if (InitSessionMessage::fileId(it->second.session_data) != InitSessionMessage::fileId(json)) {
+        throw SessionsManagerException{"Resumed file is not the one that was interrupted."};
+    }
+    resumable_sessions.erase(it);
+    spdlog::info("Resuming session with code: '{}'", token);
+    senders_sessions[token] = {.client_session = std::move(sender), .session_data = std::move(json),
+            .time_point = std::chrono::high_resolution_clock::now()};
+    return token;
+}
+
+template<class Session_t>
+void SessionsManager<Session_t>::markResumable(const std::string &session_code, nlohmann::json session_data) {
+    std::unique_lock lock{m};
+    resumable_sessions[session_code] = {.client_session = nullptr, .session_data = std::move(session_data),
+            .time_point = std::chrono::high_resolution_clock::now()};
+}
+
+template<class Session_t>
+std::optional<std::shared_ptr<Session_t>>
+SessionsManager<Session_t>::joinStream(std::shared_ptr<Session_t> session, const nlohmann::json &join_json) {
+    std::string stream_key = fmt::format("{}#{}", join_json[InitSessionMessage::CODE_WORDS_KEY].get<std::string>(),
+                                         join_json[InitSessionMessage::STREAM_INDEX_KEY].get<std::size_t>());
+    std::unique_lock lock{m};
+    auto it = waiting_streams.find(stream_key);
+    if (it == waiting_streams.end()) {
+        waiting_streams[stream_key] = {.client_session = std::move(session), .session_data = join_json,
+                .time_point = std::chrono::high_resolution_clock::now()};
+        return std::nullopt;
+    }
+    if (it->second.session_data[InitSessionMessage::ACTION_KEY] == join_json[InitSessionMessage::ACTION_KEY]) {
+        throw SessionsManagerException{"This stream has already joined the session."};
+    }
+    auto node = waiting_streams.extract(it);
+    return std::move(node.mapped().client_session);
+}
+
+template<class Session_t>
+std::pair<std::shared_ptr<Session_t>, nlohmann::json>
+SessionsManager<Session_t>::getSenderWithMetadata(const std::string &session_code) {
     std::unique_lock lock{m};
     auto it = senders_sessions.find(session_code);
     if (it == senders_sessions.end()) {
@@ -64,11 +130,52 @@ SessionsManager::getSenderWithMetadata(const std::string &session_code) {
     return {std::move(node.mapped().client_session), std::move(node.mapped().session_data)};
 }
 
-std::string SessionsManager::generateSessionID() {
+template<class Session_t>
+std::string SessionsManager<Session_t>::generateSessionID() {
     return fmt::format("{}-{}-{}", pickRandom(adjectives), pickRandom(nouns), getRandom(0, 100));
 }
 
-std::size_t SessionsManager::currentSessions() {
+template<class Session_t>
+std::size_t SessionsManager<Session_t>::currentSessions() {
     std::unique_lock lock{m};
     return senders_sessions.size();
 }
+
+template<class Session_t>
+const SessionDeadlines &SessionsManager<Session_t>::sessionDeadlines() const {
+    return deadlines;
+}
+
+template<class Session_t>
+std::size_t SessionsManager<Session_t>::maxFrameSize() const {
+    return max_frame_size;
+}
+
+template<class Session_t>
+const TuningProfile &SessionsManager<Session_t>::tuningProfile() const {
+    return tuning_profile;
+}
+
+template<class Session_t>
+std::shared_ptr<RateLimiter> SessionsManager<Session_t>::rateLimiter(const std::string &session_code) {
+    if (rate_limit == 0) {
+        return nullptr;
+    }
+    std::unique_lock lock{m};
+    std::erase_if(rate_limiters, [](const auto &entry) { return entry.second.expired(); });
+    auto &rate_limiter = rate_limiters[session_code];
+    if (auto shared = rate_limiter.lock()) {
+        return shared;
+    }
+    auto shared = std::make_shared<RateLimiter>(rate_limit);
+    rate_limiter = shared;
+    return shared;
+}
+
+template<class Session_t>
+TimeoutCounters &SessionsManager<Session_t>::timeoutCounters() {
+    return timeout_counters;
+}
+
+template class SessionsManager<ServerSideClientSession<TlsStream>>;
+template class SessionsManager<ServerSideClientSession<PlainStream>>;
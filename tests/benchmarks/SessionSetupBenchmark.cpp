@@ -0,0 +1,209 @@
+#include "client/DropFileSendClient.hpp"
+#include "client/DropFileReceiveClient.hpp"
+#include "server/DropFileServer.hpp"
+
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <sstream>
+
+
+// Measures how many round trips it takes before file data reaches the receiver.
+// Both clients talk to the server through a local proxy that delays every chunk by ONE_WAY_DELAY,
+// so that the time spent in setup can be expressed in RTTs. TCP handshake is not delayed.
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned short SERVER_PORT{61400};
+constexpr unsigned short PROXY_PORT{61401};
+constexpr auto ONE_WAY_DELAY{25ms};
+constexpr auto RTT{2 * ONE_WAY_DELAY};
+constexpr int RUNS{5};
+
+
+// Forwards bytes one way, every chunk is written ONE_WAY_DELAY after it was read.
+class DelayedPipe {
+public:
+    DelayedPipe(tcp::socket &from, tcp::socket &to) : from(from), to(to) {
+        reader = std::jthread{[this] { readLoop(); }};
+        writer = std::jthread{[this] { writeLoop(); }};
+    }
+
+private:
+    void readLoop() {
+        std::array<char, 64 * 1024> buffer{};
+        error_code ec;
+        while (true) {
+            std::size_t size = from.read_some(asio::buffer(buffer), ec);
+            std::scoped_lock lock{mutex};
+            if (ec) {
+                chunks.emplace_back(Clock::now() + ONE_WAY_DELAY, std::string{});
+                cv.notify_one();
+                return;
+            }
+            chunks.emplace_back(Clock::now() + ONE_WAY_DELAY, std::string{buffer.data(), size});
+            cv.notify_one();
+        }
+    }
+
+    void writeLoop() {
+        while (true) {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [this] { return !chunks.empty(); });
+            auto [deliver_at, chunk] = std::move(chunks.front());
+            chunks.pop_front();
+            lock.unlock();
+            std::this_thread::sleep_until(deliver_at);
+            error_code ec;
+            if (chunk.empty()) {
+                to.shutdown(tcp::socket::shutdown_send, ec);
+                return;
+            }
+            asio::write(to, asio::buffer(chunk), ec);
+            if (ec) {
+                return;
+            }
+        }
+    }
+
+    tcp::socket &from;
+    tcp::socket &to;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<Clock::time_point, std::string>> chunks;
+    std::jthread reader;
+    std::jthread writer;
+};
+
+struct ProxiedConnection {
+    ProxiedConnection(tcp::socket client_, asio::io_context &io_context) : client(std::move(client_)),
+                                                                          server(io_context) {
+        server.connect({asio::ip::make_address("127.0.0.1"), SERVER_PORT});
+        client.set_option(tcp::no_delay(true)); // the proxy itself must not add any latency
+        server.set_option(tcp::no_delay(true));
+        to_server.emplace(client, server);
+        to_client.emplace(server, client);
+    }
+
+    tcp::socket client;
+    tcp::socket server;
+    std::optional<DelayedPipe> to_server;
+    std::optional<DelayedPipe> to_client;
+};
+
+class LatencyProxy {
+public:
+    LatencyProxy() : acceptor(io_context, {asio::ip::make_address("127.0.0.1"), PROXY_PORT}) {
+        accept_thread = std::jthread{[this] {
+            while (true) {
+                error_code ec;
+                tcp::socket client = acceptor.accept(ec);
+                if (ec || stopping) {
+                    return;
+                }
+                std::scoped_lock lock{mutex};
+                connections.push_back(std::make_unique<ProxiedConnection>(std::move(client), io_context));
+            }
+        }};
+    }
+
+    // Blocking accept and reads are not interrupted by close, so they are woken up with connection and shutdowns.
+    ~LatencyProxy() {
+        stopping = true;
+        error_code ec;
+        tcp::socket(io_context).connect(acceptor.local_endpoint(), ec);
+        accept_thread.join();
+        for (auto &connection: connections) {
+            connection->client.shutdown(tcp::socket::shutdown_both, ec);
+            connection->server.shutdown(tcp::socket::shutdown_both, ec);
+        }
+    }
+
+private:
+    asio::io_context io_context;
+    tcp::acceptor acceptor;
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ProxiedConnection>> connections;
+    std::jthread accept_thread;
+};
+
+
+struct SetupTimes {
+    double sender_setup_rtts;
+    double receiver_ttfb_rtts;
+};
+
+double toRtts(Clock::duration duration) {
+    return std::chrono::duration<double>(duration) / std::chrono::duration<double>(RTT);
+}
+
+SetupTimes measureSmallTransfer(const std::filesystem::path &file, bool auto_accept) {
+    std::filesystem::remove(std::filesystem::current_path() / file.filename());
+    std::stringstream interaction_stream{"y"};
+
+    auto sender_start = Clock::now();
+    DropFileSendClient send_client{ClientSocket<>{"127.0.0.1", PROXY_PORT, false}};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(file);
+    auto sender_setup = Clock::now() - sender_start;
+
+    auto send_result = std::async(std::launch::async, [&send_client, fs_entry = std::move(fs_entry)]() mutable {
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+
+    // Single byte file is received as soon as its first byte arrives, receiver does not wait for anything after that.
+    auto receiver_start = Clock::now();
+    DropFileReceiveClient recv_client{ClientSocket<>{"127.0.0.1", PROXY_PORT, false}, interaction_stream, auto_accept};
+    recv_client.receiveFile(receive_code);
+    auto receiver_ttfb = Clock::now() - receiver_start;
+
+    send_result.get();
+    std::filesystem::remove(std::filesystem::current_path() / file.filename());
+    return {toRtts(sender_setup), toRtts(receiver_ttfb)};
+}
+
+double median(std::vector<double> values) {
+    std::ranges::sort(values);
+    return values[values.size() / 2];
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+    std::filesystem::path source_dir{std::filesystem::temp_directory_path() / "drop-file-benchmark"};
+    std::filesystem::create_directories(source_dir);
+    std::filesystem::path file{source_dir / "ttfb_benchmark_file"};
+    std::ofstream{file} << 'x';
+
+    DropFileServer<> server{SERVER_PORT, EXAMPLE_CERT_DIR};
+    std::jthread server_thread{[&server] { server.run(); }};
+    std::vector<std::pair<std::string, SetupTimes>> results;
+    {
+        LatencyProxy proxy;
+        for (bool auto_accept: {false, true}) {
+            std::vector<double> sender_setup;
+            std::vector<double> receiver_ttfb;
+            for (int i = 0; i < RUNS; ++i) {
+                auto [sender_rtts, receiver_rtts] = measureSmallTransfer(file, auto_accept);
+                sender_setup.push_back(sender_rtts);
+                receiver_ttfb.push_back(receiver_rtts);
+            }
+            results.emplace_back(auto_accept ? "auto-accept" : "confirmation",
+                                 SetupTimes{median(sender_setup), median(receiver_ttfb)});
+        }
+    }
+    server.stop();
+    std::filesystem::remove_all(source_dir);
+
+    fmt::print("\nTime to first byte, RTT = {} ms, median of {} runs\n", RTT.count(), RUNS);
+    fmt::print("{:<14}{:>22}{:>22}\n", "mode", "sender setup [RTT]", "receiver TTFB [RTT]");
+    for (const auto &[mode, times]: results) {
+        fmt::print("{:<14}{:>22.2f}{:>22.2f}\n", mode, times.sender_setup_rtts, times.receiver_ttfb_rtts);
+    }
+}
@@ -9,7 +9,7 @@ using namespace ::testing;
 
 class DummyTestSessionManager;
 
-class SocketBaseWrapper : public SocketBase {
+class SocketBaseWrapper : public SocketBase<> {
 public:
     SocketBaseWrapper(tcp::socket socket, boost::asio::ssl::context &context,
                       std::weak_ptr<DummyTestSessionManager> test_session_manager) : SocketBase(
@@ -23,14 +23,14 @@ public:
 
 class DummyTestSessionManager {
 public:
-    DummyTestSessionManager(std::function<void(std::shared_ptr<SocketBase>)> set_test_socket) : set_test_socket(
+    DummyTestSessionManager(std::function<void(std::shared_ptr<SocketBase<>>)> set_test_socket) : set_test_socket(
             std::move(set_test_socket)) {}
 
-    void setTestSocket(std::shared_ptr<SocketBase> socket) {
+    void setTestSocket(std::shared_ptr<SocketBase<>> socket) {
         set_test_socket(std::move(socket));
     }
 
-    std::function<void(std::shared_ptr<SocketBase>)> set_test_socket;
+    std::function<void(std::shared_ptr<SocketBase<>>)> set_test_socket;
 };
 
 void SocketBaseWrapper::start() {
@@ -46,13 +46,13 @@ struct ClientSocketTest : public Test {
             std::make_shared<DummyTestSessionManager>([this](auto socket) {
                 setPeerSocket(std::move(socket));
             })};
-    DropFileServer<SocketBaseWrapper, DummyTestSessionManager> test_server{TEST_PORT,
+    DropFileServer<TlsStream, SocketBaseWrapper, DummyTestSessionManager> test_server{TEST_PORT,
                                                                            EXAMPLE_CERT_DIR,
                                                                            test_session_manager};
-    SocketBase::MessageHandler async_message_handler;
+    SocketBase<>::MessageHandler async_message_handler;
     std::jthread test_server_thread;
     std::atomic_flag is_peer_socket_set;
-    std::shared_ptr<SocketBase> peer_socket{};
+    std::shared_ptr<SocketBase<>> peer_socket{};
 
     void SetUp() override {
         spdlog::set_level(spdlog::level::debug);
@@ -66,7 +66,7 @@ struct ClientSocketTest : public Test {
         test_server.stop();
     }
 
-    void setPeerSocket(std::shared_ptr<SocketBase> other_peer_socker) {
+    void setPeerSocket(std::shared_ptr<SocketBase<>> other_peer_socker) {
         if (!is_peer_socket_set.test_and_set()) {
             peer_socket = std::move(other_peer_socker);
         }
@@ -78,8 +78,8 @@ struct ClientSocketTest : public Test {
         }
     }
 
-    ClientSocket createClientSocket() {
-        ClientSocket client_socket{"localhost", TEST_PORT, false};
+    ClientSocket<> createClientSocket() {
+        ClientSocket<> client_socket{"localhost", TEST_PORT, false};
         waitForPeerSocket();
         return client_socket;
     }
@@ -90,19 +90,19 @@ struct ClientSocketTest : public Test {
             final_received_message += content;
             static std::size_t received_messages{0};
             if (++received_messages < how_many) {
-                peer_socket->asyncReadMessage(SocketBase::BUFFER_SIZE, async_message_handler);
+                peer_socket->asyncReadMessage(SocketBase<>::BUFFER_SIZE, async_message_handler);
             } else {
                 response_promise.set_value(final_received_message);
             }
         };
-        peer_socket->asyncReadMessage(SocketBase::BUFFER_SIZE, async_message_handler);
+        peer_socket->asyncReadMessage(SocketBase<>::BUFFER_SIZE, async_message_handler);
         return response_promise.get_future();
     }
 };
 
 
 TEST_F(ClientSocketTest, twoSocketsCanTalkToEachOther) {
-    ClientSocket client_socket{"localhost", TEST_PORT, false};
+    ClientSocket<> client_socket{"localhost", TEST_PORT, false};
     waitForPeerSocket();
     std::string_view test_message{"Hello, world!"};
     client_socket.send(test_message);
@@ -113,7 +113,7 @@ TEST_F(ClientSocketTest, twoSocketsCanTalkToEachOther) {
 }
 
 TEST_F(ClientSocketTest, canReturnMessageCopy) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
     std::string_view test_message{"Hello, world!"};
     client_socket.send(test_message);
@@ -124,7 +124,7 @@ TEST_F(ClientSocketTest, canReturnMessageCopy) {
 }
 
 TEST_F(ClientSocketTest, returnsBufferPtr) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
     std::string_view test_message{"Hello, world!"};
     client_socket.send(test_message);
@@ -137,7 +137,7 @@ TEST_F(ClientSocketTest, returnsBufferPtr) {
 }
 
 TEST_F(ClientSocketTest, canSendAndReceiveACK) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
 
     client_socket.sendACK();
@@ -145,13 +145,13 @@ TEST_F(ClientSocketTest, canSendAndReceiveACK) {
 }
 
 TEST_F(ClientSocketTest, canReadMessageAsync) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
 
     std::size_t message_length{100'000};
     std::string message = generateRandomString(message_length);
     std::promise<std::string_view> p{};
-    peer_socket->asyncReadMessage(SocketBase::BUFFER_SIZE, [&](std::string_view msg) {
+    peer_socket->asyncReadMessage(SocketBase<>::BUFFER_SIZE, [&](std::string_view msg) {
         p.set_value(msg);
     });
     client_socket.send(message);
@@ -161,10 +161,10 @@ TEST_F(ClientSocketTest, canReadMessageAsync) {
 }
 
 TEST_F(ClientSocketTest, canSendInPartsMessageBiggerThanBufferSize) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
     std::size_t compounded_messages{3};
-    std::size_t message_size = compounded_messages * SocketBase::BUFFER_SIZE;
+    std::size_t message_size = compounded_messages * SocketBase<>::BUFFER_SIZE;
     std::string message = generateRandomString(message_size);
 
     std::promise<std::string> result_promise;
@@ -176,7 +176,28 @@ TEST_F(ClientSocketTest, canSendInPartsMessageBiggerThanBufferSize) {
 }
 
 TEST_F(ClientSocketTest, cannotAsynchronouslyReadMessageBiggerThanBufferSize) {
-    ClientSocket client_socket = createClientSocket();
+    ClientSocket<> client_socket = createClientSocket();
 
-    ASSERT_THROW(client_socket.asyncReadMessage(SocketBase::BUFFER_SIZE * 2, [](std::string_view){}), SocketException);
+    ASSERT_THROW(client_socket.asyncReadMessage(SocketBase<>::BUFFER_SIZE * 2, [](std::string_view){}), SocketException);
+}
+
+TEST_F(ClientSocketTest, recordsConnectTimings) {
+    ClientSocket<> client_socket = createClientSocket();
+
+    const ConnectTimings &timings = client_socket.connectTimings();
+    ASSERT_GE(timings.attempts, 1);
+    ASSERT_GT(timings.tls.count(), 0);
+}
+
+TEST_F(ClientSocketTest, throwsWhenNoAddressAccepts) {
+    ASSERT_THROW((ClientSocket<>{"127.0.0.1", static_cast<unsigned short>(TEST_PORT + 1), false}),
+                 boost::system::system_error);
+}
+
+TEST(ClientSocketAddressTests, addressFamiliesAlternate) {
+    auto endpoint = [](const char *address) { return tcp::endpoint{boost::asio::ip::make_address(address), 80}; };
+    std::vector<tcp::endpoint> resolved{endpoint("::1"), endpoint("::2"), endpoint("::3"), endpoint("10.0.0.1")};
+    std::vector<tcp::endpoint> expected{endpoint("::1"), endpoint("10.0.0.1"), endpoint("::2"), endpoint("::3")};
+    ASSERT_EQ(interleaveAddressFamilies(resolved), expected);
+    ASSERT_TRUE(interleaveAddressFamilies({}).empty());
 }
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "client/DirectLink.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <future>
+
+
+using namespace ::testing;
+
+struct DirectLinkTests : public Test {
+    const std::chrono::milliseconds TIMEOUT{2000};
+    DirectListener<> listener;
+
+    void SetUp() override {
+        spdlog::set_level(spdlog::level::debug);
+    }
+
+    std::future<std::optional<ClientSocket<>>> asyncAccept() {
+        return std::async(std::launch::async, [this] {
+            return listener.accept(TIMEOUT);
+        });
+    }
+};
+
+TEST_F(DirectLinkTests, offerEndsWithLoopback) {
+    const DirectOffer &offer = listener.offer();
+    ASSERT_FALSE(offer.addresses.empty());
+    ASSERT_LE(offer.addresses.size(), InitSessionMessage::MAX_DIRECT_ADDRESSES);
+    ASSERT_EQ(offer.addresses.back(), "127.0.0.1");
+    ASSERT_NE(offer.port, 0);
+    ASSERT_FALSE(offer.session_key.empty());
+    ASSERT_FALSE(offer.certificate_fingerprint.empty());
+}
+
+TEST_F(DirectLinkTests, clientsTalkOverDirectLink) {
+    auto accepted = asyncAccept();
+    auto receiver = connectDirectly(listener.offer(), TIMEOUT);
+    auto sender = accepted.get();
+    ASSERT_TRUE(receiver.has_value());
+    ASSERT_TRUE(sender.has_value());
+
+    sender->sendFrame(FrameType::data, "Hello directly!");
+    Frame frame = receiver->receiveFrame();
+    ASSERT_EQ(frame.type, FrameType::data);
+    ASSERT_EQ(frame.payload, "Hello directly!");
+}
+
+TEST_F(DirectLinkTests, refusesReceiverWithoutSessionKey) {
+    DirectOffer offer = listener.offer();
+    offer.session_key = std::string(offer.session_key.size(), '0');
+    auto accepted = asyncAccept();
+    ASSERT_FALSE(connectDirectly(offer, TIMEOUT).has_value());
+    ASSERT_FALSE(accepted.get().has_value());
+}
+
+TEST_F(DirectLinkTests, refusesSenderWithOtherCertificate) {
+    DirectOffer offer = listener.offer();
+    offer.certificate_fingerprint = DirectListener<>{}.offer().certificate_fingerprint;
+    auto accepted = asyncAccept();
+    ASSERT_FALSE(connectDirectly(offer, TIMEOUT).has_value());
+    ASSERT_FALSE(accepted.get().has_value());
+}
+
+TEST_F(DirectLinkTests, givesUpWhenNobodyConnects) {
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(listener.accept(std::chrono::milliseconds{100}).has_value());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, TIMEOUT);
+}
@@ -4,16 +4,20 @@
 #include "client/ClientArgParser.hpp"
 #include "client/DropFileSendClient.hpp"
 #include "client/DropFileReceiveClient.hpp"
+#include "client/RangeWriter.hpp"
 #include "server/DropFileServer.hpp"
+#include "InitSessionMessage.hpp"
 
 #include <filesystem>
 
+#include <unistd.h>
+
 
 using namespace ::testing;
 
 struct DropFileServerIntegrationTests : public Test {
     const unsigned short TEST_PORT{61342};
-    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager>(SessionsManager::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1))};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager<>>(SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1))};
     const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_fs_entry"};
     std::stringstream interaction_stream;
 
@@ -65,11 +69,11 @@ struct DropFileServerIntegrationTests : public Test {
         return std::filesystem::current_path() / TEST_FILE_PATH.filename();
     }
 
-    ClientSocket createClientSocket() {
+    ClientSocket<> createClientSocket() {
         return {"localhost", TEST_PORT, false};
     }
 
-    DropFileReceiveClient createRecvClient(char character) {
+    DropFileReceiveClient<> createRecvClient(char character) {
         interaction_stream << character;
         return {createClientSocket(), interaction_stream};
     }
@@ -108,6 +112,48 @@ TEST_F(DropFileServerIntegrationTests, canSendAndReceiveFile) {
     ASSERT_EQ(getFileContent(getExpectedPath()), FILE_CONTENT);
 }
 
+TEST_F(DropFileServerIntegrationTests, canSendFileHashedWithSha256) {
+    DropFileSendClient send_client{createClientSocket(), {}, 1, HashAlgorithm::sha256};
+    createTestFile();
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_EQ(getFileContent(getExpectedPath()), FILE_CONTENT);
+}
+
+TEST_F(DropFileServerIntegrationTests, autoAcceptedReceiveDoesNotAskUser) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestFile();
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true}; // nothing to read from stream
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_EQ(getFileContent(getExpectedPath()), FILE_CONTENT);
+}
+
+TEST_F(DropFileServerIntegrationTests, autoAcceptedReceiveCanStillBeAbortedBeforeWriting) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestFile();
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    std::ofstream{getExpectedPath()} << "already here";
+
+    ASSERT_THROW(recv_client.receiveFile(receive_code), DropFileReceiveException);
+    ASSERT_THROW(send_client.sendFSEntry(std::move(fs_entry)), SocketException);
+    ASSERT_EQ(getFileContent(getExpectedPath()), "already here");
+}
+
 TEST_F(DropFileServerIntegrationTests, canSendAndReceiveDirectory) {
     DropFileSendClient send_client{createClientSocket()};
 
@@ -129,6 +175,103 @@ TEST_F(DropFileServerIntegrationTests, canSendAndReceiveDirectory) {
     assertDirectoriesEqual(getExpectedPath(), TEST_FILE_PATH);
 }
 
+TEST_F(DropFileServerIntegrationTests, canSendSeveralPathsInOneTransfer) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestDirectory();
+    std::filesystem::path second_path = TEST_FILE_PATH.string() + "_second";
+    std::ofstream{second_path} << FILE_CONTENT;
+    std::filesystem::path second_expected_path = std::filesystem::current_path() / second_path.filename();
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(
+            std::vector<std::string>{TEST_FILE_PATH.string(), second_path.string()});
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    std::string second_content = getFileContent(second_expected_path);
+    std::filesystem::remove(second_path);
+    std::filesystem::remove(second_expected_path);
+    assertDirectoriesEqual(getExpectedPath(), TEST_FILE_PATH);
+    ASSERT_EQ(second_content, FILE_CONTENT);
+}
+
+TEST_F(DropFileServerIntegrationTests, canSendDirectoryDirectly) {
+    DropFileSendClient send_client{createClientSocket(), {}, 1, DEFAULT_HASH_ALGORITHM, true};
+    createTestDirectory();
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    assertDirectoriesEqual(getExpectedPath(), TEST_FILE_PATH);
+}
+
+TEST_F(DropFileServerIntegrationTests, sendsNoFasterThanRateLimit) {
+    const std::size_t RATE_LIMIT{1024 * 1024};
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(RATE_LIMIT / 4);
+    }
+    DropFileSendClient send_client{createClientSocket(), {}, 1, DEFAULT_HASH_ALGORITHM, false, {}, RATE_LIMIT};
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto start = std::chrono::steady_clock::now();
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{200});
+    ASSERT_EQ(getFileContent(getExpectedPath()), getFileContent(TEST_FILE_PATH));
+}
+
+// Kernel encrypts the file when it has the tls module, otherwise it is sent from user space as usual.
+TEST_F(DropFileServerIntegrationTests, sendsWithZeroCopyWhateverKernelSupports) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(3 * SocketBase<>::BUFFER_SIZE + 17);
+    }
+    DropFileSendClient send_client{createClientSocket(), {}, 2, DEFAULT_HASH_ALGORITHM, false, {}, 0, true};
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_EQ(getFileContent(getExpectedPath()), getFileContent(TEST_FILE_PATH));
+}
+
+TEST_F(DropFileServerIntegrationTests, relaysFromFramedSenderToLegacyReceiver) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestFile();
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+
+    auto legacy_receiver = createClientSocket(); // never sends Hello
+    legacy_receiver.send(InitSessionMessage::createReceiveMessage(receive_code).dump());
+    auto metadata = nlohmann::json::parse(legacy_receiver.receive());
+    ASSERT_EQ(metadata[InitSessionMessage::FILE_SIZE_KEY].get<std::size_t>(), FILE_CONTENT.size());
+    legacy_receiver.sendACK();
+
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    ASSERT_EQ(legacy_receiver.receive(), FILE_CONTENT);
+    legacy_receiver.sendACK();
+    ASSERT_NO_THROW(send_result.get());
+}
+
 TEST_F(DropFileServerIntegrationTests, throwsWhenGivenPathAlreadyExists) {
     DropFileSendClient send_client{createClientSocket()};
 
@@ -147,3 +290,519 @@ TEST_F(DropFileServerIntegrationTests, throwsWhenReceivesWithNonExistentCode) {
 
     ASSERT_THROW(recv_client.receiveFile("some-non-existent-recv-code"), DropFileReceiveException);
 }
+
+struct PlaintextDropFileServerIntegrationTests : public Test {
+    const unsigned short TEST_PORT{61343};
+    DropFileServer<PlainStream> server{TEST_PORT, EXAMPLE_CERT_DIR,
+                                       std::make_shared<SessionsManager<ServerSideClientSession<PlainStream>>>()};
+    const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_plaintext_fs_entry"};
+    std::stringstream interaction_stream;
+    std::jthread server_thread;
+
+    void SetUp() override {
+        std::filesystem::remove_all(getExpectedPath());
+        server_thread = std::jthread{[&]{
+            server.run();
+        }};
+    }
+
+    void TearDown () override {
+        std::filesystem::remove_all(TEST_FILE_PATH);
+        std::filesystem::remove_all(getExpectedPath());
+        server.stop();
+        server_thread.join();
+    }
+
+    std::filesystem::path getExpectedPath() {
+        return std::filesystem::current_path() / TEST_FILE_PATH.filename();
+    }
+
+    ClientSocket<PlainStream> createClientSocket() {
+        return {"localhost", TEST_PORT, false};
+    }
+};
+
+TEST_F(PlaintextDropFileServerIntegrationTests, canSendAndReceiveFileOverPlainTcp) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(3 * SocketBase<PlainStream>::BUFFER_SIZE + 17);
+    }
+    DropFileSendClient send_client{createClientSocket()};
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_EQ(getFileContent(getExpectedPath()), getFileContent(TEST_FILE_PATH));
+}
+
+TEST_F(PlaintextDropFileServerIntegrationTests, sendsFileStraightFromDiskOverPlainTcp) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(3 * SocketBase<PlainStream>::BUFFER_SIZE + 17);
+    }
+    DropFileSendClient send_client{createClientSocket(), {}, 2, DEFAULT_HASH_ALGORITHM, false, {}, 0, true};
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_EQ(getFileContent(getExpectedPath()), getFileContent(TEST_FILE_PATH));
+}
+
+struct FrameSizeNegotiationTests : public Test {
+    const unsigned short TEST_PORT{61344};
+    const std::size_t SERVER_FRAME_SIZE_LIMIT{64 * 1024};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager<>>(
+            SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1), SessionDeadlines{}, SERVER_FRAME_SIZE_LIMIT)};
+    const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_frame_size_fs_entry"};
+    std::jthread server_thread;
+
+    void SetUp() override {
+        server_thread = std::jthread{[&]{
+            server.run();
+        }};
+    }
+
+    void TearDown () override {
+        std::filesystem::remove_all(TEST_FILE_PATH);
+        server.stop();
+        server_thread.join();
+    }
+
+    ClientSocket<> createClientSocket() {
+        return {"localhost", TEST_PORT, false};
+    }
+};
+
+TEST_F(FrameSizeNegotiationTests, serverCapsFrameSizeProposedByClient) {
+    auto client = createClientSocket();
+    client.requestFramedProtocol(MAX_FRAME_SIZE);
+    client.sendFrame(FrameType::metadata, InitSessionMessage::createReceiveMessage("some-non-existent-code").dump());
+
+    Frame response = client.receiveFrame();
+    ASSERT_EQ(response.type, FrameType::error);
+    ASSERT_EQ(client.maxFrameSize(), SERVER_FRAME_SIZE_LIMIT);
+}
+
+TEST_F(FrameSizeNegotiationTests, clientMayAskForSmallerFramesThanServerAllows) {
+    auto client = createClientSocket();
+    client.requestFramedProtocol(MIN_FRAME_SIZE);
+    client.sendFrame(FrameType::metadata, InitSessionMessage::createReceiveMessage("some-non-existent-code").dump());
+
+    client.receiveFrame();
+    ASSERT_EQ(client.maxFrameSize(), MIN_FRAME_SIZE);
+}
+
+TEST_F(FrameSizeNegotiationTests, relaysFramesBiggerThanLegacyReceiverAccepts) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(3 * SERVER_FRAME_SIZE_LIMIT + 5);
+    }
+    DropFileSendClient send_client{createClientSocket()};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+
+    auto legacy_receiver = createClientSocket();
+    legacy_receiver.send(InitSessionMessage::createReceiveMessage(receive_code).dump());
+    legacy_receiver.receive(); // metadata
+    legacy_receiver.sendACK();
+
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    std::string received;
+    while (received.size() < 3 * SERVER_FRAME_SIZE_LIMIT + 5) {
+        received += legacy_receiver.receive();
+    }
+    legacy_receiver.sendACK();
+    ASSERT_NO_THROW(send_result.get());
+    ASSERT_EQ(received, getFileContent(TEST_FILE_PATH));
+}
+
+TEST_F(DropFileServerIntegrationTests, canSendFileStripedAcrossStreams) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(3 * 1024 * 1024 + 5);
+    }
+    DropFileSendClient send_client{createClientSocket(), ReconnectPolicy{}, 4};
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_TRUE(filesContentEqual(getExpectedPath(), TEST_FILE_PATH));
+}
+
+TEST_F(DropFileServerIntegrationTests, stripesTinyFileAcrossMaxStreams) {
+    DropFileSendClient send_client{createClientSocket(), ReconnectPolicy{}, MAX_STREAMS};
+    createTestFile();
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+    send_client.sendFSEntry(std::move(fs_entry));
+
+    receive_result.get();
+    ASSERT_EQ(getFileContent(getExpectedPath()), FILE_CONTENT);
+}
+
+// Sender here is a raw socket that trails the second chunk with a wrong leaf.
+TEST_F(DropFileServerIntegrationTests, receiverFailsFastOnCorruptedChunk) {
+    const std::size_t chunk_size{MerkleTree::MIN_CHUNK_SIZE};
+    std::string content = generateRandomString(4 * chunk_size);
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << content;
+    }
+    auto tree = MerkleTree::fromFile(TEST_FILE_PATH, chunk_size, DEFAULT_HASH_ALGORITHM);
+    auto sender = createClientSocket();
+    sender.requestFramedProtocol();
+    sender.sendFrame(FrameType::metadata,
+                     InitSessionMessage::createSendMessage(TEST_FILE_PATH, false, 1, chunk_size).dump());
+    auto receive_code = nlohmann::json::parse(sender.receive())[InitSessionMessage::CODE_WORDS_KEY].get<std::string>();
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true};
+    auto receive_result = std::async(std::launch::async, [&]{
+        recv_client.receiveFile(receive_code);
+    });
+
+    sender.receiveACK();
+    auto leaves = tree.leaves();
+    leaves[1][0] = static_cast<char>(leaves[1][0] + 1);
+    try {
+        for (std::size_t chunk = 0; chunk < leaves.size(); ++chunk) {
+            sender.awaitCredit();
+            sender.send(std::string_view{content}.substr(chunk * chunk_size, chunk_size));
+            sender.consumeCredit(chunk_size);
+            sender.sendFrame(FrameType::chunk_hashes, encodeChunkHashes(chunk, leaves[chunk]));
+        }
+    } catch (const boost::system::system_error &) {} // receiver is allowed to hang up early
+
+    ASSERT_THROW(receive_result.get(), DropFileReceiveException);
+    auto partial_path = getExpectedPath();
+    partial_path += ".drop-file-part";
+    auto checkpoint_path = std::filesystem::temp_directory_path() / "drop-file" / "partial" / (receive_code + ".json");
+    auto checkpoint = ResumeCheckpoint::load(checkpoint_path);
+    std::filesystem::remove(partial_path);
+    std::filesystem::remove(checkpoint_path);
+    ASSERT_TRUE(checkpoint.has_value());
+    ASSERT_EQ(checkpoint->offset, chunk_size); // only the corrupted chunk and what follows it is requested again
+}
+
+struct ResumableTransferTests : public Test {
+    const unsigned short TEST_PORT{61345};
+    const std::size_t FILE_SIZE{3 * 1024 * 1024 + 17};
+    const std::size_t RECEIVED_BEFORE_DROP{256 * 1024};
+    std::shared_ptr<SessionsManager<>> sessions_manager{std::make_shared<SessionsManager<>>(
+            SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1))};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, sessions_manager};
+    const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_resumable_fs_entry"};
+    const ReconnectPolicy reconnect_policy{.max_attempts = 5, .initial_delay = std::chrono::milliseconds(100)};
+    std::stringstream interaction_stream;
+    std::filesystem::path partial_path;
+    std::filesystem::path checkpoint_path;
+    std::jthread server_thread;
+
+    void SetUp() override {
+        std::filesystem::remove_all(getExpectedPath());
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(FILE_SIZE);
+        server_thread = std::jthread{[&]{
+            server.run();
+        }};
+    }
+
+    void TearDown () override {
+        std::filesystem::remove_all(TEST_FILE_PATH);
+        std::filesystem::remove_all(getExpectedPath());
+        std::filesystem::remove(partial_path);
+        std::filesystem::remove(checkpoint_path);
+        server.stop();
+        server_thread.join();
+    }
+
+    std::filesystem::path getExpectedPath() {
+        return std::filesystem::current_path() / TEST_FILE_PATH.filename();
+    }
+
+    ClientSocket<> createClientSocket() {
+        return {"localhost", TEST_PORT, false};
+    }
+
+    // Receives first RECEIVED_BEFORE_DROP bytes the way DropFileReceiveClient would, then the connection is gone.
+    void receivePartiallyAndDrop(const std::string &receive_code) {
+        auto receiver = createClientSocket();
+        receiver.requestFramedProtocol();
+        receiver.sendFrame(FrameType::metadata, InitSessionMessage::createReceiveMessage(receive_code, true).dump());
+        receiver.grantCredit(RECEIVED_BEFORE_DROP);
+        auto metadata = nlohmann::json::parse(receiver.receive());
+        partial_path = getExpectedPath();
+        partial_path += ".drop-file-part";
+        checkpoint_path = std::filesystem::temp_directory_path() / "drop-file" / "partial" / (receive_code + ".json");
+        std::ofstream partial_file{partial_path, std::ios::trunc | std::ios::binary};
+        for (std::size_t received{0}; received < RECEIVED_BEFORE_DROP;) {
+            std::string_view data = receiver.receiveToBuffer();
+            partial_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            received += data.size();
+        }
+        ResumeCheckpoint{.file_id = InitSessionMessage::fileId(metadata),
+                         .partial_path = partial_path,
+                         .offset = RECEIVED_BEFORE_DROP}.save(checkpoint_path);
+    }
+
+    void waitForSenderToResume() {
+        for (int i = 0; i < 100 && sessions_manager->currentSessions() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        ASSERT_EQ(sessions_manager->currentSessions(), 1);
+    }
+};
+
+TEST_F(ResumableTransferTests, resumesTransferAfterReceiverConnectionDrops) {
+    DropFileSendClient send_client{createClientSocket(), reconnect_policy};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+
+    receivePartiallyAndDrop(receive_code);
+    waitForSenderToResume();
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, false, reconnect_policy};
+    recv_client.receiveFile(receive_code);
+
+    ASSERT_NO_THROW(send_result.get());
+    ASSERT_TRUE(filesContentEqual(getExpectedPath(), TEST_FILE_PATH));
+}
+
+TEST_F(ResumableTransferTests, senderGivesUpWithoutReconnectPolicy) {
+    DropFileSendClient send_client{createClientSocket()};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+
+    receivePartiallyAndDrop(receive_code);
+    ASSERT_THROW(send_result.get(), boost::system::system_error);
+}
+
+struct RateLimitedServerTests : public Test {
+    const unsigned short TEST_PORT{61346};
+    const std::size_t SERVER_RATE_LIMIT{1024 * 1024};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager<>>(
+            SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1), SessionDeadlines{}, DEFAULT_FRAME_SIZE,
+            TuningProfile{}, SERVER_RATE_LIMIT)};
+    const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_rate_limit_fs_entry"};
+    std::stringstream interaction_stream;
+    std::jthread server_thread;
+
+    void SetUp() override {
+        server_thread = std::jthread{[&]{
+            server.run();
+        }};
+    }
+
+    void TearDown () override {
+        std::filesystem::remove_all(TEST_FILE_PATH);
+        std::filesystem::remove_all(std::filesystem::current_path() / TEST_FILE_PATH.filename());
+        server.stop();
+        server_thread.join();
+    }
+
+    ClientSocket<> createClientSocket() {
+        return {"localhost", TEST_PORT, false};
+    }
+};
+
+TEST_F(RateLimitedServerTests, relaysNoFasterThanRateLimit) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(SERVER_RATE_LIMIT / 4);
+    }
+    DropFileSendClient send_client{createClientSocket()};
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto start = std::chrono::steady_clock::now();
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{200});
+    ASSERT_TRUE(filesContentEqual(std::filesystem::current_path() / TEST_FILE_PATH.filename(), TEST_FILE_PATH));
+}
+
+TEST_F(DropFileServerIntegrationTests, receivesWithDirectIoWhateverFileSystemSupports) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << generateRandomString(RangeWriter::WRITE_SIZE + 4096 + 17);
+    }
+    DropFileSendClient send_client{createClientSocket(), {}, 2};
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, false, {}, {}, true};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_EQ(getFileContent(getExpectedPath()), getFileContent(TEST_FILE_PATH));
+}
+
+TEST_F(DropFileServerIntegrationTests, measuresPhasesOfTransfer) {
+    std::string content{generateRandomString(SocketBase<>::BUFFER_SIZE + 17)};
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << content;
+    }
+    TransferStats send_stats;
+    TransferStats receive_stats;
+    DropFileSendClient send_client{createClientSocket(), {}, 1, DEFAULT_HASH_ALGORITHM, false, {}, 0, false, true,
+                                   &send_stats};
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, true, {}, {}, false, nullptr, true,
+                                      &receive_stats};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    auto names = [](const TransferStats &stats) {
+        std::vector<std::string> phase_names;
+        for (const auto &phase: stats.phases()) {
+            phase_names.push_back(phase.name);
+        }
+        return phase_names;
+    };
+    ASSERT_EQ(names(send_stats), (std::vector{TransferStats::WAIT_FOR_PEER, TransferStats::TRANSFER,
+                                              TransferStats::HASH, TransferStats::VERIFY}));
+    ASSERT_EQ(names(receive_stats), (std::vector{TransferStats::WAIT_FOR_PEER, TransferStats::TRANSFER,
+                                                 TransferStats::HASH}));
+    ASSERT_EQ(send_stats.phases()[1].bytes, content.size());
+    ASSERT_EQ(receive_stats.phases()[1].bytes, content.size());
+    ASSERT_GT(receive_stats.phases()[1].peak_rss, 0);
+}
+
+struct PipedDataTests : public DropFileServerIntegrationTests {
+    std::string content{generateRandomString(3 * SocketBase<>::BUFFER_SIZE + 17)};
+    std::array<int, 2> pipe_ends{-1, -1};
+    std::jthread producer;
+
+    void SetUp() override {
+        DropFileServerIntegrationTests::SetUp();
+        ASSERT_EQ(::pipe(pipe_ends.data()), 0);
+    }
+
+    // Written in small pieces, as a pipe usually is.
+    void producePipedData() {
+        producer = std::jthread{[&] {
+            for (std::string_view left{content}; !left.empty();) {
+                ssize_t written = ::write(pipe_ends[1], left.data(), std::min(left.size(), std::size_t{1000}));
+                if (written <= 0) {
+                    break;
+                }
+                left.remove_prefix(static_cast<std::size_t>(written));
+            }
+            ::close(std::exchange(pipe_ends[1], -1));
+        }};
+    }
+
+    void TearDown() override {
+        if (producer.joinable()) {
+            producer.join();
+        } else {
+            ::close(pipe_ends[1]);
+        }
+        ::close(pipe_ends[0]);
+        DropFileServerIntegrationTests::TearDown();
+    }
+
+    std::string pipeName() const {
+        return TEST_FILE_PATH.filename().string();
+    }
+};
+
+TEST_F(PipedDataTests, sendsPipedDataToOutputAsItComes) {
+    DropFileSendClient send_client{createClientSocket()};
+    std::stringstream output;
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, false, {}, {}, false, &output};
+
+    auto receive_code = send_client.sendPipeMetadata(pipeName());
+    producePipedData();
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendPipe(pipe_ends[0]);
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_EQ(output.str(), content);
+    ASSERT_FALSE(std::filesystem::exists(getExpectedPath()));
+}
+
+TEST_F(PipedDataTests, receivesPipedDataIntoFile) {
+    DropFileSendClient send_client{createClientSocket()};
+    DropFileReceiveClient recv_client{createRecvClient('y')};
+
+    auto receive_code = send_client.sendPipeMetadata(pipeName());
+    producePipedData();
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendPipe(pipe_ends[0]);
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_EQ(getFileContent(getExpectedPath()), content);
+}
+
+TEST_F(PipedDataTests, refusesReceiverThatCannotTakePipedData) {
+    DropFileSendClient send_client{createClientSocket()};
+    auto receive_code = send_client.sendPipeMetadata(pipeName());
+
+    auto old_receiver = createClientSocket();
+    old_receiver.requestFramedProtocol();
+    auto receive_message = InitSessionMessage::createReceiveMessage(receive_code);
+    receive_message.erase(InitSessionMessage::ACCEPTS_PIPE_KEY);
+    old_receiver.sendFrame(FrameType::metadata, receive_message.dump());
+    ASSERT_EQ(old_receiver.receiveFrame().type, FrameType::error);
+    ASSERT_ANY_THROW(send_client.sendPipe(pipe_ends[0]));
+}
+
+TEST_F(DropFileServerIntegrationTests, writesReceivedFileToOutput) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestFile();
+    std::stringstream output;
+    interaction_stream << 'y';
+    DropFileReceiveClient recv_client{createClientSocket(), interaction_stream, false, {}, {}, false, &output};
+
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+    auto send_result = std::async(std::launch::async, [&]{
+        send_client.sendFSEntry(std::move(fs_entry));
+    });
+    recv_client.receiveFile(receive_code);
+    send_result.get();
+
+    ASSERT_EQ(output.str(), FILE_CONTENT);
+    ASSERT_FALSE(std::filesystem::exists(getExpectedPath()));
+}
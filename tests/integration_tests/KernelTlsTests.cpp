@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "KernelTls.hpp"
+#include "StreamPolicy.hpp"
+
+#include <openssl/evp.h>
+
+#include <memory>
+
+
+using namespace ::testing;
+
+struct KernelTlsTests : public Test {
+    boost::asio::ssl::context server_context{StreamPolicy<TlsStream>::createServerContext(EXAMPLE_CERT_DIR)};
+    boost::asio::ssl::context client_context{StreamPolicy<TlsStream>::createClientContext()};
+    std::unique_ptr<SSL, decltype(&SSL_free)> server{SSL_new(server_context.native_handle()), &SSL_free};
+    std::unique_ptr<SSL, decltype(&SSL_free)> client{SSL_new(client_context.native_handle()), &SSL_free};
+    static constexpr std::size_t RECORD_HEADER_SIZE{5};
+    static constexpr std::size_t TAG_SIZE{16};
+
+    // Both ends are in memory, what one of them writes the other one reads.
+    void handshake() {
+        BIO *client_bio{nullptr};
+        BIO *server_bio{nullptr};
+        ASSERT_EQ(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0), 1);
+        SSL_set_bio(client.get(), client_bio, client_bio);
+        SSL_set_bio(server.get(), server_bio, server_bio);
+        SSL_set_connect_state(client.get());
+        SSL_set_accept_state(server.get());
+        for (int round = 0; round < 10 && !(SSL_is_init_finished(client.get()) &&
+                                            SSL_is_init_finished(server.get())); ++round) {
+            SSL_do_handshake(client.get());
+            SSL_do_handshake(server.get());
+        }
+        ASSERT_TRUE(SSL_is_init_finished(client.get()) && SSL_is_init_finished(server.get()));
+    }
+
+    // Record as it has left the client, before the server has read it.
+    std::string sendRecord(std::string_view plaintext) {
+        SSL_write(client.get(), plaintext.data(), static_cast<int>(plaintext.size()));
+        std::string record(16 * 1024 + 256, '\0');
+        int size = BIO_read(SSL_get_rbio(server.get()), record.data(), static_cast<int>(record.size()));
+        record.resize(static_cast<std::size_t>(std::max(size, 0)));
+        return record;
+    }
+
+    // What the kernel does with the first record, sequence number 0 leaves the IV as it is.
+    static std::optional<std::string> decryptFirstRecord(const TrafficKeys &keys, std::string_view record) {
+        std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> context{EVP_CIPHER_CTX_new(),
+                                                                                &EVP_CIPHER_CTX_free};
+        auto *key = reinterpret_cast<const unsigned char *>(keys.key.data());
+        auto *iv = reinterpret_cast<const unsigned char *>(keys.iv.data());
+        auto *bytes = reinterpret_cast<const unsigned char *>(record.data());
+        int ciphertext_size = static_cast<int>(record.size() - RECORD_HEADER_SIZE - TAG_SIZE);
+        std::string plaintext(record.size(), '\0');
+        auto *out = reinterpret_cast<unsigned char *>(plaintext.data());
+        int size{0};
+        int final_size{0};
+        if (EVP_DecryptInit_ex(context.get(), EVP_aes_128_gcm(), nullptr, key, iv) != 1 ||
+            EVP_DecryptUpdate(context.get(), nullptr, &size, bytes, RECORD_HEADER_SIZE) != 1 ||
+            EVP_DecryptUpdate(context.get(), out, &size, bytes + RECORD_HEADER_SIZE, ciphertext_size) != 1 ||
+            EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_TAG, TAG_SIZE,
+                                const_cast<unsigned char *>(bytes + record.size() - TAG_SIZE)) != 1 ||
+            EVP_DecryptFinal_ex(context.get(), out + size, &final_size) != 1) {
+            return std::nullopt;
+        }
+        plaintext.resize(static_cast<std::size_t>(size + final_size));
+        return plaintext;
+    }
+};
+
+TEST_F(KernelTlsTests, derivesKeysClientEncryptsWith) {
+    SSL_set_ciphersuites(client.get(), "TLS_AES_128_GCM_SHA256");
+    handshake();
+    auto keys = sendingTrafficKeys(client.get());
+    ASSERT_TRUE(keys.has_value());
+    ASSERT_EQ(keys->key.size(), 16);
+    ASSERT_EQ(keys->iv.size(), 12);
+
+    std::string record = sendRecord("hello");
+    auto plaintext = decryptFirstRecord(*keys, record);
+    ASSERT_TRUE(plaintext.has_value());
+    ASSERT_EQ(*plaintext, std::string{"hello"} + '\x17'); // content type of application data trails it in TLS 1.3
+}
+
+TEST_F(KernelTlsTests, derivesLongerKeysOfOtherCiphers) {
+    SSL_set_ciphersuites(client.get(), "TLS_CHACHA20_POLY1305_SHA256");
+    handshake();
+    auto keys = sendingTrafficKeys(client.get());
+    ASSERT_TRUE(keys.has_value());
+    ASSERT_EQ(keys->key.size(), 32);
+}
+
+TEST_F(KernelTlsTests, handsOverOnlyTls13) {
+    SSL_set_max_proto_version(client.get(), TLS1_2_VERSION);
+    handshake();
+    ASSERT_FALSE(sendingTrafficKeys(client.get()).has_value());
+    ASSERT_FALSE(enableKernelTlsSend(client.get(), -1));
+}
+
+TEST_F(KernelTlsTests, needsCapturedSecret) {
+    handshake();
+    ASSERT_FALSE(sendingTrafficKeys(server.get()).has_value()); // server's context does not capture it
+}
@@ -10,20 +10,25 @@
 #include <filesystem>
 
 
-class MaliciousSendClient : public DropFileSendClient {
+class MaliciousSendClient : public DropFileSendClient<> {
 public:
-    MaliciousSendClient(ClientSocket socket) : DropFileSendClient(std::move(socket)) {}
+    MaliciousSendClient(ClientSocket<> socket) : DropFileSendClient(std::move(socket)) {}
 
     void sendFSEntryThatWillNotMatchHash(RAIIFSEntry data_source) {
-        socket.SocketBase::receiveACK();
+        socket.receiveACK();
         std::size_t file_size = std::filesystem::file_size(data_source.path);
-
-
-        for (std::size_t total_bytes_sent{0}, bytes_sent{0}; total_bytes_sent < file_size; total_bytes_sent += bytes_sent) {
-            std::size_t left_bytes_to_send = file_size - total_bytes_sent;
-            bytes_sent = std::min(SocketBase::BUFFER_SIZE, left_bytes_to_send);
-            socket.SocketBase::send(generateRandomString(bytes_sent));
-            socket.SocketBase::receiveACK();
+        auto leaves = MerkleTree::fromFile(data_source.path).leaves();
+
+        try {
+            for (std::size_t total_bytes_sent{0}, bytes_sent{0}; total_bytes_sent < file_size; total_bytes_sent += bytes_sent) {
+                std::size_t left_bytes_to_send = file_size - total_bytes_sent;
+                bytes_sent = std::min(SocketBase<>::BUFFER_SIZE, left_bytes_to_send);
+                socket.send(generateRandomString(bytes_sent));
+            }
+            socket.sendFrame(FrameType::chunk_hashes, encodeChunkHashes(0, leaves.front())); // of the real file
+            socket.receiveACK();
+        } catch (const boost::system::system_error &) {
+            // receiver hangs up as soon as the first chunk does not match its hash
         }
     }
 
@@ -34,9 +39,9 @@ public:
 
         for (std::size_t total_bytes_sent{0}, bytes_sent{0}; total_bytes_sent < file_size; total_bytes_sent += bytes_sent) {
             std::size_t left_bytes_to_send = file_size - total_bytes_sent;
-            bytes_sent = std::min(SocketBase::BUFFER_SIZE, left_bytes_to_send);
-            socket.SocketBase::send(generateRandomString(bytes_sent));
-            socket.SocketBase::receiveACK();
+            bytes_sent = std::min(SocketBase<>::BUFFER_SIZE, left_bytes_to_send);
+            socket.send(generateRandomString(bytes_sent));
+            socket.receiveACK();
         }
     }
 };
@@ -46,7 +51,7 @@ using namespace ::testing;
 
 struct MaliciousClientTests : public Test {
     const unsigned short TEST_PORT{55342};
-    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager>(SessionsManager::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1))};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, std::make_shared<SessionsManager<>>(SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, std::chrono::seconds(1))};
     const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_fs_entry"};
 
     const std::string FILE_CONTENT{"Hello world, this is some content!"};
@@ -97,12 +102,12 @@ struct MaliciousClientTests : public Test {
         return std::filesystem::current_path() / TEST_FILE_PATH.filename();
     }
 
-    DropFileReceiveClient createRecvClient(char character) {
+    DropFileReceiveClient<> createRecvClient(char character) {
         interaction_stream << character;
         return {createClientSocket(), interaction_stream};
     }
 
-    ClientSocket createClientSocket() {
+    ClientSocket<> createClientSocket() {
         return {"localhost", TEST_PORT, false};
     }
 
@@ -138,8 +143,8 @@ TEST_F(MaliciousClientTests, serverDoesNotAllowAbnormallyBigFirstMessages) {
     auto json_msg = InitSessionMessage::createSendMessage(TEST_FILE_PATH, false);
     json_msg[InitSessionMessage::FILE_HASH_KEY] = maliciously_long_file_hash;
     auto msg = json_msg.dump();
-    test_client.send(msg);
     try {
+        test_client.send(msg);
         auto response = test_client.receive();
         ASSERT_TRUE(response.contains(fmt::format("Tried to send {} bytes, which is more than allowed", msg.size())));
     } catch (const boost::wrapexcept<boost::system::system_error> &e) {
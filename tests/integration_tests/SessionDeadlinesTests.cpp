@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "client/DropFileSendClient.hpp"
+#include "server/DropFileServer.hpp"
+#include "InitSessionMessage.hpp"
+
+#include <filesystem>
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+struct SessionDeadlinesTests : public Test {
+    const unsigned short TEST_PORT{57342};
+    const SessionDeadlines TEST_DEADLINES{.handshake = 1s, .first_message = 1s, .receiver_confirmation = 1s,
+            .chunk_idle = 1s, .total_transfer = 0s};
+    std::shared_ptr<SessionsManager<>> sessions_manager{
+            std::make_shared<SessionsManager<>>(SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, 1s, TEST_DEADLINES)};
+    DropFileServer<> server{TEST_PORT, EXAMPLE_CERT_DIR, sessions_manager};
+    const std::filesystem::path TEST_FILE_PATH{std::filesystem::temp_directory_path() / "test_deadlines_fs_entry"};
+    std::jthread server_thread;
+
+    void SetUp() override {
+        spdlog::set_level(spdlog::level::debug);
+        server_thread = std::jthread{[&] {
+            server.run();
+        }};
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(TEST_FILE_PATH);
+        server.stop();
+        server_thread.join();
+    }
+
+    void createTestFile() const {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        file << "Hello world, this is some content!";
+    }
+
+    ClientSocket<> createClientSocket() {
+        return {"localhost", TEST_PORT, false};
+    }
+};
+
+TEST_F(SessionDeadlinesTests, disconnectsClientThatNeverSendsFirstMessage) {
+    auto idle_client = createClientSocket();
+
+    ASSERT_THROW(idle_client.receive(), boost::exception);
+    ASSERT_EQ(sessions_manager->timeoutCounters().get(SessionPhase::first_message), 1);
+}
+
+TEST_F(SessionDeadlinesTests, disconnectsBothPeersWhenReceiverNeverConfirms) {
+    DropFileSendClient send_client{createClientSocket()};
+    createTestFile();
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+
+    auto silent_receiver = createClientSocket();
+    silent_receiver.send(InitSessionMessage::createReceiveMessage(receive_code).dump());
+    ASSERT_NO_THROW(silent_receiver.receive()); // metadata
+
+    ASSERT_THROW(send_client.sendFSEntry(std::move(fs_entry)), boost::exception);
+    ASSERT_THROW(silent_receiver.receive(), boost::exception);
+    ASSERT_EQ(sessions_manager->timeoutCounters().get(SessionPhase::receiver_confirmation), 1);
+}
+
+TEST_F(SessionDeadlinesTests, evictsReceiverThatStopsReadingMidTransfer) {
+    {
+        std::ofstream file{TEST_FILE_PATH, std::ios::trunc | std::ios::binary};
+        std::string content(64 * SocketBase<>::BUFFER_SIZE, 'x');
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    DropFileSendClient send_client{createClientSocket()};
+    auto [fs_entry, receive_code] = send_client.sendFSEntryMetadata(TEST_FILE_PATH);
+
+    auto stalled_receiver = createClientSocket();
+    stalled_receiver.send(InitSessionMessage::createReceiveMessage(receive_code).dump());
+    ASSERT_NO_THROW(stalled_receiver.receive()); // metadata
+    stalled_receiver.sendACK(); // and never reads anything again
+
+    ASSERT_THROW(send_client.sendFSEntry(std::move(fs_entry)), boost::exception);
+    ASSERT_EQ(sessions_manager->timeoutCounters().get(SessionPhase::chunk_idle), 1);
+}
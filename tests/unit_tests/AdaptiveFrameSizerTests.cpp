@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "client/AdaptiveFrameSizer.hpp"
+#include "Framing.hpp"
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(AdaptiveFrameSizerTests, startsWithSmallFrames) {
+    AdaptiveFrameSizer sizer{MAX_FRAME_SIZE};
+    ASSERT_EQ(sizer.frameSize(), AdaptiveFrameSizer::INITIAL_FRAME_SIZE);
+}
+
+TEST(AdaptiveFrameSizerTests, initialFrameDoesNotExceedNegotiatedMaximum) {
+    AdaptiveFrameSizer sizer{MIN_FRAME_SIZE};
+    ASSERT_EQ(sizer.frameSize(), MIN_FRAME_SIZE);
+}
+
+TEST(AdaptiveFrameSizerTests, growsOnFastLinkUpToMaximum) {
+    std::size_t max_frame_size{4 * 1024 * 1024};
+    AdaptiveFrameSizer sizer{max_frame_size};
+    for (int i = 0; i < 20; ++i) {
+        sizer.recordSend(sizer.frameSize(), 10us); // way above 1 GB/s
+    }
+    ASSERT_EQ(sizer.frameSize(), max_frame_size);
+}
+
+TEST(AdaptiveFrameSizerTests, shrinksOnSlowLink) {
+    AdaptiveFrameSizer sizer{MAX_FRAME_SIZE};
+    for (int i = 0; i < 20; ++i) {
+        sizer.recordSend(sizer.frameSize(), 1s); // a few KB/s
+    }
+    ASSERT_EQ(sizer.frameSize(), MIN_FRAME_SIZE);
+}
+
+TEST(AdaptiveFrameSizerTests, settlesAroundTargetFrameDuration) {
+    AdaptiveFrameSizer sizer{MAX_FRAME_SIZE};
+    constexpr double BYTES_PER_SECOND{80.0 * 1024 * 1024};
+    for (int i = 0; i < 50; ++i) {
+        auto elapsed = std::chrono::duration<double>(static_cast<double>(sizer.frameSize()) / BYTES_PER_SECOND);
+        sizer.recordSend(sizer.frameSize(), std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+    }
+    // 80 MiB/s * 5 ms = 410 KiB, rounded down to power of two
+    ASSERT_EQ(sizer.frameSize(), 256 * 1024);
+}
+
+TEST(AdaptiveFrameSizerTests, framesAreAlwaysPowersOfTwo) {
+    AdaptiveFrameSizer sizer{MAX_FRAME_SIZE};
+    sizer.recordSend(123'456, 3ms);
+    ASSERT_TRUE(std::has_single_bit(sizer.frameSize()));
+}
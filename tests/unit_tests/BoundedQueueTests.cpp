@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "client/BoundedQueue.hpp"
+
+#include <future>
+#include <string>
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(BoundedQueueTests, keepsOrderOfItems) {
+    BoundedQueue<std::string> queue{3};
+    ASSERT_TRUE(queue.push("first"));
+    ASSERT_TRUE(queue.push("second"));
+    ASSERT_EQ(queue.pop(), "first");
+    ASSERT_EQ(queue.pop(), "second");
+}
+
+TEST(BoundedQueueTests, producerWaitsWhileQueueIsFull) {
+    BoundedQueue<int> queue{1};
+    ASSERT_TRUE(queue.push(1));
+    auto producer = std::async(std::launch::async, [&] {
+        return queue.push(2);
+    });
+    ASSERT_EQ(producer.wait_for(100ms), std::future_status::timeout);
+    ASSERT_EQ(queue.pop(), 1);
+    ASSERT_TRUE(producer.get());
+    ASSERT_EQ(queue.pop(), 2);
+}
+
+TEST(BoundedQueueTests, consumerGetsRemainingItemsAfterClose) {
+    BoundedQueue<int> queue{2};
+    queue.push(1);
+    queue.close();
+    ASSERT_FALSE(queue.push(2));
+    ASSERT_EQ(queue.pop(), 1);
+    ASSERT_EQ(queue.pop(), std::nullopt);
+}
+
+TEST(BoundedQueueTests, closingWakesUpWaitingSides) {
+    BoundedQueue<int> full_queue{1};
+    full_queue.push(1);
+    auto producer = std::async(std::launch::async, [&] {
+        return full_queue.push(2);
+    });
+    BoundedQueue<int> empty_queue{1};
+    auto consumer = std::async(std::launch::async, [&] {
+        return empty_queue.pop();
+    });
+    full_queue.close();
+    empty_queue.close();
+    ASSERT_FALSE(producer.get());
+    ASSERT_EQ(consumer.get(), std::nullopt);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "client/ChunkVerifier.hpp"
+
+
+using namespace ::testing;
+
+struct ChunkVerifierTests : public Test {
+    const std::filesystem::path PATH{std::filesystem::temp_directory_path() / "test_chunk_verifier_file"};
+    const std::size_t CHUNK_SIZE{MerkleTree::MIN_CHUNK_SIZE};
+    const std::string CONTENT{generateRandomString(3 * CHUNK_SIZE + 10)};
+    const ByteRange WHOLE_FILE{0, CONTENT.size()};
+
+    void TearDown() override {
+        std::filesystem::remove(PATH);
+    }
+
+    std::vector<MerkleTree::Digest> leaves() const {
+        std::ofstream{PATH, std::ios::binary} << CONTENT;
+        auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE);
+        std::filesystem::remove(PATH);
+        return tree.leaves();
+    }
+};
+
+TEST_F(ChunkVerifierTests, acceptsIntactDataWithTrailingLeaves) {
+    ChunkVerifier verifier{CONTENT.size(), CHUNK_SIZE};
+    auto range_verifier = verifier.verifyRange(WHOLE_FILE, 0, PATH);
+    auto expected_leaves = leaves();
+    for (std::size_t i = 0; i < expected_leaves.size(); ++i) {
+        ASSERT_FALSE(range_verifier.isComplete());
+        range_verifier.update(std::string_view{CONTENT}.substr(i * CHUNK_SIZE, CHUNK_SIZE));
+        range_verifier.addExpectedLeaves({i, expected_leaves[i]});
+    }
+    ASSERT_TRUE(range_verifier.isComplete());
+    std::ofstream{PATH, std::ios::binary} << CONTENT;
+    ASSERT_EQ(verifier.root(PATH), MerkleTree::fromFile(PATH, CHUNK_SIZE).root());
+    ASSERT_EQ(verifier.expectedRoot(), verifier.root(PATH));
+}
+
+TEST_F(ChunkVerifierTests, failsFastOnCorruptedChunk) {
+    ChunkVerifier verifier{CONTENT.size(), CHUNK_SIZE};
+    std::string corrupted = CONTENT;
+    corrupted[CHUNK_SIZE + 5] = static_cast<char>(corrupted[CHUNK_SIZE + 5] + 1);
+    auto range_verifier = verifier.verifyRange(WHOLE_FILE, 0, PATH);
+    auto expected_leaves = leaves();
+    range_verifier.update(std::string_view{corrupted}.substr(0, 2 * CHUNK_SIZE));
+    range_verifier.addExpectedLeaves({0, expected_leaves[0]});
+    try {
+        range_verifier.addExpectedLeaves({1, expected_leaves[1]});
+        FAIL() << "Corrupted chunk was accepted.";
+    } catch (const CorruptedChunkException &e) {
+        ASSERT_EQ(e.chunkBegin(), CHUNK_SIZE);
+    }
+}
+
+TEST_F(ChunkVerifierTests, resumedRangeHashesItsFirstChunkFromDisk) {
+    ChunkVerifier verifier{CONTENT.size(), CHUNK_SIZE};
+    std::size_t resume_offset{CHUNK_SIZE + 100};
+    std::ofstream{PATH, std::ios::binary} << CONTENT.substr(0, resume_offset);
+    auto range_verifier = verifier.verifyRange(WHOLE_FILE, resume_offset, PATH);
+    auto expected_leaves = leaves();
+    std::string digests;
+    for (const auto &leaf: expected_leaves) {
+        digests += leaf;
+    }
+    range_verifier.addExpectedLeaves({0, digests});
+    ASSERT_FALSE(range_verifier.isComplete());
+    ASSERT_NO_THROW(range_verifier.update(std::string_view{CONTENT}.substr(resume_offset)));
+    ASSERT_TRUE(range_verifier.isComplete());
+}
+
+TEST_F(ChunkVerifierTests, rootReadsChunksNotReceivedFromDisk) {
+    ChunkVerifier verifier{CONTENT.size(), CHUNK_SIZE};
+    std::string corrupted = CONTENT;
+    corrupted[0] = static_cast<char>(corrupted[0] + 1);
+    std::ofstream{PATH, std::ios::binary} << corrupted;
+    std::string expected_root = MerkleTree::fromFile(PATH, CHUNK_SIZE).root();
+    ASSERT_EQ(verifier.root(PATH), expected_root);
+    ASSERT_THROW(verifier.expectedRoot(), ChunkVerifierException);
+}
+
+TEST_F(ChunkVerifierTests, acceptsOnlyLeavesOfItsOwnStripe) {
+    ChunkVerifier verifier{CONTENT.size(), CHUNK_SIZE};
+    auto range_verifier = verifier.verifyRange({CHUNK_SIZE, 2 * CHUNK_SIZE}, CHUNK_SIZE, PATH);
+    MerkleTree::Digest leaf(MerkleTree::DIGEST_SIZE, 'x');
+    ASSERT_THROW(range_verifier.addExpectedLeaves({0, leaf}), ChunkVerifierException);
+    ASSERT_THROW(range_verifier.addExpectedLeaves({1, leaf + leaf}), ChunkVerifierException);
+    ASSERT_THROW(range_verifier.addExpectedLeaves({1, "too short"}), ChunkVerifierException);
+    ASSERT_NO_THROW(range_verifier.addExpectedLeaves({1, leaf}));
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include "client/ClientArgParser.hpp"
+#include "client/ReconnectPolicy.hpp"
+#include "Striping.hpp"
 
 
 using namespace ::testing;
@@ -39,7 +41,7 @@ TEST(ClientArgParserTests, noThrowWhenCorrectSendArgs) {
     ASSERT_NO_THROW(send_args = parseClientArgs(argc, argv_send));
     ASSERT_EQ(send_args.action, Action::send);
     ASSERT_FALSE(send_args.receive_code.has_value());
-    ASSERT_EQ(*send_args.file_to_send_path, "send_value");
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"send_value"}));
 }
 
 TEST(ClientArgParserTests, noThrowWhenCorrectRecvArgs) {
@@ -50,7 +52,7 @@ TEST(ClientArgParserTests, noThrowWhenCorrectRecvArgs) {
     ASSERT_NO_THROW(recv_args = parseClientArgs(argc, argv_recv));
     ASSERT_EQ(recv_args.action, Action::receive);
     ASSERT_EQ(*recv_args.receive_code, "recv_value");
-    ASSERT_FALSE(recv_args.file_to_send_path.has_value());
+    ASSERT_TRUE(recv_args.files_to_send.empty());
 }
 
 TEST(ClientArgParserTests, setsCorrectDefaultValuesOnSend) {
@@ -83,7 +85,7 @@ TEST(ClientArgParserTests, trimsSlashesOutOfPaths) {
     char * argv_send[] = {"program_name", "send", "/some/path////"};
     ClientArgs send_args = parseClientArgs(argc, argv_send);
 
-    ASSERT_EQ(*send_args.file_to_send_path, "/some/path");
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"/some/path"}));
 }
 
 TEST(ClientArgParserTests, doesNotTrimSlashes) {
@@ -91,7 +93,7 @@ TEST(ClientArgParserTests, doesNotTrimSlashes) {
     char * argv_send[] = {"program_name", "send", "/some/path"};
     ClientArgs send_args = parseClientArgs(argc, argv_send);
 
-    ASSERT_EQ(*send_args.file_to_send_path, "/some/path");
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"/some/path"}));
 }
 
 TEST(ClientArgParserTests, doesNotTrimFirstSlashCharacter) {
@@ -99,7 +101,7 @@ TEST(ClientArgParserTests, doesNotTrimFirstSlashCharacter) {
     char * argv_send[] = {"program_name", "send", "/////"};
     ClientArgs send_args = parseClientArgs(argc, argv_send);
 
-    ASSERT_EQ(*send_args.file_to_send_path, "/");
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"/"}));
 }
 
 TEST(ClientArgParserTests, doesNotTrimAnything) {
@@ -107,11 +109,154 @@ TEST(ClientArgParserTests, doesNotTrimAnything) {
     char * argv_send[] = {"program_name", "send", "aaa"};
     ClientArgs send_args = parseClientArgs(argc, argv_send);
 
-    ASSERT_EQ(*send_args.file_to_send_path, "aaa");
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"aaa"}));
 }
 
 TEST(ClientArgParserTests, doesNotBreakWhenThirdArgIsSomehowEmptyStr) {
     int argc{3};
     char * argv_send[] = {"program_name", "send", ""};
-    ASSERT_EQ(*parseClientArgs(argc, argv_send).file_to_send_path, "");
-}
\ No newline at end of file
+    ASSERT_EQ(parseClientArgs(argc, argv_send).files_to_send, (std::vector<std::string>{""}));
+}
+TEST(ClientArgParserTests, setsAutoAcceptFlag) {
+    char * argv_recv[] = {"program_name", "receive", "recv_value"};
+    ASSERT_FALSE(parseClientArgs(3, argv_recv).auto_accept);
+
+    char * argv_recv_yes[] = {"program_name", "receive", "recv_value", "-y"};
+    ASSERT_TRUE(parseClientArgs(4, argv_recv_yes).auto_accept);
+}
+
+TEST(ClientArgParserTests, setsReconnectAttempts) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_EQ(parseClientArgs(3, argv_send).reconnect_attempts, ReconnectPolicy::DEFAULT_MAX_ATTEMPTS);
+
+    char * argv_recv[] = {"program_name", "receive", "recv_value", "--reconnect_attempts", "0"};
+    ASSERT_EQ(parseClientArgs(5, argv_recv).reconnect_attempts, 0);
+}
+
+TEST(ClientArgParserTests, setsStreamsCount) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_EQ(parseClientArgs(3, argv_send).streams, 1);
+
+    char * argv_send_striped[] = {"program_name", "send", "file", "--streams", "4"};
+    ASSERT_EQ(parseClientArgs(5, argv_send_striped).streams, 4);
+}
+
+TEST(ClientArgParserTests, throwsOnInvalidStreamsCount) {
+    char * argv_zero[] = {"program_name", "send", "file", "-s", "0"};
+    ASSERT_THROW(parseClientArgs(5, argv_zero), ClientArgParserException);
+
+    std::string too_many = std::to_string(MAX_STREAMS + 1);
+    char * argv_too_many[] = {"program_name", "send", "file", "-s", too_many.data()};
+    ASSERT_THROW(parseClientArgs(5, argv_too_many), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, acceptsSeveralPathsToSend) {
+    char * argv_send[] = {"program_name", "send", "a", "b/", "c", "-s", "2"};
+    ClientArgs send_args = parseClientArgs(7, argv_send);
+    ASSERT_EQ(send_args.files_to_send, (std::vector<std::string>{"a", "b", "c"}));
+    ASSERT_EQ(send_args.streams, 2);
+
+    char * argv_recv[] = {"program_name", "receive", "code", "another-code"};
+    ASSERT_THROW(parseClientArgs(4, argv_recv), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, setsHashAlgorithm) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_EQ(parseClientArgs(3, argv_send).hash_algorithm, DEFAULT_HASH_ALGORITHM);
+
+    char * argv_send_sha256[] = {"program_name", "send", "file", "--hash", "sha256"};
+    ASSERT_EQ(parseClientArgs(5, argv_send_sha256).hash_algorithm, HashAlgorithm::sha256);
+}
+
+TEST(ClientArgParserTests, setsDirectOnlyForSingleStream) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_FALSE(parseClientArgs(3, argv_send).direct);
+
+    char * argv_send_direct[] = {"program_name", "send", "file", "--direct"};
+    ASSERT_TRUE(parseClientArgs(4, argv_send_direct).direct);
+
+    char * argv_send_striped[] = {"program_name", "send", "file", "--direct", "-s", "4"};
+    ASSERT_THROW(parseClientArgs(6, argv_send_striped), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, setsCongestionControlForBothActions) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_TRUE(parseClientArgs(3, argv_send).tuning_profile.congestion_control.empty());
+
+    char * argv_send_bbr[] = {"program_name", "send", "file", "--congestion_control", "bbr"};
+    ASSERT_EQ(parseClientArgs(5, argv_send_bbr).tuning_profile.congestion_control, "bbr");
+
+    char * argv_receive_bbr[] = {"program_name", "receive", "code", "--congestion_control", "bbr"};
+    ASSERT_EQ(parseClientArgs(5, argv_receive_bbr).tuning_profile.congestion_control, "bbr");
+}
+
+TEST(ClientArgParserTests, parsesRateLimitInKiB) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_EQ(parseClientArgs(3, argv_send).rate_limit, 0);
+
+    char * argv_send_limited[] = {"program_name", "send", "file", "--limit_rate", "512"};
+    ASSERT_EQ(parseClientArgs(5, argv_send_limited).rate_limit, 512 * 1024);
+}
+
+TEST(ClientArgParserTests, throwsOnUnknownHashAlgorithm) {
+    char * argv_send[] = {"program_name", "send", "file", "--hash", "md5"};
+    ASSERT_THROW(parseClientArgs(5, argv_send), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, setsZeroCopy) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_FALSE(parseClientArgs(3, argv_send).zero_copy);
+
+    char * argv_send_zero_copy[] = {"program_name", "send", "file", "--zero_copy"};
+    ASSERT_TRUE(parseClientArgs(4, argv_send_zero_copy).zero_copy);
+}
+
+TEST(ClientArgParserTests, setsDirectIo) {
+    char * argv_receive[] = {"program_name", "receive", "code"};
+    ASSERT_FALSE(parseClientArgs(3, argv_receive).direct_io);
+
+    char * argv_receive_direct_io[] = {"program_name", "receive", "code", "--direct_io"};
+    ASSERT_TRUE(parseClientArgs(4, argv_receive_direct_io).direct_io);
+}
+
+TEST(ClientArgParserTests, sendsStandardInputAlone) {
+    char * argv_send[] = {"program_name", "send", "-"};
+    ASSERT_EQ(parseClientArgs(3, argv_send).files_to_send, std::vector<std::string>{ClientArgs::STANDARD_STREAM});
+
+    char * argv_send_more[] = {"program_name", "send", "-", "file"};
+    ASSERT_THROW(parseClientArgs(4, argv_send_more), ClientArgParserException);
+    char * argv_send_striped[] = {"program_name", "send", "-", "--streams", "2"};
+    ASSERT_THROW(parseClientArgs(5, argv_send_striped), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, receivesToStandardOutput) {
+    char * argv_receive[] = {"program_name", "receive", "code"};
+    ASSERT_FALSE(parseClientArgs(3, argv_receive).to_stdout);
+
+    char * argv_receive_to_stdout[] = {"program_name", "receive", "code", "-o", "-"};
+    ASSERT_TRUE(parseClientArgs(5, argv_receive_to_stdout).to_stdout);
+    char * argv_receive_elsewhere[] = {"program_name", "receive", "code", "--output", "file"};
+    ASSERT_THROW(parseClientArgs(5, argv_receive_elsewhere), ClientArgParserException);
+}
+
+TEST(ClientArgParserTests, setsQuiet) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_FALSE(parseClientArgs(3, argv_send).quiet);
+
+    char * argv_send_quiet[] = {"program_name", "send", "file", "-q"};
+    ASSERT_TRUE(parseClientArgs(4, argv_send_quiet).quiet);
+    char * argv_receive_quiet[] = {"program_name", "receive", "code", "--quiet"};
+    ASSERT_TRUE(parseClientArgs(4, argv_receive_quiet).quiet);
+}
+
+TEST(ClientArgParserTests, setsStatsFormat) {
+    char * argv_send[] = {"program_name", "send", "file"};
+    ASSERT_FALSE(parseClientArgs(3, argv_send).stats.has_value());
+
+    char * argv_send_stats[] = {"program_name", "send", "file", "--stats"};
+    ASSERT_EQ(parseClientArgs(4, argv_send_stats).stats, StatsFormat::text);
+    char * argv_receive_json[] = {"program_name", "receive", "code", "--stats=json"};
+    ASSERT_EQ(parseClientArgs(4, argv_receive_json).stats, StatsFormat::json);
+    char * argv_receive_xml[] = {"program_name", "receive", "code", "--stats=xml"};
+    ASSERT_THROW(parseClientArgs(4, argv_receive_xml), ClientArgParserException);
+}
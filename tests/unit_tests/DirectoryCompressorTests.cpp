@@ -123,3 +123,26 @@ TEST_F(DirectoryCompressorTests, canCompressAndDecompressBigDirectory) {
     ASSERT_TRUE(fs::exists(output_dir_path / input_dir_path.filename()));
     assertDirectoriesEqual(input_dir_path, output_dir_path / input_dir_path.filename());
 }
+
+TEST_F(DirectoryCompressorTests, canCompressAndDecompressSeveralEntries) {
+    setupInputDir();
+    fs::path file_path = input_dir_path / "test_file.txt";
+
+    ArchiveManager dc1{std::vector<fs::path>{input_dir_path / "nested_dir", file_path}};
+    dc1.createArchive(archive_path);
+
+    std::filesystem::create_directories(output_dir_path);
+    ArchiveManager dc2{output_dir_path};
+    dc2.unpackArchive(archive_path);
+
+    assertDirectoriesEqual(input_dir_path / "nested_dir", output_dir_path / "nested_dir");
+    ASSERT_EQ(getFileContent(output_dir_path / "test_file.txt"), "Some content");
+}
+
+TEST_F(DirectoryCompressorTests, cannotCompressEntriesOfTheSameName) {
+    setupInputDir();
+
+    ArchiveManager dc1{std::vector<fs::path>{input_dir_path / "test_file.txt",
+                                             input_dir_path / "nested_dir" / "test_file.txt"}};
+    ASSERT_THROW(dc1.createArchive(archive_path), ArchiveManagerException);
+}
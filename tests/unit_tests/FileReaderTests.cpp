@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "FileReader.hpp"
+
+
+using namespace ::testing;
+
+struct FileReaderTests : public TestWithParam<FileIOEngine> {
+    const std::filesystem::path PATH{std::filesystem::temp_directory_path() / "test_file_reader_file"};
+    const std::size_t BLOCK_SIZE{1000};
+
+    void TearDown() override {
+        std::filesystem::remove(PATH);
+    }
+
+    std::string writeRandomFile(std::size_t size) const {
+        std::string content = generateRandomString(size);
+        std::ofstream{PATH, std::ios::binary} << content;
+        return content;
+    }
+
+    static std::string readAll(FileReader &reader) {
+        std::string content;
+        for (std::string_view block = reader.next(); !block.empty(); block = reader.next()) {
+            content += block;
+        }
+        return content;
+    }
+};
+
+TEST_P(FileReaderTests, readsWholeFileBlockByBlock) {
+    std::string content = writeRandomFile(10 * BLOCK_SIZE + 7);
+    FileReader reader{PATH, BLOCK_SIZE, GetParam()};
+    ASSERT_EQ(reader.next().size(), BLOCK_SIZE);
+    ASSERT_EQ(BLOCK_SIZE + readAll(reader).size(), content.size());
+    ASSERT_TRUE(reader.next().empty());
+
+    FileReader another_reader{PATH, BLOCK_SIZE, GetParam()};
+    ASSERT_EQ(readAll(another_reader), content);
+}
+
+TEST_P(FileReaderTests, readsOnlyGivenRange) {
+    std::string content = writeRandomFile(10 * BLOCK_SIZE);
+    FileReader reader{PATH, {BLOCK_SIZE / 2, 7 * BLOCK_SIZE + 3}, BLOCK_SIZE, GetParam()};
+    ASSERT_EQ(readAll(reader), content.substr(BLOCK_SIZE / 2, 7 * BLOCK_SIZE + 3 - BLOCK_SIZE / 2));
+}
+
+TEST_P(FileReaderTests, readsEmptyRange) {
+    writeRandomFile(BLOCK_SIZE);
+    FileReader reader{PATH, {BLOCK_SIZE, BLOCK_SIZE}, BLOCK_SIZE, GetParam()};
+    ASSERT_TRUE(reader.next().empty());
+}
+
+TEST_P(FileReaderTests, throwsWhenFileEndsBeforeRange) {
+    writeRandomFile(2 * BLOCK_SIZE);
+    FileReader reader{PATH, {0, 5 * BLOCK_SIZE}, BLOCK_SIZE, GetParam()};
+    ASSERT_THROW(readAll(reader), FileReaderException);
+}
+
+TEST_P(FileReaderTests, throwsOnNonExistentFile) {
+    ASSERT_THROW(FileReader(PATH, BLOCK_SIZE, GetParam()), FileReaderException);
+}
+
+TEST_P(FileReaderTests, streamTellsItsPosition) {
+    std::string content = writeRandomFile(3 * FileReader::DEFAULT_BLOCK_SIZE + 11);
+    FileReaderStream stream{PATH, GetParam()};
+    std::string head(FileReader::DEFAULT_BLOCK_SIZE + 5, '\0');
+    stream.read(head.data(), static_cast<std::streamsize>(head.size()));
+    ASSERT_EQ(head, content.substr(0, head.size()));
+    ASSERT_EQ(stream.tellg(), head.size());
+
+    std::string rest{std::istreambuf_iterator<char>{stream}, {}};
+    ASSERT_EQ(rest, content.substr(head.size()));
+}
+
+TEST_P(FileReaderTests, streamTakesWholeBlocksWithoutCopying) {
+    std::string content = writeRandomFile(FileReader::DEFAULT_BLOCK_SIZE);
+    FileReaderStream stream{PATH, GetParam()};
+    ASSERT_EQ(stream.get(), content[0]);
+    auto taken = stream.take(100);
+    ASSERT_TRUE(taken.has_value());
+    ASSERT_EQ(*taken, content.substr(1, 100));
+    ASSERT_EQ(stream.tellg(), 101);
+    ASSERT_FALSE(stream.take(content.size()).has_value());
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, FileReaderTests,
+                         Values(FileIOEngine::mmap, FileIOEngine::io_uring, FileIOEngine::pread));
+
+TEST(FileReaderEngineTests, usesRequestedEngine) {
+    FileReader reader{"/proc/self/exe", FileReader::DEFAULT_BLOCK_SIZE, FileIOEngine::pread};
+    ASSERT_EQ(reader.engine(), FileIOEngine::pread);
+}
+
+TEST(FileReaderEngineTests, mappedBlocksStayValid) {
+    FileReader reader{"/proc/self/exe", 1000, FileIOEngine::mmap};
+    ASSERT_EQ(reader.engine(), FileIOEngine::mmap);
+    std::string_view first = reader.next();
+    std::string first_copy{first};
+    reader.next();
+    ASSERT_EQ(first, first_copy);
+    ASSERT_EQ(reader.mapped()->substr(0, first.size()), first_copy);
+}
+
+TEST(FileReaderEngineTests, streamsSpecialFilesInsteadOfMappingThem) {
+    FileReader reader{"/dev/zero", {0, 3000}, 1000, FileIOEngine::mmap};
+    ASSERT_NE(reader.engine(), FileIOEngine::mmap);
+    ASSERT_FALSE(reader.mapped().has_value());
+    ASSERT_EQ(reader.next(), std::string(1000, '\0'));
+}
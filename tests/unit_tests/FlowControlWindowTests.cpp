@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "client/FlowControlWindow.hpp"
+#include "Framing.hpp"
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(FlowControlWindowTests, initialCreditCoversFewFrames) {
+    FlowControlWindow window{DEFAULT_FRAME_SIZE};
+    ASSERT_EQ(window.initialCredit(FlowControlWindow::Clock::now()),
+              FlowControlWindow::INITIAL_WINDOW_FRAMES * DEFAULT_FRAME_SIZE);
+}
+
+TEST(FlowControlWindowTests, batchesCreditUntilHalfWindowIsConsumed) {
+    FlowControlWindow window{MIN_FRAME_SIZE};
+    auto now = FlowControlWindow::Clock::now();
+    std::size_t half_window = window.initialCredit(now) / 2;
+
+    ASSERT_EQ(window.onBytesConsumed(half_window - 1, now), 0);
+    ASSERT_EQ(window.onBytesConsumed(1, now), half_window);
+    ASSERT_EQ(window.onBytesConsumed(1, now), 0);
+}
+
+TEST(FlowControlWindowTests, doesNotGrowWhenLinkIsSlowerThanWindow) {
+    FlowControlWindow window{MIN_FRAME_SIZE};
+    auto now = FlowControlWindow::Clock::now();
+    std::size_t initial_window = window.initialCredit(now);
+    window.onRttSample(1ms);
+
+    for (int i = 0; i < 10; ++i) {
+        now += 10ms;
+        ASSERT_EQ(window.onBytesConsumed(initial_window / 2, now), initial_window / 2);
+    }
+    ASSERT_EQ(window.windowSize(), initial_window);
+}
+
+TEST(FlowControlWindowTests, growsUntilItCoversBandwidthDelayProduct) {
+    FlowControlWindow window{DEFAULT_FRAME_SIZE};
+    auto now = FlowControlWindow::Clock::now();
+    std::size_t initial_window = window.initialCredit(now);
+    window.onRttSample(10ms);
+
+    std::size_t credit = window.onBytesConsumed(initial_window / 2, now + 1ms);
+    ASSERT_EQ(window.windowSize(), 2 * initial_window);
+    ASSERT_EQ(credit, initial_window / 2 + initial_window);
+
+    for (int i = 0; i < 20; ++i) {
+        now += 1ms;
+        window.onBytesConsumed(window.windowSize() / 2, now);
+    }
+    ASSERT_EQ(window.windowSize(), FlowControlWindow::MAX_WINDOW_SIZE);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "Framing.hpp"
+
+#include <cstring>
+#include <limits>
+
+
+using namespace ::testing;
+
+std::string toBytes(const FrameHeaderBuffer &buffer, std::size_t size) {
+    return {reinterpret_cast<const char *>(buffer.data()), size};
+}
+
+TEST(FramingTests, smallFrameHeaderTakesTwoBytes) {
+    FrameHeaderBuffer buffer{};
+    ASSERT_EQ(encodeFrameHeader(FrameType::ack, 0, buffer), 2);
+    ASSERT_EQ(encodeFrameHeader(FrameType::data, 127, buffer), 2);
+    ASSERT_EQ(encodeFrameHeader(FrameType::data, 128, buffer), 3);
+}
+
+TEST(FramingTests, encodedHeaderCanBeDecoded) {
+    for (std::uint64_t payload_size: {0ul, 1ul, 300ul, 1024ul * 1024ul, std::numeric_limits<std::uint64_t>::max()}) {
+        FrameHeaderBuffer buffer{};
+        std::size_t header_size = encodeFrameHeader(FrameType::metadata, payload_size, buffer);
+        std::string bytes = toBytes(buffer, header_size);
+
+        auto header = decodeFrameHeader(bytes);
+        ASSERT_TRUE(header.has_value());
+        ASSERT_EQ(header->type, FrameType::metadata);
+        ASSERT_EQ(header->payload_size, payload_size);
+        ASSERT_EQ(header->header_size, header_size);
+    }
+}
+
+TEST(FramingTests, returnsNulloptOnIncompleteHeader) {
+    FrameHeaderBuffer buffer{};
+    std::size_t header_size = encodeFrameHeader(FrameType::data, 1024 * 1024, buffer);
+    std::string bytes = toBytes(buffer, header_size);
+
+    ASSERT_FALSE(decodeFrameHeader(std::string_view{}).has_value());
+    for (std::size_t size = 1; size < header_size; ++size) {
+        ASSERT_FALSE(decodeFrameHeader(std::string_view{bytes}.substr(0, size)).has_value());
+    }
+}
+
+TEST(FramingTests, decodesOnlyHeaderWhenFollowedByPayload) {
+    FrameHeaderBuffer buffer{};
+    std::size_t header_size = encodeFrameHeader(FrameType::error, 5, buffer);
+    std::string bytes = toBytes(buffer, header_size) + "oops!";
+
+    auto header = decodeFrameHeader(bytes);
+    ASSERT_TRUE(header.has_value());
+    ASSERT_EQ(header->type, FrameType::error);
+    ASSERT_EQ(bytes.substr(header->header_size, header->payload_size), "oops!");
+}
+
+TEST(FramingTests, throwsOnUnknownFrameType) {
+    std::string bytes{"\x42\x01", 2};
+    ASSERT_THROW(decodeFrameHeader(bytes), FramingException);
+}
+
+TEST(FramingTests, throwsOnTooLongVarint) {
+    std::string bytes(1 + MAX_VARINT_SIZE + 1, '\xff');
+    bytes[0] = static_cast<char>(FrameType::data);
+    ASSERT_THROW(decodeFrameHeader(bytes), FramingException);
+}
+
+TEST(FramingTests, chunkHashesRoundTrip) {
+    std::string digests(64, 'x');
+    std::string payload = encodeChunkHashes(300, digests);
+    ChunkHashes hashes = decodeChunkHashes(payload);
+    ASSERT_EQ(hashes.first_chunk, 300);
+    ASSERT_EQ(hashes.digests, digests);
+    ASSERT_THROW(decodeChunkHashes("\x80"), FramingException);
+}
+
+TEST(FramingTests, helloRoundTrip) {
+    HelloBuffer buffer = encodeHello(Hello{.max_frame_size = 256 * 1024});
+    ASSERT_TRUE(isHello(buffer));
+    Hello hello = decodeHello(buffer);
+    ASSERT_EQ(hello.version, Hello::PROTOCOL_VERSION);
+    ASSERT_EQ(hello.max_frame_size, 256 * 1024);
+}
+
+TEST(FramingTests, helloRoundsFrameSizeDownToPowerOfTwo) {
+    ASSERT_EQ(decodeHello(encodeHello(Hello{.max_frame_size = 300 * 1024})).max_frame_size, 256 * 1024);
+    ASSERT_EQ(decodeHello(encodeHello(Hello{.max_frame_size = 1})).max_frame_size, MIN_FRAME_SIZE);
+    ASSERT_EQ(decodeHello(encodeHello(Hello{.max_frame_size = MAX_FRAME_SIZE * 4})).max_frame_size, MAX_FRAME_SIZE);
+}
+
+TEST(FramingTests, throwsOnHelloWithUnsupportedFrameSize) {
+    HelloBuffer buffer = encodeHello(Hello{});
+    buffer[Hello::MAGIC.size() + 1] = 40; // 1 TiB
+    ASSERT_THROW(decodeHello(buffer), FramingException);
+}
+
+TEST(FramingTests, legacyHeaderIsNotTakenForHello) {
+    std::size_t legacy_header{250};
+    HelloBuffer buffer{};
+    std::memcpy(buffer.data(), &legacy_header, sizeof(legacy_header));
+    ASSERT_FALSE(isHello(buffer));
+    ASSERT_THROW(decodeHello(buffer), FramingException);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "Hasher.hpp"
+#include "Utils.hpp"
+
+
+using namespace ::testing;
+
+TEST(HasherTests, matchesKnownDigests) {
+    Hasher sha256{HashAlgorithm::sha256};
+    sha256.update("abc");
+    ASSERT_EQ(binaryToHumanReadable(sha256.finish()),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    Hasher blake2b{HashAlgorithm::blake2b};
+    blake2b.update("a");
+    blake2b.update("bc");
+    ASSERT_EQ(binaryToHumanReadable(blake2b.finish()).substr(0, 32), "ba80a53f981c4d0d6a2797b69f12f6e9");
+}
+
+TEST(HasherTests, startsNextHashAfterFinish) {
+    Hasher hasher{HashAlgorithm::blake2b};
+    hasher.update("abc");
+    std::string digest = hasher.finish();
+    hasher.update("abc");
+    ASSERT_EQ(hasher.finish(), digest);
+}
+
+TEST(HasherTests, parsesAlgorithmNames) {
+    for (auto algorithm: {HashAlgorithm::sha256, HashAlgorithm::blake2b}) {
+        ASSERT_EQ(parseHashAlgorithm(toString(algorithm)), algorithm);
+    }
+    ASSERT_FALSE(parseHashAlgorithm("md5").has_value());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "InitSessionMessage.hpp"
+#include "MerkleTree.hpp"
 #include "Utils.hpp"
 
 #include <fstream>
@@ -103,6 +104,89 @@ TEST_F(DropFileServerIntegrationTests, ignoredAdditionalKeys) {
     ASSERT_NO_THROW(InitSessionMessage::create(json.dump()));
 }
 
+TEST_F(DropFileServerIntegrationTests, throwsOnAutoAcceptKeyIncorrectType) {
+    nlohmann::json json{};
+    json[InitSessionMessage::ACTION_KEY] = "receive";
+    json[InitSessionMessage::CODE_WORDS_KEY] = "super-drop-file-program";
+    json[InitSessionMessage::AUTO_ACCEPT_KEY] = "yes";
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, receiveRequestIsNotAutoAcceptedByDefault) {
+    nlohmann::json json{};
+    json[InitSessionMessage::ACTION_KEY] = "receive";
+    json[InitSessionMessage::CODE_WORDS_KEY] = "super-drop-file-program";
+    ASSERT_FALSE(InitSessionMessage::isAutoAccepted(InitSessionMessage::create(json.dump())));
+    ASSERT_TRUE(InitSessionMessage::isAutoAccepted(InitSessionMessage::createReceiveMessage("code", true)));
+}
+
+TEST_F(DropFileServerIntegrationTests, resumePointRequiresFileId) {
+    nlohmann::json json = InitSessionMessage::createReceiveMessage("super-drop-file-program");
+    json[InitSessionMessage::RESUME_OFFSET_KEY] = 1024;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+
+    InitSessionMessage::setResumePoint(json, 1024, "some-id");
+    auto validated = InitSessionMessage::create(json.dump());
+    ASSERT_EQ(InitSessionMessage::resumeOffset(validated), 1024);
+    ASSERT_EQ(InitSessionMessage::fileId(validated), "some-id");
+}
+
+TEST_F(DropFileServerIntegrationTests, throwsOnResumeOffsetIncorrectType) {
+    nlohmann::json json = InitSessionMessage::createReceiveMessage("super-drop-file-program");
+    InitSessionMessage::setResumePoint(json, 0, "some-hash");
+    json[InitSessionMessage::RESUME_OFFSET_KEY] = -5;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, throwsOnResumeTokenIncorrectType) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, false);
+    ASSERT_FALSE(InitSessionMessage::resumeToken(json).has_value());
+    json[InitSessionMessage::RESUME_TOKEN_KEY] = 15;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+
+    InitSessionMessage::setResumeToken(json, "super-drop-file-program");
+    ASSERT_EQ(InitSessionMessage::resumeToken(InitSessionMessage::create(json.dump())), "super-drop-file-program");
+}
+
+TEST_F(DropFileServerIntegrationTests, acceptsCorrectStreamJoin) {
+    auto json = InitSessionMessage::createStreamJoinMessage("receive", "super-drop-file-program", 3, {100, 200});
+    auto validated = InitSessionMessage::create(json.dump());
+    ASSERT_TRUE(InitSessionMessage::isStreamJoin(validated));
+    ASSERT_EQ(InitSessionMessage::stripe(validated), (ByteRange{100, 200}));
+}
+
+TEST_F(DropFileServerIntegrationTests, streamJoinCarriesChunkSize) {
+    auto json = InitSessionMessage::createStreamJoinMessage("send", "super-drop-file-program", 1, {0, 100},
+                                                            MerkleTree::MIN_CHUNK_SIZE);
+    ASSERT_EQ(InitSessionMessage::chunkSize(InitSessionMessage::create(json.dump())), MerkleTree::MIN_CHUNK_SIZE);
+    json[InitSessionMessage::CHUNK_SIZE_KEY] = 1;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, throwsOnIncorrectStreamJoin) {
+    auto json = InitSessionMessage::createStreamJoinMessage("send", "super-drop-file-program", 0, {100, 200});
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json[InitSessionMessage::STREAM_INDEX_KEY] = MAX_STREAMS;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json[InitSessionMessage::STREAM_INDEX_KEY] = 1;
+    json[InitSessionMessage::STRIPE_BEGIN_KEY] = 300;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json.erase(InitSessionMessage::STRIPE_BEGIN_KEY);
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, throwsOnStreamsOutOfRange) {
+    std::ofstream{path} << "content";
+    ASSERT_EQ(InitSessionMessage::streamCount(InitSessionMessage::createSendMessage(path, false)), 1);
+    auto json = InitSessionMessage::createSendMessage(path, false, MAX_STREAMS);
+    ASSERT_EQ(InitSessionMessage::streamCount(InitSessionMessage::create(json.dump())), MAX_STREAMS);
+    json[InitSessionMessage::STREAMS_KEY] = 0;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json[InitSessionMessage::STREAMS_KEY] = MAX_STREAMS + 1;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
 TEST_F(DropFileServerIntegrationTests, createSendMessageThrowsWhenFileDoesNotExist) {
     ASSERT_THROW(InitSessionMessage::createSendMessage(path, false), InitSessionMessageException);
 }
@@ -114,13 +198,131 @@ TEST_F(DropFileServerIntegrationTests, createSendMessageReturnsCorrectJsonOnFile
     ASSERT_EQ(json[InitSessionMessage::ACTION_KEY], "send");
     ASSERT_EQ(json[InitSessionMessage::FILENAME_KEY], path.filename().string());
     ASSERT_EQ(json[InitSessionMessage::FILE_SIZE_KEY], 0);
-    ASSERT_EQ(json[InitSessionMessage::FILE_HASH_KEY], calculateFileHash(path));
+    ASSERT_FALSE(json.contains(InitSessionMessage::FILE_HASH_KEY));
+    ASSERT_FALSE(InitSessionMessage::fileId(json).empty());
+    ASSERT_EQ(InitSessionMessage::chunkSize(json), MerkleTree::DEFAULT_CHUNK_SIZE);
     ASSERT_EQ(json[InitSessionMessage::IS_COMPRESSED_KEY], is_zipped);
 }
 
+TEST_F(DropFileServerIntegrationTests, fileIdChangesWithFileAndFallsBackToLegacyHash) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, false);
+    ASSERT_EQ(InitSessionMessage::fileId(InitSessionMessage::createSendMessage(path, false)),
+              InitSessionMessage::fileId(json));
+    std::ofstream{path, std::ios::app} << "more content";
+    ASSERT_NE(InitSessionMessage::fileId(InitSessionMessage::createSendMessage(path, false)),
+              InitSessionMessage::fileId(json));
+
+    json.erase(InitSessionMessage::FILE_ID_KEY);
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json[InitSessionMessage::FILE_HASH_KEY] = "legacy-hash";
+    ASSERT_EQ(InitSessionMessage::fileId(InitSessionMessage::create(json.dump())), "legacy-hash");
+}
+
+TEST_F(DropFileServerIntegrationTests, throwsOnChunkSizeOutOfRange) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, false);
+    json[InitSessionMessage::CHUNK_SIZE_KEY] = MerkleTree::MIN_CHUNK_SIZE - 1;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json[InitSessionMessage::CHUNK_SIZE_KEY] = "1024";
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json.erase(InitSessionMessage::CHUNK_SIZE_KEY);
+    ASSERT_FALSE(InitSessionMessage::chunkSize(InitSessionMessage::create(json.dump())).has_value());
+}
+
+TEST_F(DropFileServerIntegrationTests, sendMessageNamesHashAlgorithm) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, false, 1, MerkleTree::DEFAULT_CHUNK_SIZE,
+                                                      HashAlgorithm::blake2b);
+    ASSERT_EQ(InitSessionMessage::hashAlgorithm(InitSessionMessage::create(json.dump())), HashAlgorithm::blake2b);
+    json[InitSessionMessage::HASH_ALGORITHM_KEY] = "md5";
+    ASSERT_FALSE(InitSessionMessage::hashAlgorithm(InitSessionMessage::create(json.dump())).has_value());
+    json[InitSessionMessage::HASH_ALGORITHM_KEY] = 5;
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+    json.erase(InitSessionMessage::HASH_ALGORITHM_KEY);
+    ASSERT_EQ(InitSessionMessage::hashAlgorithm(InitSessionMessage::create(json.dump())), HashAlgorithm::sha256);
+}
+
+TEST_F(DropFileServerIntegrationTests, bundleEntriesMustBePlainNames) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, true);
+    ASSERT_TRUE(InitSessionMessage::bundleEntries(json).empty());
+    InitSessionMessage::setBundleEntries(json, {"a", "b.txt"});
+    ASSERT_EQ(InitSessionMessage::bundleEntries(InitSessionMessage::create(json.dump())),
+              (std::vector<std::string>{"a", "b.txt"}));
+    for (const auto &entry: {"../a", "/etc", "a/b", "..", ""}) {
+        InitSessionMessage::setBundleEntries(json, {"a", entry});
+        ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException) << entry;
+    }
+    json[InitSessionMessage::ENTRIES_KEY] = nlohmann::json::array();
+    ASSERT_THROW(InitSessionMessage::create(json.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, directOfferIsRelayedOnlyWhenValid) {
+    std::ofstream{path} << "content";
+    auto json = InitSessionMessage::createSendMessage(path, false);
+    ASSERT_FALSE(InitSessionMessage::directOffer(json).has_value());
+    DirectOffer offer{.addresses = {"192.168.1.5", "127.0.0.1"}, .port = 40000, .session_key = "key",
+                      .certificate_fingerprint = "fingerprint"};
+    InitSessionMessage::setDirectOffer(json, offer);
+    ASSERT_EQ(InitSessionMessage::directOffer(InitSessionMessage::create(json.dump())), offer);
+
+    auto invalid = json;
+    invalid[InitSessionMessage::DIRECT_KEY][InitSessionMessage::DIRECT_PORT_KEY] = 70000;
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    invalid[InitSessionMessage::DIRECT_KEY][InitSessionMessage::DIRECT_ADDRESSES_KEY] =
+            std::vector<std::string>(InitSessionMessage::MAX_DIRECT_ADDRESSES + 1, "127.0.0.1");
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    invalid[InitSessionMessage::DIRECT_KEY].erase(InitSessionMessage::DIRECT_SESSION_KEY);
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    invalid[InitSessionMessage::STREAMS_KEY] = 2;
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, pipeHasNoSizeNorChunks) {
+    std::ofstream{path} << "content";
+    ASSERT_FALSE(InitSessionMessage::isPipe(InitSessionMessage::createSendMessage(path, false)));
+    auto json = InitSessionMessage::create(InitSessionMessage::createPipeSendMessage("stdin").dump());
+    ASSERT_TRUE(InitSessionMessage::isPipe(json));
+    ASSERT_EQ(json[InitSessionMessage::FILE_SIZE_KEY], 0);
+    ASSERT_EQ(InitSessionMessage::streamCount(json), 1);
+    ASSERT_FALSE(InitSessionMessage::chunkSize(json).has_value());
+
+    auto invalid = json;
+    invalid[InitSessionMessage::STREAMS_KEY] = 2;
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    invalid[InitSessionMessage::CHUNK_SIZE_KEY] = MerkleTree::MIN_CHUNK_SIZE;
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    InitSessionMessage::setResumeToken(invalid, "code");
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+    invalid = json;
+    invalid[InitSessionMessage::PIPE_KEY] = "yes";
+    ASSERT_THROW(InitSessionMessage::create(invalid.dump()), InitSessionMessageException);
+}
+
+TEST_F(DropFileServerIntegrationTests, stripesOfSendMessageAreAlignedToChunks) {
+    nlohmann::json json{{InitSessionMessage::FILE_SIZE_KEY, 5 * MerkleTree::MIN_CHUNK_SIZE},
+                        {InitSessionMessage::STREAMS_KEY, 2},
+                        {InitSessionMessage::CHUNK_SIZE_KEY, MerkleTree::MIN_CHUNK_SIZE}};
+    ASSERT_EQ(InitSessionMessage::stripeOf(json, 0), (ByteRange{0, 3 * MerkleTree::MIN_CHUNK_SIZE}));
+    ASSERT_EQ(InitSessionMessage::extraStreams(json), (std::vector<std::size_t>{1}));
+    json[InitSessionMessage::STREAMS_KEY] = 8;
+    ASSERT_EQ(InitSessionMessage::extraStreams(json), (std::vector<std::size_t>{1, 2, 3, 4}));
+    json[InitSessionMessage::STREAMS_KEY] = 2;
+    json.erase(InitSessionMessage::CHUNK_SIZE_KEY);
+    ASSERT_EQ(InitSessionMessage::stripeOf(json, 0), (ByteRange{0, 5 * MerkleTree::MIN_CHUNK_SIZE / 2}));
+}
+
 TEST_F(DropFileServerIntegrationTests, createReceiveMessageReturnsCorrectJsonOnDirectory) {
     std::string code_words{"some-code-words123"};
     auto json = InitSessionMessage::createReceiveMessage(code_words);
     ASSERT_EQ(json[InitSessionMessage::ACTION_KEY], "receive");
     ASSERT_EQ(json[InitSessionMessage::CODE_WORDS_KEY], code_words);
+    ASSERT_TRUE(InitSessionMessage::verifiesChunks(json));
+    ASSERT_TRUE(InitSessionMessage::acceptsPipe(json));
 }
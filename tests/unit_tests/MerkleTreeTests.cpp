@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "MerkleTree.hpp"
+
+
+using namespace ::testing;
+
+struct MerkleTreeTests : public Test {
+    const std::filesystem::path PATH{std::filesystem::temp_directory_path() / "test_merkle_tree_file"};
+    const std::size_t CHUNK_SIZE{MerkleTree::MIN_CHUNK_SIZE};
+
+    void TearDown() override {
+        std::filesystem::remove(PATH);
+    }
+
+    std::string writeRandomFile(std::size_t size) const {
+        std::string content = generateRandomString(size);
+        std::ofstream{PATH, std::ios::binary} << content;
+        return content;
+    }
+};
+
+TEST_F(MerkleTreeTests, hasOneLeafPerChunk) {
+    std::string content = writeRandomFile(3 * CHUNK_SIZE + 1);
+    auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE);
+    ASSERT_EQ(tree.leaves().size(), 4);
+    ASSERT_EQ(tree.leaves()[1], MerkleTree::hashLeaf(std::string_view{content}.substr(CHUNK_SIZE, CHUNK_SIZE)));
+    ASSERT_EQ(tree.leaves()[3], MerkleTree::hashLeaf(std::string_view{content}.substr(3 * CHUNK_SIZE)));
+    ASSERT_EQ(MerkleTree::chunkCount(3 * CHUNK_SIZE + 1, CHUNK_SIZE), 4);
+    ASSERT_EQ(MerkleTree::chunkCount(3 * CHUNK_SIZE, CHUNK_SIZE), 3);
+}
+
+TEST_F(MerkleTreeTests, rootDependsOnEveryChunk) {
+    std::string content = writeRandomFile(5 * CHUNK_SIZE);
+    std::string root = MerkleTree::fromFile(PATH, CHUNK_SIZE).root();
+    ASSERT_EQ(root.size(), 2 * MerkleTree::DIGEST_SIZE);
+    ASSERT_EQ(MerkleTree::fromFile(PATH, CHUNK_SIZE).root(), root);
+
+    content[4 * CHUNK_SIZE] = static_cast<char>(content[4 * CHUNK_SIZE] + 1);
+    std::ofstream{PATH, std::ios::binary} << content;
+    ASSERT_NE(MerkleTree::fromFile(PATH, CHUNK_SIZE).root(), root);
+}
+
+TEST_F(MerkleTreeTests, emptyFileHasSingleLeaf) {
+    std::ofstream{PATH};
+    auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE);
+    ASSERT_EQ(tree.leaves().size(), 1);
+    ASSERT_EQ(tree.leaves()[0], MerkleTree::hashLeaf({}));
+}
+
+TEST_F(MerkleTreeTests, leafHasherMatchesWholeChunkHash) {
+    std::string chunk = generateRandomString(CHUNK_SIZE);
+    LeafHasher hasher;
+    hasher.update(std::string_view{chunk}.substr(0, 100));
+    hasher.update(std::string_view{chunk}.substr(100));
+    ASSERT_EQ(hasher.finish(), MerkleTree::hashLeaf(chunk));
+    ASSERT_EQ(hasher.finish(), MerkleTree::hashLeaf({}));
+}
+
+TEST_F(MerkleTreeTests, treeIsBuiltWithGivenAlgorithm) {
+    std::string content = writeRandomFile(3 * CHUNK_SIZE + 1);
+    auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE, HashAlgorithm::blake2b);
+    ASSERT_NE(tree.root(), MerkleTree::fromFile(PATH, CHUNK_SIZE, HashAlgorithm::sha256).root());
+    ASSERT_EQ(tree.leaves()[0], MerkleTree::hashLeaf(std::string_view{content}.substr(0, CHUNK_SIZE),
+                                                     HashAlgorithm::blake2b));
+    ASSERT_EQ(tree.leaves()[0].size(), MerkleTree::DIGEST_SIZE);
+    ASSERT_EQ(MerkleTree(CHUNK_SIZE, tree.leaves(), HashAlgorithm::blake2b).root(), tree.root());
+
+    LeafHasher hasher{HashAlgorithm::blake2b};
+    hasher.updateFromFile(PATH, {3 * CHUNK_SIZE, content.size()}, 1);
+    ASSERT_EQ(hasher.finish(), tree.leaves()[3]);
+}
+
+TEST_F(MerkleTreeTests, treeDoesNotDependOnThreadCount) {
+    writeRandomFile(37 * CHUNK_SIZE + 5);
+    auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE, HashAlgorithm::blake2b, 1);
+    for (std::size_t threads: {2, 7, 64}) {
+        auto parallel_tree = MerkleTree::fromFile(PATH, CHUNK_SIZE, HashAlgorithm::blake2b, threads);
+        ASSERT_EQ(parallel_tree.leaves(), tree.leaves());
+        ASSERT_EQ(parallel_tree.root(), tree.root());
+    }
+}
+
+TEST_F(MerkleTreeTests, hashesChosenChunksInGivenOrder) {
+    std::string content = writeRandomFile(5 * CHUNK_SIZE + 5);
+    auto leaves = MerkleTree::hashChunks(PATH, CHUNK_SIZE, {5, 0, 3}, HashAlgorithm::sha256, 3);
+    ASSERT_EQ(leaves.size(), 3);
+    ASSERT_EQ(leaves[0], MerkleTree::hashLeaf(std::string_view{content}.substr(5 * CHUNK_SIZE)));
+    ASSERT_EQ(leaves[1], MerkleTree::hashLeaf(std::string_view{content}.substr(0, CHUNK_SIZE)));
+    ASSERT_EQ(leaves[2], MerkleTree::hashLeaf(std::string_view{content}.substr(3 * CHUNK_SIZE, CHUNK_SIZE)));
+    ASSERT_THROW(MerkleTree::hashChunks(PATH.string() + "_missing", CHUNK_SIZE, {0}), MerkleTreeException);
+}
+
+TEST_F(MerkleTreeTests, rangeHasherHashesFirstChunkFromFile) {
+    std::string content = writeRandomFile(3 * CHUNK_SIZE + 10);
+    auto tree = MerkleTree::fromFile(PATH, CHUNK_SIZE);
+    std::size_t offset{CHUNK_SIZE + 100};
+    RangeHasher hasher{PATH, content.size(), CHUNK_SIZE, {offset, content.size()}};
+    std::vector<std::size_t> indexes;
+    hasher.update(std::string_view{content}.substr(offset), [&](std::size_t chunk_index, MerkleTree::Digest leaf) {
+        ASSERT_EQ(leaf, tree.leaves()[chunk_index]);
+        indexes.push_back(chunk_index);
+    });
+    ASSERT_EQ(indexes, (std::vector<std::size_t>{1, 2, 3}));
+    ASSERT_THROW(hasher.update("x", [](std::size_t, MerkleTree::Digest) {}), MerkleTreeException);
+}
+
+TEST_F(MerkleTreeTests, findsChunksOfRange) {
+    ChunkSpan chunks = MerkleTree::chunksOf({CHUNK_SIZE + 1, 3 * CHUNK_SIZE}, CHUNK_SIZE);
+    ASSERT_EQ(chunks.first, 1);
+    ASSERT_EQ(chunks.end, 3);
+    ASSERT_EQ(MerkleTree::chunksOf({CHUNK_SIZE, CHUNK_SIZE}, CHUNK_SIZE).size(), 0);
+    ASSERT_EQ(MerkleTree::leavesOf({0, 0}, 0, CHUNK_SIZE).size(), 1);
+}
+
+TEST_F(MerkleTreeTests, throwsOnInvalidInput) {
+    ASSERT_THROW(MerkleTree::fromFile(PATH, CHUNK_SIZE), MerkleTreeException);
+    ASSERT_THROW(MerkleTree(CHUNK_SIZE, {}), MerkleTreeException);
+    ASSERT_THROW(MerkleTree(MerkleTree::MAX_CHUNK_SIZE + 1, {MerkleTree::hashLeaf({})}), MerkleTreeException);
+}
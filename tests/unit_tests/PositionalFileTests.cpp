@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "client/PositionalFile.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+
+using namespace ::testing;
+
+struct PositionalFileTests : public Test {
+    const std::filesystem::path PATH{std::filesystem::temp_directory_path() / "test_positional_file"};
+
+    void TearDown() override {
+        std::filesystem::remove(PATH);
+    }
+};
+
+TEST_F(PositionalFileTests, writesRangesInAnyOrder) {
+    {
+        PositionalFile file{PATH, 0};
+        file.write(6, "world");
+        file.write(0, "hello ");
+    }
+    ASSERT_EQ(getFileContent(PATH), "hello world");
+}
+
+TEST_F(PositionalFileTests, keepsOnlyRequestedPrefixOfExistingFile) {
+    std::ofstream{PATH} << "hello world";
+    {
+        PositionalFile file{PATH, 5};
+        file.write(5, "!");
+    }
+    ASSERT_EQ(getFileContent(PATH), "hello!");
+}
+
+TEST_F(PositionalFileTests, throwsWhenFileCannotBeOpened) {
+    ASSERT_THROW((PositionalFile{PATH / "no_such_dir" / "file", 0}), PositionalFileException);
+}
+
+TEST_F(PositionalFileTests, preallocatingKeepsSizeOfFile) {
+    {
+        PositionalFile file{PATH, 0};
+        file.preallocate(1024 * 1024);
+        file.write(0, "hello");
+    }
+    ASSERT_EQ(getFileContent(PATH), "hello");
+}
+
+TEST_F(PositionalFileTests, writesAlignedAndUnalignedDataWithDirectIo) {
+    std::string aligned_data(2 * PositionalFile::DIRECT_IO_ALIGNMENT, 'a');
+    std::unique_ptr<char, decltype(&std::free)> aligned{
+            static_cast<char *>(std::aligned_alloc(PositionalFile::DIRECT_IO_ALIGNMENT, aligned_data.size())),
+            &std::free};
+    std::memcpy(aligned.get(), aligned_data.data(), aligned_data.size());
+    {
+        PositionalFile file{PATH, 0, true};
+        file.write(0, {aligned.get(), aligned_data.size()});
+        file.write(aligned_data.size(), "tail");
+        file.write(1, "b");
+    }
+    aligned_data[1] = 'b';
+    ASSERT_EQ(getFileContent(PATH), aligned_data + "tail");
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "client/ProgressMeter.hpp"
+
+#include <future>
+#include <vector>
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(ProgressMeterTests, countsWhatWasDoneBefore) {
+    ProgressMeter progress{"test", 100, 40, true};
+    progress.add(10);
+    ASSERT_EQ(progress.value(), 50);
+}
+
+TEST(ProgressMeterTests, countsFromManyThreads) {
+    ProgressMeter progress{"test", 0, 0, true};
+    std::vector<std::future<void>> adders;
+    for (int i = 0; i < 4; ++i) {
+        adders.push_back(std::async(std::launch::async, [&] {
+            for (int j = 0; j < 10000; ++j) {
+                progress.add(1);
+            }
+        }));
+    }
+    for (auto &adder: adders) {
+        adder.get();
+    }
+    ASSERT_EQ(progress.value(), 40000);
+}
+
+TEST(ProgressMeterTests, finishesWhileRendering) {
+    ProgressMeter progress{"test", 1000};
+    progress.add(500);
+    std::this_thread::sleep_for(ProgressMeter::REFRESH_INTERVAL * 2);
+    progress.add(500);
+    progress.finish("done");
+    progress.finish("again");
+    ASSERT_EQ(progress.value(), 1000);
+}
+
+TEST(ProgressMeterTests, stopsRenderingWhenNotFinished) {
+    auto start = std::chrono::steady_clock::now();
+    {
+        ProgressMeter progress{"test", 0};
+        progress.add(1);
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+TEST(ProgressMeterTests, showsThroughputInBinaryUnits) {
+    ASSERT_EQ(ProgressMeter::throughputToHumanReadable(0), "0 B/s");
+    ASSERT_EQ(ProgressMeter::throughputToHumanReadable(512), "512 B/s");
+    ASSERT_EQ(ProgressMeter::throughputToHumanReadable(1536), "1.5 kiB/s");
+    ASSERT_EQ(ProgressMeter::throughputToHumanReadable(10.0 * 1024 * 1024), "10.0 MiB/s");
+    ASSERT_EQ(ProgressMeter::throughputToHumanReadable(3.0 * 1024 * 1024 * 1024), "3.0 GiB/s");
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "TestHelpers.hpp"
+#include "client/RangeWriter.hpp"
+
+
+using namespace ::testing;
+
+struct RangeWriterTests : public Test {
+    const std::filesystem::path PATH{std::filesystem::temp_directory_path() / "test_range_writer"};
+    static constexpr std::size_t BLOCK{RangeWriter::WRITE_SIZE};
+
+    void TearDown() override {
+        std::filesystem::remove(PATH);
+    }
+};
+
+TEST_F(RangeWriterTests, writesOnlyWholeBlocksUntilFlushed) {
+    std::string first(BLOCK - 10, 'a');
+    std::string second(20, 'b');
+    PositionalFile file{PATH, 0};
+    RangeWriter writer{file, false};
+
+    ASSERT_EQ(writer.write(0, first), 0);
+    ASSERT_EQ(writer.write(first.size(), second), BLOCK);
+    ASSERT_EQ(writer.flush(), 10);
+    ASSERT_EQ(writer.flush(), 0);
+    ASSERT_EQ(getFileContent(PATH), first + second);
+}
+
+TEST_F(RangeWriterTests, alignsBlocksToOffsetInFile) {
+    std::string data(BLOCK, 'a');
+    PositionalFile file{PATH, 0};
+    RangeWriter writer{file, false};
+
+    ASSERT_EQ(writer.write(BLOCK / 2, data), BLOCK / 2);
+    ASSERT_EQ(writer.flush(), BLOCK / 2);
+}
+
+TEST_F(RangeWriterTests, flushesBeforeWritingElsewhere) {
+    PositionalFile file{PATH, 0};
+    RangeWriter writer{file, false};
+
+    ASSERT_EQ(writer.write(6, "world"), 0);
+    ASSERT_EQ(writer.write(0, "hello "), 5);
+    ASSERT_EQ(writer.flush(), 6);
+    ASSERT_EQ(getFileContent(PATH), "hello world");
+}
+
+TEST_F(RangeWriterTests, writesSameContentWhenLimitingPageCache) {
+    std::string content = generateRandomString((RangeWriter::CACHE_WINDOW + 2) * BLOCK + 123);
+    {
+        PositionalFile file{PATH, 0, true};
+        RangeWriter writer{file, true};
+        std::size_t written{0};
+        for (std::size_t offset = 0; offset < content.size(); offset += 100'000) {
+            written += writer.write(offset, std::string_view{content}.substr(offset, 100'000));
+        }
+        written += writer.flush();
+        ASSERT_EQ(written, content.size());
+    }
+    ASSERT_EQ(getFileContent(PATH), content);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "RateLimiter.hpp"
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(RateLimiterTests, throwsOnZeroRate) {
+    ASSERT_THROW(RateLimiter{0}, RateLimiterException);
+}
+
+TEST(RateLimiterTests, burstIsWorthFewMillisecondsOfRate) {
+    ASSERT_EQ(RateLimiter{1024}.burstSize(), RateLimiter::MIN_BURST_SIZE);
+    ASSERT_EQ(RateLimiter{100 * 1000 * 1000}.burstSize(), 1000 * 1000);
+}
+
+TEST(RateLimiterTests, letsBurstGoRightAway) {
+    auto start = RateLimiter::Clock::now();
+    RateLimiter limiter{1024 * 1024, start};
+    ASSERT_EQ(limiter.reserve(limiter.burstSize(), start), RateLimiter::Clock::duration::zero());
+}
+
+TEST(RateLimiterTests, pacesDataBeyondBurstToTheRate) {
+    auto start = RateLimiter::Clock::now();
+    RateLimiter limiter{1024 * 1024, start};
+    limiter.reserve(limiter.burstSize(), start);
+    ASSERT_EQ(limiter.reserve(512 * 1024, start), 500ms);
+    ASSERT_EQ(limiter.reserve(512 * 1024, start), 1000ms); // debt adds up
+}
+
+TEST(RateLimiterTests, refillsWithTimeUpToBurst) {
+    auto start = RateLimiter::Clock::now();
+    RateLimiter limiter{1024 * 1024, start};
+    limiter.reserve(limiter.burstSize() + 1024 * 1024, start);
+    ASSERT_EQ(limiter.reserve(0, start + 1s), RateLimiter::Clock::duration::zero());
+    ASSERT_EQ(limiter.reserve(limiter.burstSize(), start + 1h), RateLimiter::Clock::duration::zero());
+    ASSERT_GT(limiter.reserve(1, start + 1h), RateLimiter::Clock::duration::zero());
+}
+
+TEST(RateLimiterTests, acquireWaitsForTheRate) {
+    RateLimiter limiter{1024 * 1024};
+    auto start = RateLimiter::Clock::now();
+    limiter.acquire(limiter.burstSize() + 100 * 1024);
+    ASSERT_GE(RateLimiter::Clock::now() - start, 90ms);
+}
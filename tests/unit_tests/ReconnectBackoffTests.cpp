@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "client/ReconnectPolicy.hpp"
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(ReconnectBackoffTests, defaultPolicyDoesNotReconnect) {
+    ReconnectBackoff backoff{ReconnectPolicy{}};
+    ASSERT_FALSE(backoff.nextDelay().has_value());
+    ASSERT_FALSE(backoff.waitForNextAttempt("connection lost"));
+}
+
+TEST(ReconnectBackoffTests, doublesDelayUpToMaxWithJitter) {
+    ReconnectBackoff backoff{ReconnectPolicy{.max_attempts = 5, .initial_delay = 100ms, .max_delay = 300ms}};
+    for (auto expected_delay: {100ms, 200ms, 300ms, 300ms, 300ms}) {
+        auto delay = backoff.nextDelay();
+        ASSERT_TRUE(delay.has_value());
+        ASSERT_GE(*delay, expected_delay);
+        ASSERT_LE(*delay, expected_delay * (1 + ReconnectBackoff::JITTER_FRACTION));
+    }
+    ASSERT_FALSE(backoff.nextDelay().has_value());
+}
+
+TEST(ReconnectBackoffTests, resetGivesAllAttemptsBack) {
+    ReconnectBackoff backoff{ReconnectPolicy{.max_attempts = 1, .initial_delay = 100ms}};
+    ASSERT_TRUE(backoff.nextDelay().has_value());
+    ASSERT_FALSE(backoff.nextDelay().has_value());
+
+    backoff.reset();
+    auto delay = backoff.nextDelay();
+    ASSERT_TRUE(delay.has_value());
+    ASSERT_LE(*delay, 125ms);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "client/ResumeCheckpoint.hpp"
+
+#include <fstream>
+
+
+using namespace ::testing;
+
+struct ResumeCheckpointTests : public Test {
+    const std::filesystem::path CHECKPOINT_PATH{std::filesystem::temp_directory_path() / "test_checkpoint.json"};
+    const std::filesystem::path PARTIAL_PATH{std::filesystem::temp_directory_path() / "test_checkpoint_partial"};
+
+    void SetUp() override {
+        std::ofstream{PARTIAL_PATH, std::ios::trunc} << "0123456789";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(CHECKPOINT_PATH);
+        std::filesystem::remove(PARTIAL_PATH);
+    }
+};
+
+TEST_F(ResumeCheckpointTests, canBeSavedAndLoaded) {
+    ResumeCheckpoint{.file_id = "id", .partial_path = PARTIAL_PATH, .offset = 7}.save(CHECKPOINT_PATH);
+
+    auto checkpoint = ResumeCheckpoint::load(CHECKPOINT_PATH);
+    ASSERT_TRUE(checkpoint.has_value());
+    ASSERT_EQ(checkpoint->file_id, "id");
+    ASSERT_EQ(checkpoint->partial_path, PARTIAL_PATH);
+    ASSERT_EQ(checkpoint->offset, 7);
+}
+
+TEST_F(ResumeCheckpointTests, offsetDoesNotExceedPartialFileSize) {
+    ResumeCheckpoint{.file_id = "id", .partial_path = PARTIAL_PATH, .offset = 1000}.save(CHECKPOINT_PATH);
+    ASSERT_EQ(ResumeCheckpoint::load(CHECKPOINT_PATH)->offset, 10);
+}
+
+TEST_F(ResumeCheckpointTests, isNotLoadedWithoutPartialFile) {
+    ResumeCheckpoint{.file_id = "id", .partial_path = PARTIAL_PATH, .offset = 7}.save(CHECKPOINT_PATH);
+    std::filesystem::remove(PARTIAL_PATH);
+    ASSERT_FALSE(ResumeCheckpoint::load(CHECKPOINT_PATH).has_value());
+}
+
+TEST_F(ResumeCheckpointTests, isNotLoadedWhenMissingOrCorrupted) {
+    ASSERT_FALSE(ResumeCheckpoint::load(CHECKPOINT_PATH).has_value());
+    std::ofstream{CHECKPOINT_PATH} << R"({"file_id": "id", "offset": 7})";
+    ASSERT_FALSE(ResumeCheckpoint::load(CHECKPOINT_PATH).has_value());
+}
@@ -22,6 +22,13 @@ TEST(ServerArgParserTests, noThrowWhenOnlyDirectoryIsSuppliedAndDefultValuesAreC
     ASSERT_EQ(server_args.certs_directory, some_dir);
     ASSERT_EQ(server_args.port, ServerArgs::DEFAULT_PORT);
     ASSERT_EQ(server_args.client_timeout, ServerArgs::DEFAULT_CLIENT_TIMEOUT);
+    ASSERT_EQ(server_args.deadlines.handshake, SessionDeadlines::DEFAULT_HANDSHAKE_TIMEOUT);
+    ASSERT_EQ(server_args.deadlines.first_message, SessionDeadlines::DEFAULT_FIRST_MESSAGE_TIMEOUT);
+    ASSERT_EQ(server_args.deadlines.receiver_confirmation, SessionDeadlines::DEFAULT_RECEIVER_CONFIRMATION_TIMEOUT);
+    ASSERT_EQ(server_args.deadlines.chunk_idle, SessionDeadlines::DEFAULT_CHUNK_IDLE_TIMEOUT);
+    ASSERT_EQ(server_args.deadlines.total_transfer, SessionDeadlines::DEFAULT_TOTAL_TRANSFER_TIMEOUT);
+    ASSERT_FALSE(server_args.plaintext);
+    ASSERT_EQ(server_args.max_frame_size, DEFAULT_FRAME_SIZE);
 }
 
 TEST(ServerArgParserTests, setsAllCustomValues) {
@@ -51,6 +58,53 @@ TEST(ServerArgParserTests, setsCorrectTimeoutValue) {
     ASSERT_EQ(server_args.client_timeout, 123s);
 }
 
+TEST(ServerArgParserTests, setsCorrectDeadlineValues) {
+    int argc{12};
+    char * argv[] = {"program_name", "/some/directory", "--handshake_timeout", "1", "--first_message_timeout", "2",
+                     "--confirmation_timeout", "3", "--idle_timeout", "4", "--transfer_timeout", "5"};
+    ServerArgs server_args;
+    ASSERT_NO_THROW(server_args = parseServerArgs(argc, argv));
+    ASSERT_EQ(server_args.deadlines.handshake, 1s);
+    ASSERT_EQ(server_args.deadlines.first_message, 2s);
+    ASSERT_EQ(server_args.deadlines.receiver_confirmation, 3s);
+    ASSERT_EQ(server_args.deadlines.chunk_idle, 4s);
+    ASSERT_EQ(server_args.deadlines.total_transfer, 5s);
+}
+
+TEST(ServerArgParserTests, setsPlaintextFlag) {
+    int argc{3};
+    char * argv[] = {"program_name", "/some/directory", "--plaintext"};
+    ServerArgs server_args;
+    ASSERT_NO_THROW(server_args = parseServerArgs(argc, argv));
+    ASSERT_TRUE(server_args.plaintext);
+}
+
+TEST(ServerArgParserTests, setsMaxFrameSizeRoundedToPowerOfTwo) {
+    int argc{4};
+    char * argv[] = {"program_name", "/some/directory", "--max_frame_size", "5000"};
+    ServerArgs server_args;
+    ASSERT_NO_THROW(server_args = parseServerArgs(argc, argv));
+    ASSERT_EQ(server_args.max_frame_size, 4 * 1024 * 1024);
+}
+
+TEST(ServerArgParserTests, throwsOnNegativeDeadline) {
+    int argc{4};
+    char * argv[] = {"program_name", "/some/directory", "--idle_timeout","-5"};
+    ASSERT_THROW(parseServerArgs(argc, argv), std::exception);
+}
+
+
+TEST(ServerArgParserTests, parsesCongestionControl) {
+    int argc{4};
+    char * argv[] = {"program_name", "/some/directory", "--congestion_control", "bbr"};
+    ASSERT_EQ(parseServerArgs(argc, argv).tuning_profile.congestion_control, "bbr");
+}
+
+TEST(ServerArgParserTests, parsesRateLimitInKiB) {
+    int argc{4};
+    char * argv[] = {"program_name", "/some/directory", "--limit_rate", "1024"};
+    ASSERT_EQ(parseServerArgs(argc, argv).rate_limit, 1024 * 1024);
+}
 
 TEST(ServerArgParserTests, throwsOnTooBigPortNumber) {
     int argc{4};
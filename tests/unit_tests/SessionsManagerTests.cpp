@@ -1,24 +1,25 @@
 #include <gtest/gtest.h>
 
 #include "server/SessionsManager.hpp"
+#include "InitSessionMessage.hpp"
 
 using namespace std::chrono_literals;
 
 TEST(SessionsManagerTests, throwsOnNonExistentCodeWords) {
-    SessionsManager manager;
+    SessionsManager<> manager;
     ASSERT_EQ(manager.currentSessions(), 0);
     ASSERT_THROW(manager.getSenderWithMetadata("non-existent-code-words"), SessionsManagerException);
 }
 
 TEST(SessionsManagerTests, addingConnectionsIncreasesReturnedAmount) {
-    SessionsManager manager;
+    SessionsManager<> manager;
     ASSERT_EQ(manager.currentSessions(), 0);
     ASSERT_NO_FATAL_FAILURE(manager.registerSender(nullptr, {})); // also does not use any of actual values
     ASSERT_EQ(manager.currentSessions(), 1); // also does not use any of actual values
 }
 
 TEST(SessionsManagerTests, canRetrieveSessionWithCorrectCodeWords) {
-    SessionsManager manager;
+    SessionsManager<> manager;
     std::string code_words = manager.registerSender(nullptr, {});
     ASSERT_EQ(manager.currentSessions(), 1);
     ASSERT_NO_THROW(manager.getSenderWithMetadata(code_words));
@@ -28,10 +29,72 @@ TEST(SessionsManagerTests, canRetrieveSessionWithCorrectCodeWords) {
 TEST(SessionsManagerTests, removesClientsAfterTimeoutPeriod) {
     std::chrono::seconds timeout{3s};
     std::chrono::seconds check_period{1s};
-    SessionsManager manager{timeout, check_period};
+    SessionsManager<> manager{timeout, check_period};
 
     manager.registerSender(nullptr, {});
     ASSERT_EQ(manager.currentSessions(), 1);
     std::this_thread::sleep_for(6s);
     ASSERT_EQ(manager.currentSessions(), 0);
-}
\ No newline at end of file
+    ASSERT_EQ(manager.timeoutCounters().get(SessionPhase::parked_sender), 1);
+}
+TEST(SessionsManagerTests, interruptedSessionCanBeResumedUnderTheSameCode) {
+    SessionsManager<> manager;
+    nlohmann::json session_data{{InitSessionMessage::FILE_HASH_KEY, "hash"}};
+    std::string code_words = manager.registerSender(nullptr, session_data);
+    manager.getSenderWithMetadata(code_words);
+    manager.markResumable(code_words, session_data);
+
+    nlohmann::json resume_json = session_data;
+    InitSessionMessage::setResumeToken(resume_json, code_words);
+    ASSERT_EQ(manager.registerSender(nullptr, resume_json), code_words);
+    ASSERT_NO_THROW(manager.getSenderWithMetadata(code_words));
+    ASSERT_THROW(manager.registerSender(nullptr, resume_json), SessionsManagerException); // resumed only once
+}
+
+TEST(SessionsManagerTests, refusesToResumeWithUnknownTokenOrDifferentFile) {
+    SessionsManager<> manager;
+    nlohmann::json session_data{{InitSessionMessage::FILE_HASH_KEY, "hash"}};
+    manager.markResumable("interrupted-code-1", session_data);
+
+    nlohmann::json resume_json{{InitSessionMessage::FILE_HASH_KEY, "other-hash"}};
+    InitSessionMessage::setResumeToken(resume_json, "interrupted-code-1");
+    ASSERT_THROW(manager.registerSender(nullptr, resume_json), SessionsManagerException);
+    InitSessionMessage::setResumeToken(session_data, "unknown-code-2");
+    ASSERT_THROW(manager.registerSender(nullptr, session_data), SessionsManagerException);
+}
+
+TEST(SessionsManagerTests, forgetsResumableSessionsAfterTimeoutPeriod) {
+    SessionsManager<> manager{1s, 1s};
+    nlohmann::json session_data{{InitSessionMessage::FILE_HASH_KEY, "hash"}};
+    manager.markResumable("interrupted-code-1", session_data);
+    std::this_thread::sleep_for(3s);
+
+    InitSessionMessage::setResumeToken(session_data, "interrupted-code-1");
+    ASSERT_THROW(manager.registerSender(nullptr, session_data), SessionsManagerException);
+}
+
+TEST(SessionsManagerTests, pairsStreamsJoiningTheSameSession) {
+    SessionsManager<> manager;
+    auto sender_stream = InitSessionMessage::createStreamJoinMessage("send", "some-code-1", 1, {0, 10});
+    auto receiver_stream = InitSessionMessage::createStreamJoinMessage("receive", "some-code-1", 1, {0, 10});
+    auto other_receiver_stream = InitSessionMessage::createStreamJoinMessage("receive", "some-code-1", 2, {10, 20});
+
+    ASSERT_FALSE(manager.joinStream(nullptr, sender_stream).has_value());
+    ASSERT_FALSE(manager.joinStream(nullptr, other_receiver_stream).has_value());
+    ASSERT_THROW(manager.joinStream(nullptr, sender_stream), SessionsManagerException);
+    ASSERT_TRUE(manager.joinStream(nullptr, receiver_stream).has_value());
+    ASSERT_FALSE(manager.joinStream(nullptr, receiver_stream).has_value()); // pair is gone, so it waits again
+}
+
+TEST(SessionsManagerTests, streamsOfTheSameTransferShareRateLimiter) {
+    SessionsManager<> unlimited_manager;
+    ASSERT_EQ(unlimited_manager.rateLimiter("some-code"), nullptr);
+
+    SessionsManager<> manager{SessionsManager<>::DEFAULT_CLIENT_TIMEOUT, SessionsManager<>::DEFAULT_CHECK_INTERVAL, {},
+                              DEFAULT_FRAME_SIZE, {}, 1024 * 1024};
+    auto rate_limiter = manager.rateLimiter("some-code");
+    ASSERT_NE(rate_limiter, nullptr);
+    ASSERT_EQ(rate_limiter->bytesPerSecond(), 1024 * 1024);
+    ASSERT_EQ(manager.rateLimiter("some-code"), rate_limiter);
+    ASSERT_NE(manager.rateLimiter("other-code"), rate_limiter);
+}
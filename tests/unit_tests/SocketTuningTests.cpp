@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "SocketTuning.hpp"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+class SocketTuningTests: public Test {
+public:
+    int tcp_socket{-1};
+
+    void SetUp() override {
+        tcp_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(tcp_socket, 0);
+    }
+
+    void TearDown() override {
+        ::close(tcp_socket);
+    }
+};
+
+TEST(SocketTunerBufferTests, buffersFitTwiceBandwidthDelayProduct) {
+    ASSERT_EQ(SocketTuner::bufferSizeFor(50ms, 100.0 * 1024 * 1024), 10 * 1024 * 1024);
+}
+
+TEST(SocketTunerBufferTests, buffersStayWithinLimits) {
+    ASSERT_EQ(SocketTuner::bufferSizeFor(100us, 1024.0 * 1024), SocketTuner::MIN_BUFFER_SIZE);
+    ASSERT_EQ(SocketTuner::bufferSizeFor(0us, 0.0), SocketTuner::MIN_BUFFER_SIZE);
+    ASSERT_EQ(SocketTuner::bufferSizeFor(1s, 10.0 * 1024 * 1024 * 1024), SocketTuner::MAX_BUFFER_SIZE);
+}
+
+TEST_F(SocketTuningTests, reportsKernelsCongestionControlByDefault) {
+    SocketTuner tuner{tcp_socket, {}};
+    ASSERT_FALSE(tuner.report().congestion_control.empty());
+    ASSERT_GT(tuner.report().send_buffer, 0);
+    ASSERT_GT(tuner.report().receive_buffer, 0);
+}
+
+TEST_F(SocketTuningTests, keepsDefaultCongestionControlWhenRequestedOneIsUnavailable) {
+    std::string default_congestion_control = SocketTuner{tcp_socket, {}}.report().congestion_control;
+    SocketTuner tuner{tcp_socket, {.congestion_control = "no-such-algorithm"}};
+    ASSERT_EQ(tuner.report().congestion_control, default_congestion_control);
+}
+
+TEST_F(SocketTuningTests, tunesOnceAfterMeasurementPeriod) {
+    auto start = SocketTuner::Clock::now();
+    SocketTuner tuner{tcp_socket, {}, start};
+    std::size_t initial_send_buffer = tuner.report().send_buffer;
+    ASSERT_FALSE(tuner.recordTransferred(1024 * 1024, start + 1s));
+    ASSERT_TRUE(tuner.recordTransferred(1024 * 1024, start + SocketTuner::MEASUREMENT_PERIOD));
+    ASSERT_FALSE(tuner.recordTransferred(1024 * 1024, start + 2 * SocketTuner::MEASUREMENT_PERIOD));
+
+    ASSERT_DOUBLE_EQ(tuner.report().bytes_per_second, 1024.0 * 1024);
+    ASSERT_GE(tuner.report().send_buffer, initial_send_buffer);
+}
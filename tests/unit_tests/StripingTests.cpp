@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "Striping.hpp"
+
+
+using namespace ::testing;
+
+TEST(StripingTests, singleStreamCarriesWholeFile) {
+    ASSERT_EQ(stripeRange(1000, 1, 0), (ByteRange{0, 1000}));
+}
+
+TEST(StripingTests, stripesCoverWholeFileWithoutOverlapping) {
+    for (std::size_t file_size: {0ul, 1ul, 7ul, 1000ul, 1024ul * 1024 + 3}) {
+        for (std::size_t streams = 1; streams <= MAX_STREAMS; ++streams) {
+            std::size_t expected_begin{0};
+            for (std::size_t index = 0; index < streams; ++index) {
+                ByteRange range = stripeRange(file_size, streams, index);
+                ASSERT_EQ(range.begin, expected_begin);
+                ASSERT_LE(range.size(), file_size / streams + 1);
+                expected_begin = range.end;
+            }
+            ASSERT_EQ(expected_begin, file_size);
+        }
+    }
+}
+
+TEST(StripingTests, alignedStripesDoNotSplitUnits) {
+    constexpr std::size_t alignment{4096};
+    std::size_t file_size = 10 * alignment + 5;
+    std::size_t expected_begin{0};
+    for (std::size_t index = 0; index < 4; ++index) {
+        ByteRange range = stripeRange(file_size, 4, index, alignment);
+        ASSERT_EQ(range.begin, expected_begin);
+        ASSERT_EQ(range.begin % alignment, 0);
+        expected_begin = range.end;
+    }
+    ASSERT_EQ(expected_begin, file_size);
+    ASSERT_EQ(stripeRange(file_size, 4, 0, alignment), (ByteRange{0, 3 * alignment}));
+    ASSERT_EQ(stripeRange(file_size, 4, 3, alignment), (ByteRange{9 * alignment, file_size}));
+}
+
+TEST(StripingTests, moreStreamsThanUnitsLeavesEmptyStripes) {
+    ASSERT_EQ(stripeRange(100, 4, 0, 4096), (ByteRange{0, 100}));
+    ASSERT_EQ(stripeRange(100, 4, 3, 4096), (ByteRange{100, 100}));
+}
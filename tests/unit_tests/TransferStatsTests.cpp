@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "client/TransferStats.hpp"
+
+#include <thread>
+
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+TEST(TransferStatsTests, recordsMeasuredPhase) {
+    TransferStats stats;
+    {
+        TransferStats::Measurement transfer{&stats, TransferStats::TRANSFER};
+        transfer.addBytes(1000);
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_EQ(stats.phases().size(), 1);
+    const auto &phase = stats.phases().front();
+    ASSERT_EQ(phase.name, TransferStats::TRANSFER);
+    ASSERT_EQ(phase.bytes, 1000);
+    ASSERT_GE(phase.wall_time, 10ms);
+    ASSERT_GT(phase.throughput(), 0.0);
+    ASSERT_GT(phase.peak_rss, 0);
+}
+
+TEST(TransferStatsTests, recordsPhaseOnceWhenStopped) {
+    TransferStats stats;
+    {
+        TransferStats::Measurement hash{&stats, TransferStats::HASH};
+        hash.stop();
+        hash.addBytes(10);
+        hash.stop();
+    }
+    ASSERT_EQ(stats.phases().size(), 1);
+    ASSERT_EQ(stats.phases().front().bytes, 0);
+}
+
+TEST(TransferStatsTests, sumsUpRepeatedPhase) {
+    TransferStats stats;
+    stats.record({.name = TransferStats::CONNECT, .wall_time = 1s, .cpu_time = 100ms, .peak_rss = 20});
+    stats.record({.name = TransferStats::TRANSFER, .wall_time = 2s, .bytes = 300, .peak_rss = 30});
+    stats.record({.name = TransferStats::CONNECT, .wall_time = 3s, .cpu_time = 50ms, .peak_rss = 10});
+
+    ASSERT_EQ(stats.phases().size(), 2);
+    const auto &connect = stats.phases().front();
+    ASSERT_EQ(connect.name, TransferStats::CONNECT);
+    ASSERT_EQ(connect.wall_time, 4s);
+    ASSERT_EQ(connect.cpu_time, 150ms);
+    ASSERT_EQ(connect.peak_rss, 20);
+    ASSERT_EQ(stats.phases().back().throughput(), 150.0);
+}
+
+TEST(TransferStatsTests, measuresNothingWithoutStats) {
+    TransferStats::Measurement transfer{nullptr, TransferStats::TRANSFER};
+    transfer.addBytes(10);
+    transfer.stop();
+}
+
+TEST(TransferStatsTests, reportsPhasesAsJson) {
+    TransferStats stats;
+    stats.record({.name = TransferStats::TRANSFER, .wall_time = 2s, .cpu_time = 500ms, .bytes = 4096,
+                  .peak_rss = 1024});
+    nlohmann::json report = stats.toJson();
+
+    ASSERT_EQ(report["phases"].size(), 1);
+    const auto &phase = report["phases"][0];
+    ASSERT_EQ(phase["name"], TransferStats::TRANSFER);
+    ASSERT_DOUBLE_EQ(phase["wall_time_s"].get<double>(), 2.0);
+    ASSERT_DOUBLE_EQ(phase["cpu_time_s"].get<double>(), 0.5);
+    ASSERT_EQ(phase["bytes"], 4096);
+    ASSERT_DOUBLE_EQ(phase["throughput_bytes_per_s"].get<double>(), 2048.0);
+    ASSERT_EQ(phase["peak_rss_bytes"], 1024);
+    ASSERT_NE(stats.toText().find(TransferStats::TRANSFER), std::string::npos);
+}
+
+TEST(TransferStatsTests, parsesFormat) {
+    ASSERT_EQ(parseStatsFormat("text"), StatsFormat::text);
+    ASSERT_EQ(parseStatsFormat("json"), StatsFormat::json);
+    ASSERT_FALSE(parseStatsFormat("xml").has_value());
+}
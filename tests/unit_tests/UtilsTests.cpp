@@ -40,6 +40,15 @@ TEST_F(UtilsTests, hashingTheSameFileTwiceResultsInTheSameHash) {
     ASSERT_EQ(calculateFileHash(file_1_path), calculateFileHash(file_1_path));
 }
 
+TEST_F(UtilsTests, hashDoesNotDependOnReadBufferSize) {
+    std::ofstream{file_1_path, std::ios::trunc} << generateRandomString(100'000);
+    for (auto algorithm: {HashAlgorithm::sha256, HashAlgorithm::blake2b}) {
+        ASSERT_EQ(calculateFileHash(file_1_path, algorithm, 7), calculateFileHash(file_1_path, algorithm));
+    }
+    ASSERT_NE(calculateFileHash(file_1_path, HashAlgorithm::sha256),
+              calculateFileHash(file_1_path, HashAlgorithm::blake2b));
+}
+
 TEST_F(UtilsTests, doesNotCrashOnCalculatingHashOfBigFile) {
     std::ofstream file1{file_1_path, std::ios::trunc};
     std::size_t content_length{8 * 1 << 20}; // 8 MB
@@ -51,6 +60,7 @@ TEST_F(UtilsTests, doesNotCrashOnCalculatingHashOfBigFile) {
 }
 
 TEST_F(UtilsTests, bytesToHumanReadableTest) {
+    ASSERT_EQ(bytesToHumanReadable(0), "0 B");
     ASSERT_EQ(bytesToHumanReadable(1023), "1023 B");
     ASSERT_EQ(bytesToHumanReadable(1024), "1 kiB");
     ASSERT_EQ(bytesToHumanReadable(1024*1024 -1), "1023 kiB");
@@ -60,6 +60,16 @@ TEST_F(ZstdTests, canCompressAndDecompressLargeAmountsOfData) {
     ASSERT_EQ(decompressed_data_stream.str(), input_data);
 }
 
+TEST_F(ZstdTests, canDecompressFromMemory) {
+    std::stringstream output_stream;
+    std::ifstream input_file{input_data_path, std::ios::binary};
+    zstd::compress(input_file, output_stream);
+
+    std::stringstream decompressed_data_stream{};
+    zstd::decompress(decompressed_data_stream, std::string_view{output_stream.str()});
+    ASSERT_EQ(decompressed_data_stream.str(), input_data);
+}
+
 TEST_F(ZstdTests, canCompressAndDecompressWhenEmptyInputData) {
     input_data = "";
     std::fstream input_file{input_data_path, std::ios::binary | std::ios::trunc};